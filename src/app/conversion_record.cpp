@@ -0,0 +1,210 @@
+#include "conversion_record.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include "string/string_utils.h"
+
+namespace fakeg {
+namespace app {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+// 记录文件格式的版本，格式变化时旧记录自动失效
+constexpr const char* kRecordHeader = "# FakeG conversion record v1";
+constexpr const char* kCheckpointHeader = "# FakeG checkpoint v1";
+
+// 整数字段（long在Windows上只有32位，不能用 parseNumber）
+template<typename T>
+bool parseField(std::string_view text, T& value) {
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+uint64_t fnv1a(uint64_t hash, std::string_view data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+std::string toHex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+// 从 file 的当前位置哈希到文件末尾或读满 limit 字节
+std::string hashStream(std::ifstream& file, uintmax_t limit) {
+    uint64_t hash = kFnvOffset;
+    std::vector<char> block(1 << 20);
+    while (file && limit > 0) {
+        const uintmax_t want = std::min<uintmax_t>(limit, block.size());
+        file.read(block.data(), static_cast<std::streamsize>(want));
+        const size_t got = static_cast<size_t>(file.gcount());
+        hash = fnv1a(hash, std::string_view(block.data(), got));
+        limit -= got;
+    }
+    return file.bad() ? "" : toHex(hash);
+}
+
+// 读取带版本头的 key=value 记录文件，对每个字段调用 assign（返回false表示不认识该字段）。
+// 返回认识的字段个数，文件不存在或版本头不符时返回 -1
+template<typename Assign>
+int readFields(const std::string& path, const char* header, Assign assign) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return -1;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || string_utils::trim(line) != header) {
+        return -1;
+    }
+
+    int fields = 0;
+    while (std::getline(file, line)) {
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        if (assign(line.substr(0, eq), string_utils::trimView(std::string_view(line).substr(eq + 1)))) {
+            fields++;
+        }
+    }
+    return fields;
+}
+
+} // namespace
+
+std::string ConversionRecord::sidecarPath(const std::string& outputFile) {
+    return outputFile + ".fakeg";
+}
+
+bool ConversionRecord::load(const std::string& path) {
+    const int fields = readFields(path, kRecordHeader, [this](const std::string& key, std::string_view value) {
+        if (key == "converter") {
+            converter.assign(value);
+            return true;
+        }
+        if (key == "input_hash") {
+            inputHash.assign(value);
+            return true;
+        }
+        return (key == "input_mtime" && parseField(value, inputMtime)) ||
+               (key == "input_size" && parseField(value, inputSize)) ||
+               (key == "output_size" && parseField(value, outputSize));
+    });
+    return fields == 5;
+}
+
+bool ConversionRecord::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << kRecordHeader << "\n"
+         << "converter=" << converter << "\n"
+         << "input_size=" << inputSize << "\n"
+         << "input_mtime=" << inputMtime << "\n"
+         << "input_hash=" << inputHash << "\n"
+         << "output_size=" << outputSize << "\n";
+    file.close();
+    return !file.fail();
+}
+
+std::string ConversionCheckpoint::checkpointPath(const std::string& outputFile) {
+    return outputFile + ".fakeg-checkpoint";
+}
+
+bool ConversionCheckpoint::load(const std::string& path) {
+    const int fields = readFields(path, kCheckpointHeader, [this](const std::string& key, std::string_view value) {
+        if (key == "converter") {
+            converter.assign(value);
+            return true;
+        }
+        if (key == "input_hash" || key == "output_hash") {
+            (key == "input_hash" ? inputHash : outputHash).assign(value);
+            return true;
+        }
+        int flag = 0;
+        if (key == "has_tddft" && parseField(value, flag)) {
+            hasTDDFT = flag != 0;
+            return true;
+        }
+        return (key == "input_offset" && parseField(value, inputOffset)) ||
+               (key == "steps" && parseField(value, steps)) ||
+               (key == "output_offset" && parseField(value, outputOffset));
+    });
+    return fields == 7;
+}
+
+bool ConversionCheckpoint::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << kCheckpointHeader << "\n"
+         << "converter=" << converter << "\n"
+         << "input_offset=" << inputOffset << "\n"
+         << "input_hash=" << inputHash << "\n"
+         << "steps=" << steps << "\n"
+         << "has_tddft=" << (hasTDDFT ? 1 : 0) << "\n"
+         << "output_offset=" << outputOffset << "\n"
+         << "output_hash=" << outputHash << "\n";
+    file.close();
+    return !file.fail();
+}
+
+std::string hashContent(std::string_view content) {
+    return toHex(fnv1a(kFnvOffset, content));
+}
+
+std::string hashContentWindow(std::string_view content, uintmax_t end, uintmax_t window) {
+    const uintmax_t begin = end > window ? end - window : 0;
+    return hashContent(content.substr(static_cast<size_t>(begin), static_cast<size_t>(end - begin)));
+}
+
+std::string hashFileContent(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return "";
+    }
+
+    return hashStream(file, std::numeric_limits<uintmax_t>::max());
+}
+
+std::string hashFileWindow(const std::string& filename, uintmax_t end, uintmax_t window) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return "";
+    }
+
+    const uintmax_t begin = end > window ? end - window : 0;
+    file.seekg(static_cast<std::streamoff>(begin));
+    return hashStream(file, end - begin);
+}
+
+bool fileMtime(const std::string& filename, long long& mtime) {
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(filename, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = static_cast<long long>(time.time_since_epoch().count());
+    return true;
+}
+
+} // namespace app
+} // namespace fakeg
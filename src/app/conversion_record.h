@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace fakeg {
+namespace app {
+
+// 一次成功转换的记录（增量模式）
+//
+// 保存在输出文件旁的 sidecar 文件（<output>.fakeg）中。再次转换同一输入时，
+// 若转换器版本、输入大小和修改时间（或内容哈希）以及输出大小都没有变化，就可以跳过。
+struct ConversionRecord {
+    std::string converter;     // 程序和解析器的名称、版本
+    uintmax_t inputSize = 0;
+    long long inputMtime = 0;  // file_time_type 的计数值
+    std::string inputHash;     // 输入内容的 FNV-1a 64 位哈希（十六进制）
+    uintmax_t outputSize = 0;
+
+    static std::string sidecarPath(const std::string& outputFile);
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
+
+// 断点续转的检查点（--resume）
+//
+// 保存在 <output>.fakeg-checkpoint 中，记录输入里已完整解析的优化步骤到哪个字节为止、写出了多少步，
+// 以及输出中这些步骤在哪里结束（之后是最后一步和尾部内容）。日志只在末尾追加时，
+// 下次转换把输出截到该位置，从记录的输入位置继续解析。两个位置之前一段内容的哈希用来确认文件没有被改写。
+struct ConversionCheckpoint {
+    static constexpr uintmax_t kHashWindow = 64 * 1024;
+
+    std::string converter;
+    uintmax_t inputOffset = 0;
+    std::string inputHash;     // 输入中 inputOffset 之前最多 kHashWindow 字节的哈希
+    uintmax_t steps = 0;
+    bool hasTDDFT = false;     // 已解析的步骤中有TD-DFT结果（尾部解析需要沿用）
+    uintmax_t outputOffset = 0;
+    std::string outputHash;    // 输出中 outputOffset 之前最多 kHashWindow 字节的哈希
+
+    static std::string checkpointPath(const std::string& outputFile);
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
+
+// 内容哈希（FNV-1a 64 位，十六进制）
+std::string hashContent(std::string_view content);
+// 分块读取文件计算同样的哈希，无法读取时返回空串
+std::string hashFileContent(const std::string& filename);
+// content 中 [end - window, end) 一段的哈希（不足 window 时从开头算起）
+std::string hashContentWindow(std::string_view content, uintmax_t end, uintmax_t window);
+// 文件中 [end - window, end) 一段的哈希（不足 window 时从文件开头算起），无法读取时返回空串
+std::string hashFileWindow(const std::string& filename, uintmax_t end, uintmax_t window);
+
+// 文件修改时间的计数值，无法获取时返回false
+bool fileMtime(const std::string& filename, long long& mtime);
+
+} // namespace app
+} // namespace fakeg
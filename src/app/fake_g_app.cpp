@@ -1,12 +1,32 @@
 #include "fake_g_app.h"
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <system_error>
+#include <vector>
+
+#include "app/conversion_record.h"
+#include "io/file_watcher.h"
 
 namespace fakeg {
 namespace app {
 
-FakeGApp::FakeGApp() : debugMode(false), appLogger(false, logger::LogLevel::INFO) {
+namespace {
+
+// 跟踪模式下两次检查输入文件之间的最长间隔（inotify 可用时文件一有写入就会提前醒来）
+constexpr int kFollowPollMs = 1000;
+
+// 解析数据竞技场的初始缓冲大小，一般的单点、频率计算用不完，不必再向堆申请
+constexpr size_t kArenaInitialBytes = 256 * 1024;
+
+} // namespace
+
+FakeGApp::FakeGApp()
+    : debugMode(false), streamingMode(true), incrementalMode(false), skipped(false),
+      followMode(false), followTimeout(0), resumeMode(false), compressionLevel(0), appLogger(false, logger::LogLevel::INFO),
+      arenaBuffer(kArenaInitialBytes), arena(arenaBuffer.data(), arenaBuffer.size()) {
     programName = "FakeG";
     programVersion = "1.0.0";
     authorInfo = "FakeG Project";
@@ -43,6 +63,35 @@ void FakeGApp::setDebugMode(bool enable) {
     logger::globalLogger = appLogger;
 }
 
+void FakeGApp::setStreamingMode(bool enable) {
+    streamingMode = enable;
+}
+
+void FakeGApp::setLogStream(std::ostream* stream) {
+    appLogger.setOutput(stream);
+}
+
+void FakeGApp::setIncrementalMode(bool enable) {
+    incrementalMode = enable;
+}
+
+void FakeGApp::setFollowMode(bool enable) {
+    followMode = enable;
+}
+
+void FakeGApp::setFollowTimeout(int seconds) {
+    followTimeout = seconds;
+}
+
+void FakeGApp::setResumeMode(bool enable) {
+    resumeMode = enable;
+}
+
+void FakeGApp::setOutputCompression(io::Compression type, int level) {
+    compressionLevel = level > 0 ? level : io::compressionLevel(type, io::CompressionSpeed::Balanced);
+    writer.setCompression(type, compressionLevel);
+}
+
 void FakeGApp::setInputFile(const std::string& filename) {
     inputFilename = filename;
 }
@@ -62,8 +111,12 @@ bool FakeGApp::initialize() {
         return false;
     }
     
+    // 从标准输入读取时默认写到标准输出
+    if (outputFilename.empty() && io::isStdioPath(inputFilename)) {
+        outputFilename = "-";
+    }
     if (outputFilename.empty()) {
-        outputFilename = io::GaussianWriter::generateOutputFilename(inputFilename, "_fake");
+        outputFilename = defaultOutputFile(inputFilename, writer.getCompression());
     }
 
     // Ensure output directory exists (important when output is in a non-existent folder).
@@ -71,44 +124,212 @@ bool FakeGApp::initialize() {
 }
 
 bool FakeGApp::processFile() {
+    skipped = false;
     if (!initialize()) {
         return false;
     }
     
+    // 管道没有可以检查、记录或续写的文件
+    const bool piped = io::isStdioPath(inputFilename) || io::isStdioPath(outputFilename);
+    if (piped && (followMode || incrementalMode || resumeMode)) {
+        showErrorInfo("Follow, incremental and resume modes need regular input and output files");
+        return false;
+    }
+    
+    if (followMode) {
+        return followFile();
+    }
+    
+    // 验证输入文件（标准输入只能读一次，打开后在读入的开头上验证）。
+    // 自动识别在这里选定解析器，增量模式的检查要用实际解析器的版本
+    if (!io::isStdioPath(inputFilename) && !parser->validateInput(inputFilename)) {
+        showErrorInfo("Input file format is incorrect");
+        return false;
+    }
+    
+    if (incrementalMode && isOutputUpToDate()) {
+        skipped = true;
+        appLogger.info("Output is up to date, skipping: " + inputFilename);
+        return true;
+    }
+    
     appLogger.info("Starting to process file: " + inputFilename);
     appLogger.debug("Using parser: " + parser->getParserName() + " v" + parser->getParserVersion());
     
     // 打开输入文件
     io::FileReader reader(inputFilename);
     if (!reader.isOpen()) {
-        showErrorInfo("Cannot open input file: " + inputFilename);
+        const std::string& reason = reader.getError();
+        showErrorInfo("Cannot open input file: " + inputFilename + (reason.empty() ? "" : " (" + reason + ")"));
         return false;
     }
-    
-    // 验证输入文件
-    if (!parser->validateInput(inputFilename)) {
+    // 自动识别在这里选定解析器，之后才能判断是否流式输出
+    if (io::isStdioPath(inputFilename) && !parser->validateContent(reader)) {
         showErrorInfo("Input file format is incorrect");
         return false;
     }
     
+    writer.setOutputFilename(outputFilename);
+    // 压缩输出不能截断后续写，总是完整转换
+    const bool resumable = resumeMode && reader.isMapped() && parser->supportsFollow() &&
+                           writer.getCompression() == io::Compression::None;
+    const bool converted = resumable ? convertResumable(reader) : convert(reader);
+    // 解析数据已随转换结束析构，竞技场一次性回收
+    arena.release();
+    if (!converted) {
+        return false;
+    }
+    
+    if (incrementalMode) {
+        recordConversion(reader);
+    }
+    
+    appLogger.info("Successfully generated output file: " + outputFilename);
+    return true;
+}
+
+bool FakeGApp::convert(io::FileReader& reader) {
+    // 流式模式下writer作为sink接收解析器提交的每一步并立即写出，内存中只保留最后一步
+    const bool streaming = streamingMode && parser->supportsStreaming();
+    if (streaming) {
+        writer.beginStream(outputFilename);
+        parser->setStepSink(&writer);
+    }
+    
     // 解析文件
-    data::ParsedData parsedData;
-    if (!parser->parse(reader, parsedData)) {
-        showErrorInfo("Failed to parse file");
+    data::ParsedData parsedData(&arena);
+    const bool parsed = parser->parse(reader, parsedData);
+    parser->setStepSink(nullptr);
+    // 边读边解压时数据损坏只表现为内容提前结束，解析完后再检查
+    const std::string readError = parsed ? reader.getError() : std::string();
+    if (!parsed || !readError.empty()) {
+        if (streaming) {
+            writer.abortStream();
+        }
+        showErrorInfo(parsed ? "Cannot read input file: " + inputFilename + " (" + readError + ")" : "Failed to parse file");
         return false;
     }
     
     // 显示进度信息
     showProgressInfo(parsedData);
     
-    // 生成输出
-    writer.setOutputFilename(outputFilename);
-    if (!writer.writeGaussianOutput(parsedData)) {
+    // 生成输出（流式模式下只剩频率、热力学等尾部内容）
+    const bool written = streaming ? writer.finishStream(parsedData) : writer.writeGaussianOutput(parsedData);
+    if (!written) {
         showErrorInfo("Failed to write output file: " + outputFilename);
         return false;
     }
+    return true;
+}
+
+bool FakeGApp::convertResumable(io::FileReader& reader) {
+    const std::string checkpointPath = ConversionCheckpoint::checkpointPath(outputFilename);
+    const std::string_view content = reader.view();
     
-    appLogger.info("Successfully generated output file: " + outputFilename);
+    // 检查点有效时截掉上次的最后一步和尾部内容，从记录的位置继续
+    data::ParsedData followed;
+    ConversionCheckpoint checkpoint;
+    uintmax_t start = 0;
+    if (loadCheckpoint(content, checkpoint)) {
+        if (!writer.resumeStream(outputFilename, checkpoint.outputOffset)) {
+            showErrorInfo("Cannot reopen output file: " + outputFilename);
+            return false;
+        }
+        start = checkpoint.inputOffset;
+        followed.streamedSteps = static_cast<size_t>(checkpoint.steps);
+        followed.hasTDDFT = checkpoint.hasTDDFT;
+        appLogger.info("Resuming after step " + std::to_string(checkpoint.steps) + " at byte " +
+                       std::to_string(start) + " of " + inputFilename);
+    } else {
+        writer.beginStream(outputFilename);
+        checkpoint = ConversionCheckpoint();
+    }
+    
+    // 新内容中的完整步骤逐个写出（最后一行可能还没写完，不交给解析器）。
+    // 最后一个完整步骤留给尾部解析，保证尾部至少有一个完整步骤，和整个文件一起解析时结果相同
+    const size_t lineEnd = content.rfind('\n');
+    const size_t complete = lineEnd == std::string_view::npos ? 0 : lineEnd + 1;
+    const std::string_view appended = complete > start ? content.substr(start, complete - start) : std::string_view();
+    size_t consumed = 0;
+    if (!parser->parseAppendedSteps(appended, 1, followed, writer, consumed)) {
+        writer.abortStream();
+        showErrorInfo("Failed to write output file: " + outputFilename);
+        return false;
+    }
+    
+    // 没有任何完整步骤时整个文件都属于尾部
+    const uintmax_t tailStart = followed.streamedSteps > 0 ? start + consumed : 0;
+    if (followed.streamedSteps > checkpoint.steps) {
+        checkpoint.converter = converterId();
+        checkpoint.inputOffset = tailStart;
+        checkpoint.inputHash = hashContentWindow(content, tailStart, ConversionCheckpoint::kHashWindow);
+        checkpoint.steps = followed.streamedSteps;
+        checkpoint.hasTDDFT = followed.hasTDDFT;
+        checkpoint.outputOffset = writer.streamPosition();
+        checkpoint.outputHash = hashFileWindow(outputFilename, checkpoint.outputOffset, ConversionCheckpoint::kHashWindow);
+    }
+    
+    // 尾部（最后一步以及频率、热力学等）用解析器的完整流程解析；
+    // 尾部看不到的全局信息（是否有TD-DFT）沿用前面各步骤的结果
+    reader.setViewStart(static_cast<size_t>(tailStart));
+    data::ParsedData parsedData(&arena);
+    parsedData.hasTDDFT = followed.hasTDDFT;
+    const bool parsed = parser->parse(reader, parsedData);
+    reader.setViewStart(0);
+    if (!parsed) {
+        writer.abortStream();
+        showErrorInfo("Failed to parse file");
+        return false;
+    }
+    
+    if (!writeRemainingSteps(parsedData, 0)) {
+        return false;
+    }
+    parsedData.streamedSteps = followed.streamedSteps + parsedData.optSteps.size();
+    showProgressInfo(parsedData);
+    
+    if (!writer.finishStream(parsedData)) {
+        showErrorInfo("Failed to write output file: " + outputFilename);
+        return false;
+    }
+    
+    // 尾部不写入检查点：日志继续追加后最后一步可能还会变化
+    if (checkpoint.steps > 0 && !checkpoint.save(checkpointPath)) {
+        appLogger.warning("Cannot save checkpoint: " + checkpointPath);
+    }
+    return true;
+}
+
+bool FakeGApp::loadCheckpoint(std::string_view content, ConversionCheckpoint& checkpoint) {
+    if (!checkpoint.load(ConversionCheckpoint::checkpointPath(outputFilename)) ||
+        checkpoint.converter != converterId()) {
+        return false;
+    }
+    
+    // 输入只能在末尾追加；输出中检查点之前的部分必须保持原样
+    std::error_code ec;
+    const uintmax_t outputSize = std::filesystem::file_size(outputFilename, ec);
+    if (ec || checkpoint.inputOffset > content.size() || checkpoint.outputOffset > outputSize ||
+        hashContentWindow(content, checkpoint.inputOffset, ConversionCheckpoint::kHashWindow) != checkpoint.inputHash ||
+        hashFileWindow(outputFilename, checkpoint.outputOffset, ConversionCheckpoint::kHashWindow) != checkpoint.outputHash) {
+        appLogger.debug("Checkpoint does not match the current files, converting from the beginning");
+        return false;
+    }
+    return true;
+}
+
+bool FakeGApp::writeRemainingSteps(const data::ParsedData& parsedData, size_t first) {
+    for (size_t i = first; i < parsedData.optSteps.size(); i++) {
+        const data::TDDFTData* tddftData = nullptr;
+        if (parsedData.hasTDDFT && i < parsedData.tddftData.size()) {
+            tddftData = &parsedData.tddftData[i];
+        }
+        if (!writer.consumeStep(parsedData, parsedData.optSteps[i], tddftData)) {
+            writer.abortStream();
+            showErrorInfo("Failed to write output file: " + outputFilename);
+            return false;
+        }
+    }
     return true;
 }
 
@@ -135,9 +356,33 @@ bool FakeGApp::isDebugMode() const {
     return debugMode;
 }
 
+bool FakeGApp::isStreamingMode() const {
+    return streamingMode;
+}
+
+bool FakeGApp::isIncrementalMode() const {
+    return incrementalMode;
+}
+
+bool FakeGApp::wasSkipped() const {
+    return skipped;
+}
+
+bool FakeGApp::isFollowMode() const {
+    return followMode;
+}
+
+bool FakeGApp::isResumeMode() const {
+    return resumeMode;
+}
+
+std::string FakeGApp::defaultOutputFile(const std::string& inputFile, io::Compression compression) {
+    return io::GaussianWriter::generateOutputFilename(inputFile, "_fake") + io::compressionExtension(compression);
+}
+
 bool FakeGApp::setupOutput() {
     if (outputFilename.empty()) {
-        outputFilename = io::GaussianWriter::generateOutputFilename(inputFilename, "_fake");
+        outputFilename = defaultOutputFile(inputFilename, writer.getCompression());
     }
     
     // 检查输出目录是否存在
@@ -156,9 +401,224 @@ bool FakeGApp::setupOutput() {
     return true;
 }
 
+std::string FakeGApp::converterId() const {
+    std::string id = programName + " " + programVersion + " / " + parser->getParserId() + " / output r" +
+                     std::to_string(io::GaussianWriter::kOutputRevision);
+    // 压缩设置不同时输出内容也不同
+    const io::Compression compression = writer.getCompression();
+    if (compression != io::Compression::None) {
+        id += std::string(" / ") + io::compressionName(compression) + " " + std::to_string(compressionLevel);
+    }
+    return id;
+}
+
+bool FakeGApp::isOutputUpToDate() {
+    ConversionRecord record;
+    if (!record.load(ConversionRecord::sidecarPath(outputFilename)) || record.converter != converterId()) {
+        return false;
+    }
+    
+    // 输出被删除或改动过时需要重新生成
+    std::error_code ec;
+    const uintmax_t outputSize = std::filesystem::file_size(outputFilename, ec);
+    if (ec || outputSize != record.outputSize) {
+        return false;
+    }
+    
+    const uintmax_t inputSize = std::filesystem::file_size(inputFilename, ec);
+    long long inputMtime = 0;
+    if (ec || inputSize != record.inputSize || !fileMtime(inputFilename, inputMtime)) {
+        return false;
+    }
+    if (inputMtime == record.inputMtime) {
+        return true;
+    }
+    
+    // 只有修改时间变化（例如重新拷贝）时比较内容哈希，内容相同则更新记录后跳过
+    const std::string hash = hashFileContent(inputFilename);
+    if (hash.empty() || hash != record.inputHash) {
+        return false;
+    }
+    record.inputMtime = inputMtime;
+    record.save(ConversionRecord::sidecarPath(outputFilename));
+    appLogger.debug("Input modification time changed but content is identical: " + inputFilename);
+    return true;
+}
+
+void FakeGApp::recordConversion(const io::FileReader& reader) {
+    ConversionRecord record;
+    record.converter = converterId();
+    
+    std::error_code ec;
+    record.inputSize = std::filesystem::file_size(inputFilename, ec);
+    const bool haveInput = !ec && fileMtime(inputFilename, record.inputMtime);
+    record.outputSize = std::filesystem::file_size(outputFilename, ec);
+    // 与 isOutputUpToDate 一致，哈希的是文件本身（压缩文件不是解压后的内容）
+    const bool rawContent = reader.isMapped() && reader.getCompression() == io::Compression::None;
+    record.inputHash = rawContent ? hashContent(reader.view()) : hashFileContent(inputFilename);
+    
+    const std::string sidecar = ConversionRecord::sidecarPath(outputFilename);
+    if (!haveInput || ec || record.inputHash.empty() || !record.save(sidecar)) {
+        appLogger.warning("Cannot record conversion state: " + sidecar);
+    }
+}
+
+bool FakeGApp::followFile() {
+    std::ifstream input(inputFilename, std::ios::binary);
+    if (!input.is_open()) {
+        showErrorInfo("Cannot open input file: " + inputFilename);
+        return false;
+    }
+    
+    appLogger.info("Following file: " + inputFilename);
+    io::FileWatcher watcher(inputFilename);
+    appLogger.debug(watcher.isNotifying() ? "Waiting for changes with inotify" : "Polling for changes");
+    
+    // 计算可能刚刚开始，等到输入有内容后再识别格式
+    const auto started = std::chrono::steady_clock::now();
+    std::error_code ec;
+    while (std::filesystem::file_size(inputFilename, ec) == 0 && !ec) {
+        if (followTimeout > 0 &&
+            std::chrono::steady_clock::now() - started >= std::chrono::seconds(followTimeout)) {
+            showErrorInfo("Input file is still empty: " + inputFilename);
+            return false;
+        }
+        watcher.wait(kFollowPollMs);
+    }
+    
+    if (!parser->validateInput(inputFilename)) {
+        showErrorInfo("Input file format is incorrect");
+        return false;
+    }
+    if (!parser->supportsFollow()) {
+        showErrorInfo("Follow mode is not supported for this input format");
+        return false;
+    }
+    if (io::detectFileCompression(inputFilename) != io::Compression::None) {
+        showErrorInfo("Follow mode does not support compressed input");
+        return false;
+    }
+    
+    writer.setOutputFilename(outputFilename);
+    writer.beginStream(outputFilename);
+    
+    // offset 之前的内容已读入；pending 是已读入但还不构成完整步骤的部分。
+    // tailStart 是最后写出的步骤块的起点，之前已写出 stepsBeforeTail 步，结束时从这里解析尾部
+    data::ParsedData followed;
+    std::string pending;
+    std::streamoff offset = 0;
+    uintmax_t tailStart = 0;
+    size_t stepsBeforeTail = 0;
+    auto lastGrowth = std::chrono::steady_clock::now();
+    std::vector<char> chunk(1 << 20);
+    
+    while (true) {
+        std::string appended;
+        input.clear();
+        input.seekg(offset);
+        while (input.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || input.gcount() > 0) {
+            appended.append(chunk.data(), static_cast<size_t>(input.gcount()));
+        }
+        
+        // 只处理完整的行，写了一半的行留到下次
+        const size_t lineEnd = appended.rfind('\n');
+        if (lineEnd != std::string::npos) {
+            appended.resize(lineEnd + 1);
+            offset += static_cast<std::streamoff>(appended.size());
+            lastGrowth = std::chrono::steady_clock::now();
+            
+            const bool finished = parser->isJobFinished(appended);
+            pending += appended;
+            
+            // 最后一个完整步骤单独提交，以便记下它的起点
+            const size_t before = followed.streamedSteps;
+            size_t consumed = 0;
+            size_t lastConsumed = 0;
+            bool parsed = parser->parseAppendedSteps(pending, 1, followed, writer, consumed);
+            const size_t beforeLast = followed.streamedSteps;
+            if (parsed) {
+                parsed = parser->parseAppendedSteps(std::string_view(pending).substr(consumed), 0, followed, writer,
+                                                    lastConsumed);
+            }
+            if (followed.streamedSteps > beforeLast) {
+                tailStart = static_cast<uintmax_t>(offset) - pending.size() + consumed;
+                stepsBeforeTail = beforeLast;
+            }
+            pending.erase(0, consumed + lastConsumed);
+            if (!parsed || !writer.flushStream()) {
+                writer.abortStream();
+                showErrorInfo("Failed to write output file: " + outputFilename);
+                return false;
+            }
+            if (followed.streamedSteps > before) {
+                appLogger.info("Appended " + std::to_string(followed.streamedSteps - before) + " step(s), " +
+                               std::to_string(followed.streamedSteps) + " written to " + outputFilename);
+            }
+            
+            if (finished) {
+                appLogger.info("Job finished");
+                break;
+            }
+        } else if (std::error_code ec;
+                   std::filesystem::file_size(inputFilename, ec) < static_cast<uintmax_t>(offset) || ec) {
+            writer.abortStream();
+            showErrorInfo("Input file was truncated while following: " + inputFilename);
+            return false;
+        } else if (followTimeout > 0 &&
+                   std::chrono::steady_clock::now() - lastGrowth >= std::chrono::seconds(followTimeout)) {
+            appLogger.info("No new output for " + std::to_string(followTimeout) + " s, stopping");
+            break;
+        }
+        
+        watcher.wait(kFollowPollMs);
+    }
+    
+    const bool finished = finishFollow(followed, tailStart, stepsBeforeTail);
+    arena.release();
+    return finished;
+}
+
+bool FakeGApp::finishFollow(const data::ParsedData& followed, uintmax_t tailStart, size_t stepsBeforeTail) {
+    io::FileReader reader(inputFilename);
+    if (!reader.isOpen()) {
+        writer.abortStream();
+        showErrorInfo("Failed to parse file");
+        return false;
+    }
+    
+    // 与断点续转相同，只解析尾部：最后写出的一步（保证尾部至少有一个完整步骤，和整个文件一起解析时结果相同）、
+    // 之后还没写出的步骤以及频率、热力学等内容。尾部看不到的全局信息（是否有TD-DFT）沿用前面各步骤的结果。
+    // 没有映射时只能从头解析
+    if (!reader.setViewStart(static_cast<size_t>(tailStart))) {
+        stepsBeforeTail = 0;
+    }
+    data::ParsedData parsedData(&arena);
+    parsedData.hasTDDFT = followed.hasTDDFT;
+    if (!parser->parse(reader, parsedData)) {
+        writer.abortStream();
+        showErrorInfo("Failed to parse file");
+        return false;
+    }
+    
+    // 尾部中前面的步骤已经写出
+    if (!writeRemainingSteps(parsedData, followed.streamedSteps - stepsBeforeTail)) {
+        return false;
+    }
+    parsedData.streamedSteps = stepsBeforeTail + parsedData.optSteps.size();
+    showProgressInfo(parsedData);
+    
+    if (!writer.finishStream(parsedData)) {
+        showErrorInfo("Failed to write output file: " + outputFilename);
+        return false;
+    }
+    
+    appLogger.info("Successfully generated output file: " + outputFilename);
+    return true;
+}
+
 void FakeGApp::showProgressInfo(const data::ParsedData& data) {
     if (data.hasOpt && !data.optSteps.empty()) {
-        appLogger.info("Found optimization calculation with " + std::to_string(data.optSteps.size()) + " steps");
+        appLogger.info("Found optimization calculation with " + std::to_string(data.stepCount()) + " steps");
     } else if (!data.optSteps.empty()) {
         appLogger.info("Found single point calculation");
     }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <ostream>
 #include <string>
+#include <vector>
 
+#include "app/conversion_record.h"
 #include "data/structures.h"
 #include "io/file_reader.h"
 #include "io/gaussian_writer.h"
@@ -19,6 +24,13 @@ private:
     std::string inputFilename;
     std::string outputFilename;
     bool debugMode;
+    bool streamingMode;
+    bool incrementalMode;
+    bool skipped;  // 最近一次 processFile 因输出已是最新而跳过
+    bool followMode;
+    int followTimeout;  // 秒，0 表示一直等到作业结束
+    bool resumeMode;
+    int compressionLevel;  // 输出压缩级别（不压缩时不使用）
     
     // 程序信息
     std::string programName;
@@ -30,6 +42,11 @@ private:
     mutable logger::Logger appLogger;  // 声明为 mutable
     io::GaussianWriter writer;
     
+    // 解析数据的竞技场：每次转换的 ParsedData 从这里分配，转换结束后一次性回收。
+    // 初始缓冲在多次转换（批量模式）之间复用
+    std::vector<std::byte> arenaBuffer;
+    std::pmr::monotonic_buffer_resource arena;
+    
 public:
     FakeGApp();
     explicit FakeGApp(std::unique_ptr<parsers::ParserInterface> parser);
@@ -40,6 +57,13 @@ public:
     // 配置方法
     void setProgramInfo(const std::string& name, const std::string& version, const std::string& author);
     void setDebugMode(bool enable);
+    void setStreamingMode(bool enable);  // 解析器支持时边解析边写出（默认开启）
+    void setLogStream(std::ostream* stream);  // 日志输出流（nullptr 为 std::cout）
+    void setIncrementalMode(bool enable);     // 输出仍为最新时跳过转换（见 ConversionRecord）
+    void setFollowMode(bool enable);          // 跟踪仍在运行的计算，新步骤写完即追加到输出
+    void setFollowTimeout(int seconds);       // 输入这么久没有增长时结束跟踪（0 为不限）
+    void setResumeMode(bool enable);          // 从检查点继续转换只在末尾追加过的日志（见 ConversionCheckpoint）
+    void setOutputCompression(io::Compression type, int level = 0);  // gzip/zstd 压缩输出，level 为 0 时用默认级别
     void setInputFile(const std::string& filename);
     void setOutputFile(const std::string& filename);
     
@@ -55,10 +79,27 @@ public:
     std::string getInputFile() const;
     std::string getOutputFile() const;
     bool isDebugMode() const;
+    bool isStreamingMode() const;
+    bool isIncrementalMode() const;
+    bool wasSkipped() const;
+    bool isFollowMode() const;
+    bool isResumeMode() const;
+    
+    // 未指定输出时的默认输出文件名（input_fake.log，压缩输出再加压缩扩展名）
+    static std::string defaultOutputFile(const std::string& inputFile, io::Compression compression);
     
 private:
     // 内部方法
     bool setupOutput();
+    std::string converterId() const;
+    bool isOutputUpToDate();
+    void recordConversion(const io::FileReader& reader);
+    bool convert(io::FileReader& reader);
+    bool convertResumable(io::FileReader& reader);
+    bool loadCheckpoint(std::string_view content, ConversionCheckpoint& checkpoint);
+    bool writeRemainingSteps(const data::ParsedData& parsedData, size_t first);
+    bool followFile();
+    bool finishFollow(const data::ParsedData& followed, uintmax_t tailStart, size_t stepsBeforeTail);
     void showProgressInfo(const data::ParsedData& data);  // 去掉 const
     void showErrorInfo(const std::string& error);         // 去掉 const
 };
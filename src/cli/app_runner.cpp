@@ -1,8 +1,12 @@
 #include "app_runner.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "cli/argument_parser.h"
+#include "cli/batch_runner.h"
+#include "io/compressor.h"
+#include "io/file_reader.h"
 #include "string/string_utils.h"
 
 namespace fakeg {
@@ -13,7 +17,8 @@ namespace {
 void printHelp(const AppSpec& spec) {
     const std::string programName = spec.programName.empty() ? "fakeg" : spec.programName;
 
-    std::cout << "Usage: " << programName << " [options] <input_file>" << std::endl;
+    std::cout << "Usage: " << programName << " [options] <input_file>..." << std::endl;
+    std::cout << "       " << programName << " [options] - < input_file    (read stdin, write stdout)" << std::endl;
     std::cout << std::endl;
 
     if (!spec.descriptionLine.empty()) {
@@ -26,7 +31,16 @@ void printHelp(const AppSpec& spec) {
 
     std::cout << "Options:" << std::endl;
     std::cout << "  --debug              Enable debug mode" << std::endl;
-    std::cout << "  -o, --output FILE    Specify output filename" << std::endl;
+    std::cout << "  --no-stream          Parse the whole file before writing output" << std::endl;
+    std::cout << "  --incremental        Skip inputs whose output is still up to date" << std::endl;
+    std::cout << "  --resume             Continue from the last checkpoint when the log was only appended to" << std::endl;
+    std::cout << "  --follow             Follow a running AMESP/BDF job, appending new steps as they appear" << std::endl;
+    std::cout << "  --follow-timeout S   Stop following after S seconds without new output" << std::endl;
+    std::cout << "  --compress FORMAT    Write gzip or zstd compressed output (compressed on a background thread)" << std::endl;
+    std::cout << "  --compress-level L   fast, balanced (default), small, or a numeric level" << std::endl;
+    std::cout << "  -o, --output FILE    Specify output filename (single input only; - for stdout)" << std::endl;
+    std::cout << "  -j, --jobs N         Convert N files in parallel (default: all CPU threads)" << std::endl;
+    std::cout << "  --list FILE          Read input paths from FILE, one per line" << std::endl;
     std::cout << "  -h, --help           Show this help message" << std::endl;
     std::cout << "  -v, --version        Show version information" << std::endl;
     std::cout << std::endl;
@@ -34,6 +48,12 @@ void printHelp(const AppSpec& spec) {
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << programName << " input.out" << std::endl;
     std::cout << "  " << programName << " --debug -o output.log input.out" << std::endl;
+    std::cout << "  " << programName << " -j 8 \"runs/*.out\"" << std::endl;
+    std::cout << "  " << programName << " --incremental -j 8 \"runs/*.out\"" << std::endl;
+    std::cout << "  " << programName << " --follow running.out" << std::endl;
+    std::cout << "  " << programName << " input.out.gz" << std::endl;
+    std::cout << "  ssh host cat job.out | " << programName << " - > job.log" << std::endl;
+    std::cout << "  " << programName << " --compress gzip --compress-level fast -j 8 \"runs/*.out\"" << std::endl;
 }
 
 void printVersion(const AppSpec& spec) {
@@ -46,14 +66,58 @@ void printVersion(const AppSpec& spec) {
     }
 }
 
+// Parses --compress / --compress-level. Named levels pick a throughput target; numbers are
+// passed to the compressor as-is (gzip 1-9, zstd 1-19).
+bool parseOutputCompression(const std::string& format, const std::string& level,
+                            io::Compression& type, int& compressionLevel) {
+    type = io::Compression::None;
+    compressionLevel = 0;
+    if (format.empty()) {
+        if (!level.empty()) {
+            std::cerr << "Error: --compress-level requires --compress" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (format == "gzip" || format == "gz") {
+        type = io::Compression::Gzip;
+    } else if (format == "zstd" || format == "zst") {
+        type = io::Compression::Zstd;
+    } else {
+        std::cerr << "Error: Unknown compression format: " << format << " (expected gzip or zstd)" << std::endl;
+        return false;
+    }
+    if (!io::isOutputCompressionSupported(type)) {
+        std::cerr << "Error: " << format << " output is not supported by this build" << std::endl;
+        return false;
+    }
+
+    const int maxLevel = io::compressionLevel(type, io::CompressionSpeed::Smallest);
+    if (level.empty() || level == "balanced") {
+        compressionLevel = io::compressionLevel(type, io::CompressionSpeed::Balanced);
+    } else if (level == "fast") {
+        compressionLevel = io::compressionLevel(type, io::CompressionSpeed::Fastest);
+    } else if (level == "small") {
+        compressionLevel = maxLevel;
+    } else {
+        compressionLevel = string_utils::toInt(level, 0);
+        if (compressionLevel < 1 || compressionLevel > maxLevel) {
+            std::cerr << "Error: Invalid compression level: " << level << " (expected 1-" << maxLevel << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 int runAppMain(int argc,
                char* argv[],
-               std::unique_ptr<parsers::ParserInterface> parser,
+               const ParserFactory& makeParser,
                const AppSpec& spec) {
     // Create application instance.
-    app::FakeGApp app(std::move(parser));
+    app::FakeGApp app(makeParser());
     app.setProgramInfo(spec.programName, spec.version, spec.author);
 
     // Interactive mode.
@@ -82,6 +146,9 @@ int runAppMain(int argc,
 
     // CLI mode.
     ArgumentParser argParser(argc, argv);
+    for (const char* flag : {"-h", "--help", "-v", "--version", "--debug", "--no-stream", "--incremental", "--follow", "--resume"}) {
+        argParser.declareFlag(flag);
+    }
 
     if (argParser.hasFlag("-h") || argParser.hasFlag("--help")) {
         printHelp(spec);
@@ -93,25 +160,114 @@ int runAppMain(int argc,
         return 0;
     }
 
-    app.setDebugMode(argParser.hasFlag("--debug"));
+    const bool debugMode = argParser.hasFlag("--debug");
+    const bool streamingMode = !argParser.hasFlag("--no-stream");
+    const bool incremental = argParser.hasFlag("--incremental");
+    const bool resume = argParser.hasFlag("--resume");
 
     std::string outputFile = argParser.getValue("-o", "");
     if (outputFile.empty()) {
         outputFile = argParser.getValue("--output", "");
     }
-    if (!outputFile.empty()) {
-        app.setOutputFile(outputFile);
+
+    // Collect inputs: positional args (with wildcard expansion) plus an optional list file.
+    std::vector<std::string> inputs;
+    bool batchMode = false;
+    for (const auto& arg : argParser.getPositionalArgs()) {
+        const std::vector<std::string> expanded = expandInputPattern(arg);
+        batchMode = batchMode || expanded.size() > 1 || expanded.front() != arg;
+        inputs.insert(inputs.end(), expanded.begin(), expanded.end());
+    }
+
+    const std::string listFile = argParser.getValue("--list", "");
+    if (!listFile.empty()) {
+        if (!readInputList(listFile, inputs)) {
+            std::cerr << "Error: Cannot read input list: " << listFile << std::endl;
+            return 1;
+        }
+        batchMode = true;
     }
 
-    std::string inputFile = argParser.getPositionalArg(0);
-    if (inputFile.empty()) {
+    if (inputs.empty()) {
         std::cerr << "Error: Please specify input file" << std::endl;
         printHelp(spec);
         return 1;
     }
 
-    app.setInputFile(inputFile);
-    return app.processFile() ? 0 : 1;
+    batchMode = batchMode || inputs.size() > 1;
+
+    const bool followMode = argParser.hasFlag("--follow");
+    const std::string followTimeout = argParser.getValue("--follow-timeout", "");
+    if (followMode && batchMode) {
+        std::cerr << "Error: --follow can only be used with a single input file" << std::endl;
+        return 1;
+    }
+    if (!followTimeout.empty() && string_utils::toInt(followTimeout, -1) < 0) {
+        std::cerr << "Error: Invalid follow timeout: " << followTimeout << std::endl;
+        return 1;
+    }
+
+    io::Compression compression = io::Compression::None;
+    int compressionLevel = 0;
+    if (!parseOutputCompression(argParser.getValue("--compress", ""), argParser.getValue("--compress-level", ""),
+                                compression, compressionLevel)) {
+        return 1;
+    }
+
+    const bool readsStdin = std::find_if(inputs.begin(), inputs.end(), io::isStdioPath) != inputs.end();
+    if (readsStdin && batchMode) {
+        std::cerr << "Error: - (stdin) can only be used as the only input" << std::endl;
+        return 1;
+    }
+
+    if (!batchMode) {
+        // Keep stdout clean for the converted output when it goes there.
+        if (io::isStdioPath(outputFile) || (outputFile.empty() && readsStdin)) {
+            app.setLogStream(&std::cerr);
+        }
+        app.setDebugMode(debugMode);
+        app.setStreamingMode(streamingMode);
+        app.setIncrementalMode(incremental);
+        app.setResumeMode(resume);
+        app.setFollowMode(followMode);
+        app.setFollowTimeout(string_utils::toInt(followTimeout, 0));
+        app.setOutputCompression(compression, compressionLevel);
+        if (!outputFile.empty()) {
+            app.setOutputFile(outputFile);
+        }
+        app.setInputFile(inputs.front());
+        return app.processFile() ? 0 : 1;
+    }
+
+    // Batch mode.
+    if (!outputFile.empty()) {
+        std::cerr << "Error: -o/--output cannot be used with multiple input files" << std::endl;
+        return 1;
+    }
+
+    BatchOptions options;
+    options.debugMode = debugMode;
+    options.streamingMode = streamingMode;
+    options.incremental = incremental;
+    options.resume = resume;
+    options.compression = compression;
+    options.compressionLevel = compressionLevel;
+
+    std::string jobs = argParser.getValue("-j", "");
+    if (jobs.empty()) {
+        jobs = argParser.getValue("--jobs", "");
+    }
+    if (!jobs.empty()) {
+        const int count = string_utils::toInt(jobs, 0);
+        if (count <= 0) {
+            std::cerr << "Error: Invalid job count: " << jobs << std::endl;
+            return 1;
+        }
+        options.jobs = static_cast<size_t>(count);
+    }
+
+    const std::vector<BatchResult> results = runBatch(inputs, makeParser, spec, options);
+    return printBatchSummary(results) == 0 ? 0 : 1;
 }
 
 } // namespace cli
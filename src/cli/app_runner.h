@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -20,12 +21,19 @@ struct AppSpec {
     std::string inputPrompt;
 };
 
-// Runs a FakeGApp with the provided parser and spec.
+// Creates a fresh parser instance (batch mode needs one per worker).
+using ParserFactory = std::function<std::unique_ptr<parsers::ParserInterface>()>;
+
+// Runs a FakeGApp with parsers from the provided factory and spec.
+//
+// With several inputs (or wildcards, or --list) the files are converted concurrently
+// and a per-file summary is printed.
 //
-// Return value follows conventional main(): 0 for success, non-zero for failure.
+// Return value follows conventional main(): 0 for success, non-zero for failure
+// (in batch mode: if any file failed).
 int runAppMain(int argc,
                char* argv[],
-               std::unique_ptr<parsers::ParserInterface> parser,
+               const ParserFactory& makeParser,
                const AppSpec& spec);
 
 } // namespace cli
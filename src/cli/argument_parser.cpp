@@ -21,6 +21,19 @@ ArgumentParser::ArgumentParser(int argc, char* argv[]) {
     }
 }
 
+void ArgumentParser::declareFlag(const std::string& flag) {
+    flags_.push_back(flag);
+}
+
+bool ArgumentParser::isDeclaredFlag(const std::string& arg) const {
+    return std::find(flags_.begin(), flags_.end(), arg) != flags_.end();
+}
+
+bool ArgumentParser::isOption(const std::string& arg) {
+    // A lone "-" is the conventional name for stdin/stdout, not an option.
+    return arg.starts_with("-") && arg != "-";
+}
+
 bool ArgumentParser::hasFlag(const std::string& flag) const {
     return std::find(args_.begin(), args_.end(), flag) != args_.end();
 }
@@ -34,22 +47,7 @@ std::string ArgumentParser::getValue(const std::string& option, const std::strin
 }
 
 std::string ArgumentParser::getPositionalArg(size_t index, const std::string& defaultValue) const {
-    std::vector<std::string> positional;
-
-    for (size_t i = 0; i < args_.size(); i++) {
-        const std::string& arg = args_[i];
-
-        // Skip options/flags
-        if (arg.starts_with("--") || arg.starts_with("-")) {
-            // If next token exists and is not another option, treat it as a value and skip it.
-            if (i + 1 < args_.size() && !args_[i + 1].starts_with("-")) {
-                i++;
-            }
-            continue;
-        }
-
-        positional.push_back(arg);
-    }
+    std::vector<std::string> positional = getPositionalArgs();
 
     if (index < positional.size()) {
         return positional[index];
@@ -58,23 +56,29 @@ std::string ArgumentParser::getPositionalArg(size_t index, const std::string& de
     return defaultValue;
 }
 
-size_t ArgumentParser::getPositionalArgCount() const {
-    size_t count = 0;
+std::vector<std::string> ArgumentParser::getPositionalArgs() const {
+    std::vector<std::string> positional;
 
     for (size_t i = 0; i < args_.size(); i++) {
         const std::string& arg = args_[i];
 
-        if (arg.starts_with("--") || arg.starts_with("-")) {
-            if (i + 1 < args_.size() && !args_[i + 1].starts_with("-")) {
+        // Skip options/flags
+        if (isOption(arg)) {
+            // If next token exists and is not another option, treat it as a value and skip it.
+            if (!isDeclaredFlag(arg) && i + 1 < args_.size() && !isOption(args_[i + 1])) {
                 i++;
             }
             continue;
         }
 
-        count++;
+        positional.push_back(arg);
     }
 
-    return count;
+    return positional;
+}
+
+size_t ArgumentParser::getPositionalArgCount() const {
+    return getPositionalArgs().size();
 }
 
 std::string ArgumentParser::getProgramName() const {
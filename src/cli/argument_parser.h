@@ -11,18 +11,28 @@ namespace cli {
 // Notes:
 // - Supports flags (e.g. --debug, -h)
 // - Supports key-value options (e.g. -o out.log, --output out.log)
-// - Positional args are args that are not options/flags.
+// - Positional args are args that are not options/flags; a lone "-" (stdin/stdout) is positional.
+// - An undeclared option followed by a non-option token consumes that token as its value;
+//   declare value-less flags with declareFlag() so the following input is kept positional.
 class ArgumentParser {
 private:
     std::vector<std::string> args_;
+    std::vector<std::string> flags_;
     std::string programName_;
 
+    bool isDeclaredFlag(const std::string& arg) const;
+    static bool isOption(const std::string& arg);
+
 public:
     ArgumentParser(int argc, char* argv[]);
 
+    // Marks an option as a flag that never takes a value.
+    void declareFlag(const std::string& flag);
+
     bool hasFlag(const std::string& flag) const;
     std::string getValue(const std::string& option, const std::string& defaultValue = "") const;
     std::string getPositionalArg(size_t index, const std::string& defaultValue = "") const;
+    std::vector<std::string> getPositionalArgs() const;
     size_t getPositionalArgCount() const;
 
     std::string getProgramName() const;
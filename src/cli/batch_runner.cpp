@@ -0,0 +1,251 @@
+#include "batch_runner.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+#include "app/fake_g_app.h"
+#include "concurrency/thread_pool.h"
+#include "string/string_utils.h"
+
+namespace fakeg {
+namespace cli {
+
+namespace {
+
+// Glob-style match of '*' (any run) and '?' (any single character).
+bool matchWildcard(std::string_view pattern, std::string_view name) {
+    size_t p = 0;
+    size_t n = 0;
+    size_t starPattern = std::string_view::npos;
+    size_t starName = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starName = n;
+        } else if (starPattern != std::string_view::npos) {
+            // Let the last '*' absorb one more character and retry.
+            p = starPattern + 1;
+            n = ++starName;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+// Key identifying the file a path refers to, so that different spellings of one path compare equal.
+std::string outputKey(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(path, ec);
+    if (ec) {
+        resolved = std::filesystem::absolute(path, ec).lexically_normal();
+    }
+    return ec ? path : resolved.string();
+}
+
+// Resolves the output of every input and marks inputs that must not be converted: repeated
+// inputs and inputs whose output is already claimed by an earlier input.
+void resolveOutputs(const std::vector<std::string>& inputs, io::Compression compression,
+                    std::vector<BatchResult>& results) {
+    std::unordered_map<std::string, size_t> inputOwners;
+    std::unordered_map<std::string, size_t> outputOwners;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        BatchResult& result = results[i];
+        result.inputFile = inputs[i];
+        result.outputFile = app::FakeGApp::defaultOutputFile(inputs[i], compression);
+
+        const auto [input, newInput] = inputOwners.emplace(outputKey(inputs[i]), i);
+        const auto [output, newOutput] = outputOwners.emplace(outputKey(result.outputFile), i);
+        if (!newInput) {
+            result.error = "input listed more than once";
+        } else if (!newOutput) {
+            result.error = "output " + result.outputFile + " is also the output of " + inputs[output->second];
+        }
+    }
+}
+
+} // namespace
+
+std::vector<std::string> expandInputPattern(const std::string& pattern) {
+    const std::filesystem::path path(pattern);
+    const std::string namePattern = path.filename().string();
+    if (namePattern.find_first_of("*?") == std::string::npos) {
+        return {pattern};
+    }
+
+    const std::filesystem::path directory = path.parent_path();
+    std::vector<std::string> matches;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory.empty() ? "." : directory, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        if (it->is_regular_file(ec) && matchWildcard(namePattern, name)) {
+            matches.push_back(directory.empty() ? name : (directory / name).string());
+        }
+    }
+
+    if (matches.empty()) {
+        return {pattern};
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+bool readInputList(const std::string& listFile, std::vector<std::string>& inputs) {
+    std::ifstream file(listFile);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = string_utils::removeQuotes(string_utils::trim(line));
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        inputs.push_back(line);
+    }
+    return true;
+}
+
+std::vector<BatchResult> runBatch(const std::vector<std::string>& inputs,
+                                  const ParserFactory& makeParser,
+                                  const AppSpec& spec,
+                                  const BatchOptions& options) {
+    std::vector<BatchResult> results(inputs.size());
+    if (inputs.empty()) {
+        return results;
+    }
+
+    // Two concurrent conversions writing one file would both report success with a mangled
+    // output, so collisions are rejected up front.
+    resolveOutputs(inputs, options.compression, results);
+    for (const auto& result : results) {
+        if (!result.error.empty()) {
+            std::cout << "[ERROR] " << result.inputFile << ": " << result.error << std::endl;
+        }
+    }
+
+    const size_t requested = options.jobs == 0 ? concurrency::ThreadPool::defaultThreadCount() : options.jobs;
+    const size_t workers = std::min(requested, inputs.size());
+    // Files already convert in parallel; each parser gets an equal share of the hardware threads
+    // instead of building a full-size pool of its own (jobs x cores threads otherwise).
+    const size_t parserThreads = std::max<size_t>(1, concurrency::ThreadPool::defaultThreadCount() / workers);
+
+    // One app per worker, created here because FakeGApp updates the global logger when it is
+    // constructed or its debug mode changes.
+    std::vector<std::unique_ptr<app::FakeGApp>> apps;
+    std::vector<app::FakeGApp*> idle;
+    for (size_t i = 0; i < workers; i++) {
+        std::unique_ptr<parsers::ParserInterface> parser = makeParser();
+        parser->setThreadCount(parserThreads);
+        auto app = std::make_unique<app::FakeGApp>(std::move(parser));
+        app->setProgramInfo(spec.programName, spec.version, spec.author);
+        app->setDebugMode(options.debugMode);
+        app->setStreamingMode(options.streamingMode);
+        app->setIncrementalMode(options.incremental);
+        app->setResumeMode(options.resume);
+        app->setOutputCompression(options.compression, options.compressionLevel);
+        idle.push_back(app.get());
+        apps.push_back(std::move(app));
+    }
+
+    std::mutex idleMutex;
+    std::mutex outputMutex;
+
+    auto convert = [&](size_t index) {
+        // At most `workers` tasks run at once, so an idle app is always available.
+        app::FakeGApp* app = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            app = idle.back();
+            idle.pop_back();
+        }
+
+        BatchResult& result = results[index];
+
+        std::ostringstream log;
+        app->setLogStream(&log);
+        app->setInputFile(inputs[index]);
+        app->setOutputFile(result.outputFile);
+        try {
+            result.success = app->processFile();
+        } catch (const std::exception& e) {
+            log << "[ERROR] " << inputs[index] << ": " << e.what() << std::endl;
+            result.success = false;
+        }
+        result.skipped = result.success && app->wasSkipped();
+        result.outputFile = app->getOutputFile();
+        app->setLogStream(nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << log.str() << std::flush;
+        }
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.push_back(app);
+        }
+    };
+
+    concurrency::ThreadPool pool(workers);
+    pool.parallelFor(inputs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (results[i].error.empty()) {
+                convert(i);
+            }
+        }
+    });
+
+    return results;
+}
+
+size_t printBatchSummary(const std::vector<BatchResult>& results) {
+    size_t failed = 0;
+    size_t skipped = 0;
+
+    std::cout << std::endl;
+    std::cout << "Batch summary:" << std::endl;
+    for (const auto& result : results) {
+        if (result.skipped) {
+            std::cout << "  SKIP  " << result.inputFile << " (up to date)" << std::endl;
+            skipped++;
+        } else if (result.success) {
+            std::cout << "  OK    " << result.inputFile << " -> " << result.outputFile << std::endl;
+        } else {
+            std::cout << "  FAIL  " << result.inputFile;
+            if (!result.error.empty()) {
+                std::cout << " (" << result.error << ")";
+            }
+            std::cout << std::endl;
+            failed++;
+        }
+    }
+    std::cout << results.size() << " file(s): " << (results.size() - failed - skipped) << " succeeded, ";
+    if (skipped > 0) {
+        std::cout << skipped << " up to date, ";
+    }
+    std::cout << failed << " failed" << std::endl;
+
+    return failed;
+}
+
+} // namespace cli
+} // namespace fakeg
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "cli/app_runner.h"
+#include "io/decompressor.h"
+
+namespace fakeg {
+namespace cli {
+
+// Options shared by every conversion in a batch.
+struct BatchOptions {
+    size_t jobs = 0;  // 0 = hardware thread count
+    bool debugMode = false;
+    bool streamingMode = true;
+    bool incremental = false;  // skip inputs whose output is still up to date
+    bool resume = false;       // continue append-only logs from their checkpoints
+    io::Compression compression = io::Compression::None;  // compress outputs (gzip/zstd)
+    int compressionLevel = 0;  // 0 = default level of the format
+};
+
+// Outcome of converting one input file.
+struct BatchResult {
+    std::string inputFile;
+    std::string outputFile;
+    bool success = false;
+    bool skipped = false;  // success without converting (incremental mode)
+    std::string error;     // why the file was not converted, when known before dispatch
+};
+
+// Expands '*' and '?' in the file name part of a pattern to the matching regular files,
+// sorted by name. Patterns without wildcards, or with no matches, are returned unchanged
+// (the conversion then reports the missing file like the shell would).
+std::vector<std::string> expandInputPattern(const std::string& pattern);
+
+// Appends the paths listed in listFile (one per line; blank lines and '#' comments are skipped).
+bool readInputList(const std::string& listFile, std::vector<std::string>& inputs);
+
+// Converts all inputs on a worker pool.
+//
+// Output paths are resolved before any conversion starts. An input whose output would be the
+// same file as that of an earlier input (job.aop and job.aop.gz both give job_fake.log) is not
+// converted and is reported as failed.
+//
+// Each worker owns a FakeGApp with its own parser and writer. The log of each file is
+// collected separately and printed as one block when that file is done, so output from
+// concurrent conversions never interleaves. Results are returned in input order.
+std::vector<BatchResult> runBatch(const std::vector<std::string>& inputs,
+                                  const ParserFactory& makeParser,
+                                  const AppSpec& spec,
+                                  const BatchOptions& options);
+
+// Prints one line per file plus totals; returns the number of failed files.
+size_t printBatchSummary(const std::vector<BatchResult>& results);
+
+} // namespace cli
+} // namespace fakeg
@@ -0,0 +1,79 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace fakeg {
+namespace concurrency {
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return; // stopping_ 且队列已清空
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    chunkSize = std::max<size_t>(chunkSize, 1);
+
+    std::vector<std::future<void>> pending;
+    pending.reserve((count + chunkSize - 1) / chunkSize);
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        const size_t end = std::min(count, begin + chunkSize);
+        pending.push_back(submit([&body, begin, end]() { body(begin, end); }));
+    }
+
+    // 先等待全部完成，再按顺序取结果（第一个异常会被重新抛出）
+    for (auto& future : pending) {
+        future.wait();
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+} // namespace concurrency
+} // namespace fakeg
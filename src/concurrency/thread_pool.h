@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fakeg {
+namespace concurrency {
+
+// 固定大小的线程池
+//
+// 任务按提交顺序取出执行；析构时先执行完队列中剩余的任务再回收线程。
+//
+// Notes:
+// - 任务内部不应直接写日志（Logger不是线程安全的），需要输出的信息应带回调用线程再打印
+class ThreadPool {
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_;
+
+    void workerLoop();
+
+public:
+    // threadCount 为0时使用 defaultThreadCount()
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+
+    // 提交任务，返回任务结果的future（任务抛出的异常在 get() 时重新抛出）
+    template<typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task);
+
+    // 将 [0, count) 按 chunkSize 切块并行执行 body(begin, end)，全部完成后返回
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& body);
+
+    // 硬件线程数（无法获取时为1）
+    static size_t defaultThreadCount();
+};
+
+template<typename F>
+std::future<std::invoke_result_t<F>> ThreadPool::submit(F&& task) {
+    using Result = std::invoke_result_t<F>;
+
+    // std::function 要求可复制，packaged_task 只能移动，因此放在 shared_ptr 中
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> result = packaged->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace([packaged]() { (*packaged)(); });
+    }
+    available_.notify_one();
+    return result;
+}
+
+} // namespace concurrency
+} // namespace fakeg
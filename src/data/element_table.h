@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace fakeg {
+namespace data {
+namespace elements {
+
+// 元素周期表：原子序数与元素符号互查
+//
+// 符号到原子序数的查找表在编译期生成：元素符号最多两个字母，按（首字母, 第二个字母或无）
+// 直接定址，26 * 27 个槽位，没有冲突也不分配内存。查找不区分大小写，"Bq" 为0（虚原子），
+// 纯数字的符号按原子序数解释（部分XYZ文件用原子序数代替元素符号）
+
+constexpr int kMaxAtomicNumber = 118;
+
+// 下标即原子序数
+inline constexpr std::array<std::string_view, kMaxAtomicNumber + 1> kSymbols = {
+    "Bq", // out of period table: Ghost atom / Dummy atom
+    // Period 1
+    "H", "He",
+    // Period 2
+    "Li", "Be", "B", "C", "N", "O", "F", "Ne",
+    // Period 3
+    "Na", "Mg", "Al", "Si", "P", "S", "Cl", "Ar",
+    // Period 4
+    "K", "Ca", "Sc", "Ti", "V", "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn",
+    "Ga", "Ge", "As", "Se", "Br", "Kr",
+    // Period 5
+    "Rb", "Sr", "Y", "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd",
+    "In", "Sn", "Sb", "Te", "I", "Xe",
+    // Period 6
+    "Cs", "Ba", "La",
+    // Lanthanides
+    "Ce", "Pr", "Nd", "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho", "Er", "Tm", "Yb", "Lu",
+    // Period 6 continuation
+    "Hf", "Ta", "W", "Re", "Os", "Ir", "Pt", "Au", "Hg", "Tl", "Pb", "Bi", "Po", "At", "Rn",
+    // Period 7
+    "Fr", "Ra", "Ac",
+    // Actinides
+    "Th", "Pa", "U", "Np", "Pu", "Am", "Cm", "Bk", "Cf", "Es", "Fm", "Md", "No", "Lr",
+    // Period 7 continuation
+    "Rf", "Db", "Sg", "Bh", "Hs", "Mt", "Ds", "Rg", "Cn", "Nh", "Fl", "Mc", "Lv", "Ts", "Og",
+};
+
+namespace detail {
+
+constexpr size_t kSlots = 26 * 27;
+constexpr uint8_t kUnknown = 0xff;
+
+constexpr int letterIndex(char c) {
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    return -1;
+}
+
+// 一个或两个字母的符号对应的槽位，不是字母组成时返回-1
+constexpr int slotOf(std::string_view symbol) {
+    if (symbol.empty() || symbol.size() > 2) {
+        return -1;
+    }
+    const int first = letterIndex(symbol[0]);
+    const int second = symbol.size() == 2 ? letterIndex(symbol[1]) : -1;
+    if (first < 0 || (symbol.size() == 2 && second < 0)) {
+        return -1;
+    }
+    return first * 27 + second + 1;
+}
+
+constexpr std::array<uint8_t, kSlots> buildTable() {
+    std::array<uint8_t, kSlots> table{};
+    for (auto& slot : table) {
+        slot = kUnknown;
+    }
+    for (size_t z = 0; z < kSymbols.size(); z++) {
+        table[static_cast<size_t>(slotOf(kSymbols[z]))] = static_cast<uint8_t>(z);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, kSlots> kTable = buildTable();
+
+} // namespace detail
+
+// 符号对应的原子序数，不认识的符号返回-1
+constexpr int find(std::string_view symbol) {
+    if (!symbol.empty() && symbol.size() <= 3 && symbol.find_first_not_of("0123456789") == std::string_view::npos) {
+        int number = 0;
+        for (char c : symbol) {
+            number = number * 10 + (c - '0');
+        }
+        return number <= kMaxAtomicNumber ? number : -1;
+    }
+    const int slot = detail::slotOf(symbol);
+    if (slot < 0 || detail::kTable[static_cast<size_t>(slot)] == detail::kUnknown) {
+        return -1;
+    }
+    return detail::kTable[static_cast<size_t>(slot)];
+}
+
+// 符号对应的原子序数，不认识的默认为0（Bq）
+constexpr int atomicNumber(std::string_view symbol) {
+    const int number = find(symbol);
+    return number < 0 ? 0 : number;
+}
+
+constexpr bool isKnown(std::string_view symbol) {
+    return find(symbol) >= 0;
+}
+
+// 原子序数对应的符号（0 为 "Bq"），超出周期表时为空
+constexpr std::string_view symbol(int atomicNumber) {
+    return atomicNumber >= 0 && atomicNumber <= kMaxAtomicNumber ? kSymbols[static_cast<size_t>(atomicNumber)]
+                                                                 : std::string_view();
+}
+
+static_assert(atomicNumber("C") == 6 && atomicNumber("cl") == 17 && atomicNumber("OG") == 118);
+static_assert(atomicNumber("Bq") == 0 && atomicNumber("8") == 8 && atomicNumber("Xyz") == 0);
+static_assert(!isKnown("Xx") && symbol(26) == "Fe");
+
+} // namespace elements
+} // namespace data
+} // namespace fakeg
@@ -0,0 +1,53 @@
+#include "string_pool.h"
+
+#include <mutex>
+
+#include "data/element_table.h"
+
+namespace fakeg {
+namespace data {
+
+StringPool& StringPool::global() {
+    static StringPool pool;
+    return pool;
+}
+
+std::string_view StringPool::intern(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+
+    // 元素符号（大小写完全一致时）直接指向周期表中的常量，不加锁
+    const int atomicNumber = elements::find(text);
+    if (atomicNumber >= 0 && elements::symbol(atomicNumber) == text) {
+        return elements::symbol(atomicNumber);
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto it = index_.find(text);
+        if (it != index_.end()) {
+            return *it;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // 等待写锁期间其它线程可能已经加入
+    const auto it = index_.find(text);
+    if (it != index_.end()) {
+        return *it;
+    }
+    const std::string_view stored = storage_.emplace_back(text);
+    index_.insert(stored);
+    return stored;
+}
+
+size_t StringPool::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return storage_.size();
+}
+
+InternedString::InternedString(std::string_view text) : view_(StringPool::global().intern(text)) {}
+
+} // namespace data
+} // namespace fakeg
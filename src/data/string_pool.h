@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace fakeg {
+namespace data {
+
+// 字符串驻留池（进程内共享，线程安全）
+//
+// 元素符号、不可约表示、激发态对称性这类字段只有几十种取值，每种只存一份；
+// 池中的字符串在进程结束前一直有效，也不会移动
+class StringPool {
+public:
+    static StringPool& global();
+
+    // 返回与 text 内容相同的池中字符串，相同内容总是返回同一个地址
+    std::string_view intern(std::string_view text);
+    size_t size() const;
+
+private:
+    StringPool() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> storage_;           // 元素不会移动，视图一直有效
+    std::unordered_set<std::string_view> index_; // 指向 storage_ 中的字符串
+};
+
+// 驻留字符串：对象中只有指向池中字符串的视图
+//
+// 复制只复制视图；相同内容的驻留字符串地址相同，比较只比指针
+class InternedString {
+public:
+    InternedString() = default;
+    // 隐式转换，使字段可以直接用字符串赋值（atom.symbol = "C"）
+    InternedString(std::string_view text);
+    InternedString(const char* text) : InternedString(std::string_view(text)) {}
+    InternedString(const std::string& text) : InternedString(std::string_view(text)) {}
+
+    std::string_view view() const { return view_; }
+    operator std::string_view() const { return view_; }
+    std::string str() const { return std::string(view_); }
+    bool empty() const { return view_.empty(); }
+    size_t size() const { return view_.size(); }
+
+    bool operator==(const InternedString& other) const { return view_.data() == other.view_.data(); }
+    bool operator==(std::string_view text) const { return view_ == text; }
+
+private:
+    std::string_view view_;
+};
+
+} // namespace data
+} // namespace fakeg
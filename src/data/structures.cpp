@@ -1,84 +1,148 @@
 #include "structures.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace fakeg {
 namespace data {
 
-ElementMap::ElementMap() {
-    initElementMap();
+Trajectory::Trajectory(std::pmr::memory_resource* resource)
+    : topologies_(resource), symbols_(resource), atomicNumbers_(resource), frames_(resource), coords_(resource) {}
+
+bool Trajectory::matchesLastTopology(const std::vector<Atom>& atoms) const {
+    if (topologies_.empty() || topologies_.back().count != atoms.size()) {
+        return false;
+    }
+    const size_t begin = topologies_.back().begin;
+    for (size_t i = 0; i < atoms.size(); i++) {
+        if (atoms[i].atomicNumber != atomicNumbers_[begin + i] || !(atoms[i].symbol == symbols_[begin + i])) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void ElementMap::initElementMap() {
-    // out of period table
-    elementMap["Bq"] = 0; // Ghost atom / Dummy atom
-    
-    // Period 1
-    elementMap["H"] = 1; elementMap["He"] = 2;
-    
-    // Period 2
-    elementMap["Li"] = 3; elementMap["Be"] = 4; elementMap["B"] = 5; 
-    elementMap["C"] = 6; elementMap["N"] = 7; elementMap["O"] = 8; 
-    elementMap["F"] = 9; elementMap["Ne"] = 10;
-    
-    // Period 3
-    elementMap["Na"] = 11; elementMap["Mg"] = 12; elementMap["Al"] = 13; 
-    elementMap["Si"] = 14; elementMap["P"] = 15; elementMap["S"] = 16; 
-    elementMap["Cl"] = 17; elementMap["Ar"] = 18;
-    
-    // Period 4
-    elementMap["K"] = 19; elementMap["Ca"] = 20;
-    elementMap["Sc"] = 21; elementMap["Ti"] = 22; elementMap["V"] = 23; 
-    elementMap["Cr"] = 24; elementMap["Mn"] = 25; elementMap["Fe"] = 26; 
-    elementMap["Co"] = 27; elementMap["Ni"] = 28; elementMap["Cu"] = 29; 
-    elementMap["Zn"] = 30;
-    elementMap["Ga"] = 31; elementMap["Ge"] = 32; elementMap["As"] = 33; 
-    elementMap["Se"] = 34; elementMap["Br"] = 35; elementMap["Kr"] = 36;
+void Trajectory::append(const OptStep& step) {
+    if (!matchesLastTopology(step.atoms)) {
+        topologies_.push_back({atomicNumbers_.size(), step.atoms.size()});
+        for (const auto& atom : step.atoms) {
+            symbols_.emplace_back(atom.symbol);
+            atomicNumbers_.push_back(atom.atomicNumber);
+        }
+    }
     
-    // Period 5
-    elementMap["Rb"] = 37; elementMap["Sr"] = 38; elementMap["Y"] = 39; 
-    elementMap["Zr"] = 40; elementMap["Nb"] = 41; elementMap["Mo"] = 42; 
-    elementMap["Tc"] = 43; elementMap["Ru"] = 44; elementMap["Rh"] = 45; 
-    elementMap["Pd"] = 46; elementMap["Ag"] = 47; elementMap["Cd"] = 48;
-    elementMap["In"] = 49; elementMap["Sn"] = 50; elementMap["Sb"] = 51; 
-    elementMap["Te"] = 52; elementMap["I"] = 53; elementMap["Xe"] = 54;
-    
-    // Period 6
-    elementMap["Cs"] = 55; elementMap["Ba"] = 56; elementMap["La"] = 57;
-    // Lanthanides
-    elementMap["Ce"] = 58; elementMap["Pr"] = 59; elementMap["Nd"] = 60; 
-    elementMap["Pm"] = 61; elementMap["Sm"] = 62; elementMap["Eu"] = 63; 
-    elementMap["Gd"] = 64; elementMap["Tb"] = 65; elementMap["Dy"] = 66; 
-    elementMap["Ho"] = 67; elementMap["Er"] = 68; elementMap["Tm"] = 69; 
-    elementMap["Yb"] = 70; elementMap["Lu"] = 71;
-    // Period 6 continuation
-    elementMap["Hf"] = 72; elementMap["Ta"] = 73; elementMap["W"] = 74; 
-    elementMap["Re"] = 75; elementMap["Os"] = 76; elementMap["Ir"] = 77; 
-    elementMap["Pt"] = 78; elementMap["Au"] = 79; elementMap["Hg"] = 80;
-    elementMap["Tl"] = 81; elementMap["Pb"] = 82; elementMap["Bi"] = 83; 
-    elementMap["Po"] = 84; elementMap["At"] = 85; elementMap["Rn"] = 86;
-    
-    // Period 7
-    elementMap["Fr"] = 87; elementMap["Ra"] = 88; elementMap["Ac"] = 89;
-    // Actinides
-    elementMap["Th"] = 90; elementMap["Pa"] = 91; elementMap["U"] = 92; 
-    elementMap["Np"] = 93; elementMap["Pu"] = 94; elementMap["Am"] = 95; 
-    elementMap["Cm"] = 96; elementMap["Bk"] = 97; elementMap["Cf"] = 98; 
-    elementMap["Es"] = 99; elementMap["Fm"] = 100; elementMap["Md"] = 101; 
-    elementMap["No"] = 102; elementMap["Lr"] = 103;
-    // Period 7 continuation
-    elementMap["Rf"] = 104; elementMap["Db"] = 105; elementMap["Sg"] = 106; 
-    elementMap["Bh"] = 107; elementMap["Hs"] = 108; elementMap["Mt"] = 109; 
-    elementMap["Ds"] = 110; elementMap["Rg"] = 111; elementMap["Cn"] = 112; 
-    elementMap["Nh"] = 113; elementMap["Fl"] = 114; elementMap["Mc"] = 115; 
-    elementMap["Lv"] = 116; elementMap["Ts"] = 117; elementMap["Og"] = 118;
+    frames_.push_back({step.stepNumber, step.energy, step.rmsGrad, step.maxGrad, step.rmsStep, step.maxStep,
+                       step.converged, topologies_.size() - 1, coords_.size()});
+    for (const auto& atom : step.atoms) {
+        coords_.push_back(atom.x);
+        coords_.push_back(atom.y);
+        coords_.push_back(atom.z);
+    }
 }
 
-int ElementMap::getAtomicNumber(const std::string& symbol) const {
-    auto it = elementMap.find(symbol);
-    return (it != elementMap.end()) ? it->second : 0; // 不认识的默认为Bq
+void Trajectory::replaceAll(const OptStep& step) {
+    if (matchesLastTopology(step.atoms)) {
+        // 只留下最后一个拓扑，移到最前面
+        const Topology last = topologies_.back();
+        if (last.begin > 0) {
+            symbols_.erase(symbols_.begin(), symbols_.begin() + static_cast<std::ptrdiff_t>(last.begin));
+            atomicNumbers_.erase(atomicNumbers_.begin(), atomicNumbers_.begin() + static_cast<std::ptrdiff_t>(last.begin));
+        }
+        topologies_.assign(1, {0, last.count});
+    } else {
+        topologies_.clear();
+        symbols_.clear();
+        atomicNumbers_.clear();
+    }
+    frames_.clear();
+    coords_.clear();
+    append(step);
+}
+
+void Trajectory::clear() {
+    topologies_.clear();
+    symbols_.clear();
+    atomicNumbers_.clear();
+    frames_.clear();
+    coords_.clear();
+}
+
+void Trajectory::reserve(size_t frames, size_t atomsPerFrame) {
+    frames_.reserve(frames);
+    coords_.reserve(frames * atomsPerFrame * 3);
+}
+
+FrameView Trajectory::frame(size_t i) const {
+    const Frame& frame = frames_[i];
+    const Topology& topology = topologies_[frame.topology];
+    return {frame.stepNumber, frame.energy, frame.rmsGrad, frame.maxGrad, frame.rmsStep, frame.maxStep,
+            frame.converged,
+            std::span<const InternedString>(symbols_.data() + topology.begin, topology.count),
+            std::span<const int>(atomicNumbers_.data() + topology.begin, topology.count),
+            std::span<const double>(coords_.data() + frame.offset, topology.count * 3)};
+}
+
+OptStep Trajectory::step(size_t i) const {
+    const FrameView view = frame(i);
+    OptStep step;
+    step.stepNumber = view.stepNumber;
+    step.energy = view.energy;
+    step.rmsGrad = view.rmsGrad;
+    step.maxGrad = view.maxGrad;
+    step.rmsStep = view.rmsStep;
+    step.maxStep = view.maxStep;
+    step.converged = view.converged;
+    step.atoms.resize(view.atomCount());
+    for (size_t a = 0; a < step.atoms.size(); a++) {
+        Atom& atom = step.atoms[a];
+        atom.symbol = view.symbol(a);
+        atom.atomicNumber = view.atomicNumber(a);
+        atom.x = view.x(a);
+        atom.y = view.y(a);
+        atom.z = view.z(a);
+    }
+    return step;
+}
+
+ExcitedState::ExcitedState(const ExcitedState& other, allocator_type alloc)
+    : stateNumber(other.stateNumber), symmetry(other.symmetry),
+      excitationEnergy_eV(other.excitationEnergy_eV), wavelength_nm(other.wavelength_nm),
+      oscillatorStrength(other.oscillatorStrength), s2Value(other.s2Value), transitions(other.transitions, alloc),
+      hasOptimizationInfo(other.hasOptimizationInfo), hasTotalEnergy(other.hasTotalEnergy),
+      totalEnergy(other.totalEnergy), additionalInfo(other.additionalInfo, alloc) {}
+
+ExcitedState::ExcitedState(ExcitedState&& other, allocator_type alloc)
+    : stateNumber(other.stateNumber), symmetry(other.symmetry),
+      excitationEnergy_eV(other.excitationEnergy_eV), wavelength_nm(other.wavelength_nm),
+      oscillatorStrength(other.oscillatorStrength), s2Value(other.s2Value),
+      transitions(std::move(other.transitions), alloc), hasOptimizationInfo(other.hasOptimizationInfo),
+      hasTotalEnergy(other.hasTotalEnergy), totalEnergy(other.totalEnergy),
+      additionalInfo(std::move(other.additionalInfo), alloc) {}
+
+void DisplacementMatrix::resize(size_t modes, size_t atoms) {
+    if (atoms == atoms_) {
+        values_.resize(modes * atoms * 3, 0.0);
+        modes_ = modes;
+        return;
+    }
+
+    // 原子数变化时每个模式的起始位置都会变，逐个模式搬到新的布局
+    std::pmr::vector<double> values(modes * atoms * 3, 0.0, values_.get_allocator());
+    const size_t keepModes = std::min(modes, modes_);
+    const size_t keepValues = std::min(atoms, atoms_) * 3;
+    for (size_t m = 0; m < keepModes; m++) {
+        std::copy_n(values_.begin() + static_cast<std::ptrdiff_t>(m * atoms_ * 3), keepValues,
+                    values.begin() + static_cast<std::ptrdiff_t>(m * atoms * 3));
+    }
+    values_ = std::move(values);
+    modes_ = modes;
+    atoms_ = atoms;
 }
 
-bool ElementMap::hasElement(const std::string& symbol) const {
-    return elementMap.find(symbol) != elementMap.end();
+void DisplacementMatrix::clear() {
+    values_.clear();
+    modes_ = 0;
+    atoms_ = 0;
 }
 
 } // namespace data
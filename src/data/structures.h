@@ -1,15 +1,21 @@
 #pragma once
 
+#include <cstddef>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <map>
+
+#include "data/string_pool.h"
 
 namespace fakeg {
 namespace data {
 
 // 原子结构
 struct Atom {
-    std::string symbol;
+    InternedString symbol;
     int atomicNumber;
     double x, y, z;
     
@@ -28,16 +34,118 @@ struct OptStep {
                 rmsStep(0.0), maxStep(0.0), converged(false) {}
 };
 
+// 轨迹中一帧的只读视图，在轨迹被修改之前有效
+struct FrameView {
+    int stepNumber;
+    double energy;
+    double rmsGrad, maxGrad, rmsStep, maxStep;
+    bool converged;
+    std::span<const InternedString> symbols;
+    std::span<const int> atomicNumbers;
+    std::span<const double> coords; // 依次为每个原子的 x y z
+    
+    size_t atomCount() const { return atomicNumbers.size(); }
+    std::string_view symbol(size_t i) const { return symbols[i].view(); }
+    int atomicNumber(size_t i) const { return atomicNumbers[i]; }
+    double x(size_t i) const { return coords[i * 3]; }
+    double y(size_t i) const { return coords[i * 3 + 1]; }
+    double z(size_t i) const { return coords[i * 3 + 2]; }
+};
+
+// 优化轨迹（结构数组存储）
+//
+// 元素符号和原子序数按拓扑只存一份，连续的帧原子组成不变时共用同一个拓扑；
+// 所有帧的坐标首尾相接存放在一块连续内存中。帧按 OptStep 追加，按 FrameView 读取
+class Trajectory {
+public:
+    explicit Trajectory(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    
+    void append(const OptStep& step);
+    // 只保留这一帧（流式模式下保存最后一步），拓扑不变时沿用已有的拓扑
+    void replaceAll(const OptStep& step);
+    void clear();
+    // 按帧数和每帧原子数预留空间
+    void reserve(size_t frames, size_t atomsPerFrame);
+    
+    size_t size() const { return frames_.size(); }
+    bool empty() const { return frames_.empty(); }
+    
+    FrameView frame(size_t i) const;
+    FrameView operator[](size_t i) const { return frame(i); }
+    FrameView back() const { return frame(frames_.size() - 1); }
+    // 重建第 i 帧的 OptStep（需要逐原子结构的地方使用）
+    OptStep step(size_t i) const;
+    
+private:
+    // 一个拓扑在 symbols_/atomicNumbers_ 中的位置
+    struct Topology {
+        size_t begin;
+        size_t count;
+    };
+    
+    struct Frame {
+        int stepNumber;
+        double energy;
+        double rmsGrad, maxGrad, rmsStep, maxStep;
+        bool converged;
+        size_t topology;  // topologies_ 中的下标
+        size_t offset;    // 坐标在 coords_ 中的起始位置
+    };
+    
+    // 与最后一个拓扑的元素是否完全相同
+    bool matchesLastTopology(const std::vector<Atom>& atoms) const;
+    
+    std::pmr::vector<Topology> topologies_;
+    std::pmr::vector<InternedString> symbols_;
+    std::pmr::vector<int> atomicNumbers_;
+    std::pmr::vector<Frame> frames_;
+    std::pmr::vector<double> coords_;
+};
+
 // 频率模式结构
 struct FreqMode {
     double frequency;
     double irIntensity;
-    std::string irrep;  // 对称性信息
-    std::vector<std::vector<double>> displacements; // [atom][xyz]
+    InternedString irrep;  // 对称性信息（原子位移在 ParsedData::displacements 中）
     
     FreqMode() : frequency(0.0), irIntensity(0.0), irrep("A") {}
 };
 
+// 振动模式的原子位移矩阵
+//
+// 所有模式的位移按 [mode][atom][xyz] 连续存放在一块内存中，解析和写出时顺序访问；
+// 没有读到的位移为0
+class DisplacementMatrix {
+public:
+    explicit DisplacementMatrix(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : values_(resource), modes_(0), atoms_(0) {}
+    
+    // 调整模式数和原子数：已有位移按原来的下标保留，新增部分为0
+    void resize(size_t modes, size_t atoms);
+    void clear();
+    
+    size_t modeCount() const { return modes_; }
+    size_t atomCount() const { return atoms_; }
+    bool empty() const { return modes_ == 0 || atoms_ == 0; }
+    
+    // 一个模式的全部位移（atomCount() * 3 个值）
+    std::span<double> mode(size_t m) { return {values_.data() + m * atoms_ * 3, atoms_ * 3}; }
+    std::span<const double> mode(size_t m) const { return {values_.data() + m * atoms_ * 3, atoms_ * 3}; }
+    
+    // 一个模式中一个原子的 x/y/z 位移
+    std::span<double, 3> atom(size_t m, size_t a) {
+        return std::span<double, 3>(values_.data() + (m * atoms_ + a) * 3, 3);
+    }
+    std::span<const double, 3> atom(size_t m, size_t a) const {
+        return std::span<const double, 3>(values_.data() + (m * atoms_ + a) * 3, 3);
+    }
+    
+private:
+    std::pmr::vector<double> values_;
+    size_t modes_;
+    size_t atoms_;
+};
+
 // 热力学数据结构
 struct ThermoData {
     double temperature;
@@ -75,39 +183,62 @@ struct OrbitalTransition {
     OrbitalTransition() : fromOrb(0), toOrb(0), coefficient(0.0), isAlpha(true), isForward(true) {}
 };
 
-// 激发态结构
+// 激发态结构（分配器感知：放进 ParsedData 的容器时说明文字和跃迁列表使用同一个内存资源）
 struct ExcitedState {
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    
     int stateNumber;
-    std::string symmetry;        // e.g., "Singlet-A'", "Triplet-A""
+    InternedString symmetry;     // e.g., "Singlet-A'", "Triplet-A""
     double excitationEnergy_eV;  // 激发能量 (eV)
     double wavelength_nm;        // 波长 (nm)
     double oscillatorStrength;   // 振荡强度 f
     double s2Value;             // <S**2> 值
-    std::vector<OrbitalTransition> transitions; // 轨道跃迁列表
+    std::pmr::vector<OrbitalTransition> transitions; // 轨道跃迁列表
     
     // 可选信息
     bool hasOptimizationInfo;    // 是否有优化相关信息
     bool hasTotalEnergy;         // 是否有总能量
     double totalEnergy;          // Total Energy, E(TD-HF/TD-DFT)
-    std::string additionalInfo;  // 额外信息，如"This state for optimization..."
+    std::pmr::string additionalInfo;  // 额外信息，如"This state for optimization..."
     
-    ExcitedState() : stateNumber(1), symmetry("Singlet-A"), excitationEnergy_eV(0.0),
-                     wavelength_nm(0.0), oscillatorStrength(0.0), s2Value(0.0),
-                     hasOptimizationInfo(false), hasTotalEnergy(false), totalEnergy(0.0) {}
+    explicit ExcitedState(allocator_type alloc = {})
+        : stateNumber(1), symmetry("Singlet-A"), excitationEnergy_eV(0.0),
+          wavelength_nm(0.0), oscillatorStrength(0.0), s2Value(0.0), transitions(alloc),
+          hasOptimizationInfo(false), hasTotalEnergy(false), totalEnergy(0.0), additionalInfo(alloc) {}
+    ExcitedState(const ExcitedState& other, allocator_type alloc);
+    ExcitedState(ExcitedState&& other, allocator_type alloc);
+    ExcitedState(const ExcitedState&) = default;
+    ExcitedState(ExcitedState&&) = default;
+    ExcitedState& operator=(const ExcitedState&) = default;
+    ExcitedState& operator=(ExcitedState&&) = default;
 };
 
 // TDDFT数据结构
 struct TDDFTData {
-    std::vector<ExcitedState> excitedStates;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    
+    std::pmr::vector<ExcitedState> excitedStates;
     bool hasData;
     
-    TDDFTData() : hasData(false) {}
+    explicit TDDFTData(allocator_type alloc = {}) : excitedStates(alloc), hasData(false) {}
+    TDDFTData(const TDDFTData& other, allocator_type alloc)
+        : excitedStates(other.excitedStates, alloc), hasData(other.hasData) {}
+    TDDFTData(TDDFTData&& other, allocator_type alloc)
+        : excitedStates(std::move(other.excitedStates), alloc), hasData(other.hasData) {}
+    TDDFTData(const TDDFTData&) = default;
+    TDDFTData(TDDFTData&&) = default;
+    TDDFTData& operator=(const TDDFTData&) = default;
+    TDDFTData& operator=(TDDFTData&&) = default;
 };
 
 // 解析结果数据结构
+//
+// 轨迹、频率、位移和TD-DFT数据都从构造时给定的内存资源分配。一次转换使用一个
+// 单调增长的竞技场（std::pmr::monotonic_buffer_resource）时，析构后由竞技场一次性回收
 struct ParsedData {
-    std::vector<OptStep> optSteps;
-    std::vector<FreqMode> frequencies;
+    Trajectory optSteps;
+    std::pmr::vector<FreqMode> frequencies;
+    DisplacementMatrix displacements; // frequencies 对应的原子位移
     ThermoData thermoData;
     bool hasOpt;
     bool hasFreq;
@@ -118,22 +249,34 @@ struct ParsedData {
     bool hasChargeSpinInfo;
     
     // TDDFT information
-    std::vector<TDDFTData> tddftData; // 每个优化步骤对应一个TDDFT数据
+    std::pmr::vector<TDDFTData> tddftData; // 每个优化步骤对应一个TDDFT数据
     bool hasTDDFT;
     
-    ParsedData() : hasOpt(false), hasFreq(false), charge(0), spin(1), hasChargeSpinInfo(false), hasTDDFT(false) {}
+    // 流式模式下已交给StepSink写出的步骤数（此时 optSteps 只保留最后一步，供频率部分使用）
+    size_t streamedSteps;
+    
+    explicit ParsedData(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : optSteps(resource), frequencies(resource), displacements(resource), hasOpt(false), hasFreq(false),
+          charge(0), spin(1), hasChargeSpinInfo(false), tddftData(resource), hasTDDFT(false), streamedSteps(0) {}
+    
+    // 解析器构造要放进 data 的临时容器时使用同一个内存资源，移入时不必复制
+    std::pmr::memory_resource* resource() const { return frequencies.get_allocator().resource(); }
+    
+    // 优化步骤总数（包括已流式写出的步骤）
+    size_t stepCount() const { return streamedSteps > 0 ? streamedSteps : optSteps.size(); }
 };
 
-// 元素映射管理类
-class ElementMap {
-private:
-    std::map<std::string, int> elementMap;
-    void initElementMap();
-    
+// 优化步骤接收端（流式解析）
+//
+// 解析器每得到一个完整的优化步骤就按顺序交给sink，sink立即处理（例如格式化写出），
+// 因此内存中不必保留整条轨迹。
+class StepSink {
 public:
-    ElementMap();
-    int getAtomicNumber(const std::string& symbol) const;
-    bool hasElement(const std::string& symbol) const;
+    virtual ~StepSink() = default;
+    
+    // frame 和 tddft 只在调用期间有效；data 中此时已有的全局信息（电荷、自旋等）可以使用。
+    // 返回false表示处理失败，解析器应停止继续提交
+    virtual bool consumeStep(const ParsedData& data, const FrameView& frame, const TDDFTData* tddft) = 0;
 };
 
 } // namespace data
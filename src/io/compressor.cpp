@@ -0,0 +1,415 @@
+#include "compressor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "io/file_reader.h"
+
+#ifdef FAKEG_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef FAKEG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace fakeg {
+namespace io {
+
+// 压缩器：把一块输入压缩后写入文件。flush 时把目前为止的内容完整写出（解压端可以读到这里），
+// last 时结束压缩流
+class CompressingStreamBuf::Encoder {
+public:
+    virtual ~Encoder() = default;
+    virtual bool encode(const char* data, size_t size, bool flush, bool last, std::ostream& out) = 0;
+};
+
+namespace {
+
+constexpr size_t kOutputBlock = 256 * 1024;
+
+void setBinaryStdout() {
+#ifdef _WIN32
+    std::cout.flush();
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+#ifdef FAKEG_HAVE_ZLIB
+class GzipEncoder : public CompressingStreamBuf::Encoder {
+public:
+    explicit GzipEncoder(int level) : buffer_(kOutputBlock), ready_(false) {
+        // 15 + 16：写 gzip 头和尾
+        ready_ = deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipEncoder() override {
+        if (ready_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    bool encode(const char* data, size_t size, bool flush, bool last, std::ostream& out) override {
+        if (!ready_) {
+            return false;
+        }
+
+        // avail_in 是 uInt，1 MiB 的块不会超出
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream_.avail_in = static_cast<uInt>(size);
+        const int mode = last ? Z_FINISH : (flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+        while (true) {
+            stream_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+            stream_.avail_out = static_cast<uInt>(buffer_.size());
+            const int result = deflate(&stream_, mode);
+            if (result == Z_STREAM_ERROR) {
+                return false;
+            }
+            out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size() - stream_.avail_out));
+            // 输出缓冲区没有写满说明这一块已处理完（Z_FINISH 需要等到 Z_STREAM_END）
+            if (last ? result == Z_STREAM_END : stream_.avail_out != 0) {
+                break;
+            }
+        }
+        return out.good();
+    }
+
+private:
+    z_stream stream_{};
+    std::vector<char> buffer_;
+    bool ready_;
+};
+#endif
+
+#ifdef FAKEG_HAVE_ZSTD
+class ZstdEncoder : public CompressingStreamBuf::Encoder {
+public:
+    explicit ZstdEncoder(int level) : stream_(ZSTD_createCCtx()), buffer_(ZSTD_CStreamOutSize()) {
+        if (stream_) {
+            ZSTD_CCtx_setParameter(stream_, ZSTD_c_compressionLevel, level);
+        }
+    }
+
+    ~ZstdEncoder() override {
+        ZSTD_freeCCtx(stream_);
+    }
+
+    bool encode(const char* data, size_t size, bool flush, bool last, std::ostream& out) override {
+        if (!stream_) {
+            return false;
+        }
+
+        ZSTD_inBuffer input{data, size, 0};
+        const ZSTD_EndDirective mode = last ? ZSTD_e_end : (flush ? ZSTD_e_flush : ZSTD_e_continue);
+        while (true) {
+            ZSTD_outBuffer output{buffer_.data(), buffer_.size(), 0};
+            const size_t remaining = ZSTD_compressStream2(stream_, &output, &input, mode);
+            if (ZSTD_isError(remaining)) {
+                return false;
+            }
+            out.write(buffer_.data(), static_cast<std::streamsize>(output.pos));
+            // continue 模式下输入读完即可；flush/end 模式下要等内部缓冲也全部写出
+            if (mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+                break;
+            }
+        }
+        return out.good();
+    }
+
+private:
+    ZSTD_CCtx* stream_;
+    std::vector<char> buffer_;
+};
+#endif
+
+} // namespace
+
+bool isOutputCompressionSupported(Compression type) {
+    switch (type) {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+        case Compression::Zstd:
+            return isCompressionSupported(type);
+        case Compression::Xz:
+            break;
+    }
+    return false;
+}
+
+int compressionLevel(Compression type, CompressionSpeed speed) {
+    if (type == Compression::Zstd) {
+        switch (speed) {
+            case CompressionSpeed::Fastest: return 1;
+            case CompressionSpeed::Balanced: return 3;
+            case CompressionSpeed::Smallest: return 19;
+        }
+    }
+    switch (speed) {
+        case CompressionSpeed::Fastest: return 1;
+        case CompressionSpeed::Balanced: return 6;
+        case CompressionSpeed::Smallest: return 9;
+    }
+    return 0;
+}
+
+const char* compressionExtension(Compression type) {
+    switch (type) {
+        case Compression::Gzip: return ".gz";
+        case Compression::Zstd: return ".zst";
+        case Compression::Xz: return ".xz";
+        case Compression::None: break;
+    }
+    return "";
+}
+
+// CompressingStreamBuf 实现
+CompressingStreamBuf::CompressingStreamBuf()
+    : out_(&file_), open_(false), busy_(false), failed_(false), stopping_(false) {}
+
+CompressingStreamBuf::~CompressingStreamBuf() {
+    close();
+}
+
+bool CompressingStreamBuf::open(const std::string& filename, Compression type, int level) {
+    close();
+    if (level <= 0) {
+        level = compressionLevel(type, CompressionSpeed::Balanced);
+    }
+
+    switch (type) {
+#ifdef FAKEG_HAVE_ZLIB
+        case Compression::Gzip:
+            encoder_ = std::make_unique<GzipEncoder>(level);
+            break;
+#endif
+#ifdef FAKEG_HAVE_ZSTD
+        case Compression::Zstd:
+            encoder_ = std::make_unique<ZstdEncoder>(level);
+            break;
+#endif
+        default:
+            return false;
+    }
+
+    if (isStdioPath(filename)) {
+        setBinaryStdout();
+        out_ = &std::cout;
+    } else {
+        file_.open(filename, std::ios::binary);
+        if (!file_.is_open()) {
+            encoder_.reset();
+            return false;
+        }
+        out_ = &file_;
+    }
+
+    current_ = std::make_unique<Chunk>();
+    current_->data.resize(kChunkSize);
+    resetPutArea();
+    failed_ = false;
+    stopping_ = false;
+    busy_ = false;
+    open_ = true;
+    worker_ = std::thread(&CompressingStreamBuf::run, this);
+    return true;
+}
+
+bool CompressingStreamBuf::isOpen() const {
+    return open_;
+}
+
+bool CompressingStreamBuf::close() {
+    if (!open_) {
+        return false;
+    }
+
+    submit(false, true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_one();
+    worker_.join();
+
+    bool ok = !failed_;
+    if (out_ == &file_) {
+        file_.close();
+        ok = ok && !file_.fail();
+    } else {
+        ok = out_->flush().good() && ok;
+    }
+    encoder_.reset();
+    current_.reset();
+    queue_.clear();
+    spare_.clear();
+    setp(nullptr, nullptr);
+    open_ = false;
+    return ok;
+}
+
+void CompressingStreamBuf::resetPutArea() {
+    current_->size = 0;
+    current_->flush = false;
+    current_->last = false;
+    setp(current_->data.data(), current_->data.data() + current_->data.size());
+}
+
+bool CompressingStreamBuf::submit(bool flush, bool last) {
+    current_->size = static_cast<size_t>(pptr() - pbase());
+    current_->flush = flush;
+    current_->last = last;
+
+    std::unique_ptr<Chunk> next;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this] { return failed_ || queue_.size() < kQueueChunks; });
+        if (failed_) {
+            return false;
+        }
+        queue_.push_back(std::move(current_));
+        if (!spare_.empty()) {
+            next = std::move(spare_.back());
+            spare_.pop_back();
+        }
+    }
+    queued_.notify_one();
+
+    if (!next) {
+        next = std::make_unique<Chunk>();
+        next->data.resize(kChunkSize);
+    }
+    current_ = std::move(next);
+    resetPutArea();
+    return true;
+}
+
+bool CompressingStreamBuf::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] { return failed_ || (queue_.empty() && !busy_); });
+    return !failed_;
+}
+
+void CompressingStreamBuf::run() {
+    while (true) {
+        std::unique_ptr<Chunk> chunk;
+        bool failed = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            chunk = std::move(queue_.front());
+            queue_.erase(queue_.begin());
+            busy_ = true;
+            failed = failed_;
+        }
+
+        // 出错后只丢弃剩余的块，让写入方尽快看到失败
+        const bool ok = !failed &&
+                        encoder_->encode(chunk->data.data(), chunk->size, chunk->flush, chunk->last, *out_);
+        if (ok && chunk->flush) {
+            out_->flush();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = failed_ || !ok || !out_->good();
+            busy_ = false;
+            spare_.push_back(std::move(chunk));
+        }
+        drained_.notify_all();
+    }
+}
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type ch) {
+    if (!open_ || !submit(false, false)) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize CompressingStreamBuf::xsputn(const char* data, std::streamsize count) {
+    std::streamsize written = 0;
+    while (written < count) {
+        if (pptr() == epptr() && (!open_ || !submit(false, false))) {
+            break;
+        }
+        const std::streamsize room = std::min<std::streamsize>(epptr() - pptr(), count - written);
+        std::memcpy(pptr(), data + written, static_cast<size_t>(room));
+        pbump(static_cast<int>(room));
+        written += room;
+    }
+    return written;
+}
+
+int CompressingStreamBuf::sync() {
+    if (!open_) {
+        return -1;
+    }
+    return submit(true, false) && waitIdle() ? 0 : -1;
+}
+
+// OutputFile 实现
+OutputFile::OutputFile() : std::ostream(nullptr), type_(Compression::None), stdout_(false) {}
+
+void OutputFile::open(const std::string& filename, Compression type, int level, bool append) {
+    close();
+    type_ = type;
+
+    // rdbuf() 同时清除流状态
+    bool opened = false;
+    if (type == Compression::None && isStdioPath(filename)) {
+        setBinaryStdout();
+        stdout_ = true;
+        opened = true;
+        rdbuf(std::cout.rdbuf());
+    } else if (type == Compression::None) {
+        const std::ios::openmode mode = std::ios::out | (append ? std::ios::app : std::ios::trunc);
+        opened = plain_.open(filename, mode) != nullptr;
+        rdbuf(&plain_);
+    } else {
+        opened = !append && compressed_.open(filename, type, level);
+        rdbuf(&compressed_);
+    }
+    if (!opened) {
+        setstate(std::ios::failbit);
+    }
+}
+
+bool OutputFile::is_open() const {
+    if (stdout_) {
+        return true;
+    }
+    return type_ == Compression::None ? plain_.is_open() : compressed_.isOpen();
+}
+
+void OutputFile::close() {
+    if (stdout_) {
+        stdout_ = false;
+        if (std::cout.rdbuf()->pubsync() != 0) {
+            setstate(std::ios::failbit);
+        }
+        return;
+    }
+    if (!is_open()) {
+        return;
+    }
+    const bool closed = type_ == Compression::None ? plain_.close() != nullptr : compressed_.close();
+    if (!closed) {
+        setstate(std::ios::failbit);
+    }
+}
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io/decompressor.h"
+
+namespace fakeg {
+namespace io {
+
+// 输出压缩级别的预设，按吞吐目标取舍速度和压缩率
+enum class CompressionSpeed {
+    Fastest,   // 格式化速度优先（gzip 1 / zstd 1）
+    Balanced,  // 默认（gzip 6 / zstd 3）
+    Smallest   // 文件大小优先（gzip 9 / zstd 19）
+};
+
+// 可用于输出的压缩格式（gzip/zstd，且编译时带了对应的库）
+bool isOutputCompressionSupported(Compression type);
+int compressionLevel(Compression type, CompressionSpeed speed);
+// 压缩输出文件的扩展名（".gz"、".zst"），不压缩时为空
+const char* compressionExtension(Compression type);
+
+// 在后台线程压缩并写入文件的streambuf
+//
+// 写入的内容先攒在 kChunkSize 大小的块里，块满后交给压缩线程，调用线程立即继续格式化；
+// 排队的块最多 kQueueChunks 个，压缩跟不上时写入方等待。sync() 等压缩线程写完已提交的内容。
+class CompressingStreamBuf : public std::streambuf {
+public:
+    static constexpr size_t kChunkSize = 1 << 20;
+    static constexpr size_t kQueueChunks = 4;
+
+    CompressingStreamBuf();
+    ~CompressingStreamBuf() override;
+
+    CompressingStreamBuf(const CompressingStreamBuf&) = delete;
+    CompressingStreamBuf& operator=(const CompressingStreamBuf&) = delete;
+
+    // 各压缩格式的实现（只在 compressor.cpp 中定义）
+    class Encoder;
+
+    // level 为 0 时使用 Balanced 预设；文件名 "-" 写到标准输出
+    bool open(const std::string& filename, Compression type, int level);
+    bool isOpen() const;
+    // 写出剩余内容和压缩流结尾，返回整个写入过程是否成功
+    bool close();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+
+private:
+    struct Chunk {
+        std::vector<char> data;
+        size_t size = 0;
+        bool flush = false;  // 压缩后刷新到文件（sync）
+        bool last = false;   // 压缩流在这一块之后结束
+    };
+
+    void run();
+    bool submit(bool flush, bool last);
+    bool waitIdle();
+    void resetPutArea();
+
+    std::unique_ptr<Encoder> encoder_;
+    std::ofstream file_;
+    std::ostream* out_;  // file_，或写到标准输出时的 std::cout
+    std::unique_ptr<Chunk> current_;
+    bool open_;
+
+    std::vector<std::unique_ptr<Chunk>> queue_;  // 等待压缩的块（按提交顺序）
+    std::vector<std::unique_ptr<Chunk>> spare_;  // 压缩完可以复用的块
+    bool busy_;    // 压缩线程正在处理一块
+    bool failed_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable drained_;
+    std::thread worker_;
+};
+
+// 输出文件：不压缩时等同 std::ofstream，否则经 CompressingStreamBuf 压缩写出。
+// 文件名 "-" 表示标准输出
+class OutputFile : public std::ostream {
+public:
+    OutputFile();
+
+    // append 只用于不压缩的输出（在已有文件末尾追加）
+    void open(const std::string& filename, Compression type = Compression::None, int level = 0,
+              bool append = false);
+    bool is_open() const;
+    // 与 std::ofstream 相同，失败时设置 failbit
+    void close();
+
+private:
+    std::filebuf plain_;
+    CompressingStreamBuf compressed_;
+    Compression type_;
+    bool stdout_;
+};
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,486 @@
+#include "decompressor.h"
+
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifdef FAKEG_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef FAKEG_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef FAKEG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fakeg {
+namespace io {
+
+// 解压线程向环中写数据的接口：buffer() 返回当前块的空闲部分，commit 记录写入的字节数，块写满时自动提交
+class Decompressor::Output {
+public:
+    explicit Output(Decompressor& owner) : owner_(owner), slot_(nullptr) {}
+
+    // 返回nullptr表示调用方已放弃读取，应停止解压
+    char* buffer() {
+        if (!slot_) {
+            slot_ = owner_.acquire();
+            if (!slot_) {
+                return nullptr;
+            }
+            slot_->size = 0;
+        }
+        return slot_->data.data() + slot_->size;
+    }
+
+    size_t space() const {
+        return slot_ ? kChunkSize - slot_->size : 0;
+    }
+
+    void commit(size_t count) {
+        slot_->size += count;
+        if (slot_->size == kChunkSize) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (slot_ && slot_->size > 0) {
+            owner_.publish(slot_);
+            slot_ = nullptr;
+        }
+    }
+
+private:
+    Decompressor& owner_;
+    Slot* slot_;
+};
+
+namespace {
+
+constexpr size_t kInputBlock = 256 * 1024;
+
+// 各格式的解压循环：从 input 读压缩数据，写入 out；出错时返回false并设置 error。
+// out.buffer() 返回nullptr（调用方已放弃）时直接返回true
+
+#ifdef FAKEG_HAVE_ZLIB
+bool inflateGzip(std::istream& input, Decompressor::Output& out, std::string& error) {
+    z_stream stream{};
+    // 15 + 32：自动识别 gzip/zlib 头
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        error = "Cannot initialize zlib";
+        return false;
+    }
+
+    std::vector<char> block(kInputBlock);
+    // 把尚未解压的输入移到块开头，再读入新数据补满；没有读到新数据时返回false
+    auto refill = [&]() {
+        if (stream.avail_in > 0) {
+            std::memmove(block.data(), stream.next_in, stream.avail_in);
+        }
+        input.read(block.data() + stream.avail_in, static_cast<std::streamsize>(block.size() - stream.avail_in));
+        stream.next_in = reinterpret_cast<Bytef*>(block.data());
+        stream.avail_in += static_cast<uInt>(input.gcount());
+        return input.gcount() > 0;
+    };
+
+    bool ok = true;
+    while (true) {
+        if (stream.avail_in == 0 && !refill()) {
+            error = "Unexpected end of gzip data";
+            ok = false;
+            break;
+        }
+
+        char* buffer = out.buffer();
+        if (!buffer) {
+            break;
+        }
+        const size_t space = out.space();
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = static_cast<uInt>(space);
+
+        const int result = inflate(&stream, Z_NO_FLUSH);
+        out.commit(space - stream.avail_out);
+        if (result == Z_STREAM_END) {
+            // 多个gzip成员首尾相接（例如 cat a.gz b.gz）时继续解下一个。
+            // 后面不是gzip魔数的数据（例如补齐块大小的0字节）与 gzip -d 一样忽略
+            while (stream.avail_in < 2 && refill()) {
+            }
+            if (stream.avail_in < 2 || stream.next_in[0] != 0x1f || stream.next_in[1] != 0x8b) {
+                break;
+            }
+            inflateReset(&stream);
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            error = std::string("Corrupt gzip data: ") + (stream.msg ? stream.msg : "unknown error");
+            ok = false;
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+    return ok;
+}
+#endif
+
+#ifdef FAKEG_HAVE_LZMA
+bool decodeXz(std::istream& input, Decompressor::Output& out, std::string& error) {
+    lzma_stream stream = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+        error = "Cannot initialize xz decoder";
+        return false;
+    }
+
+    std::vector<char> block(kInputBlock);
+    lzma_action action = LZMA_RUN;
+    bool ok = true;
+    while (true) {
+        if (stream.avail_in == 0 && action == LZMA_RUN) {
+            input.read(block.data(), static_cast<std::streamsize>(block.size()));
+            stream.next_in = reinterpret_cast<const uint8_t*>(block.data());
+            stream.avail_in = static_cast<size_t>(input.gcount());
+            if (stream.avail_in == 0) {
+                action = LZMA_FINISH;
+            }
+        }
+
+        char* buffer = out.buffer();
+        if (!buffer) {
+            break;
+        }
+        const size_t space = out.space();
+        stream.next_out = reinterpret_cast<uint8_t*>(buffer);
+        stream.avail_out = space;
+
+        const lzma_ret result = lzma_code(&stream, action);
+        out.commit(space - stream.avail_out);
+        if (result == LZMA_STREAM_END) {
+            break;
+        }
+        if (result != LZMA_OK) {
+            error = result == LZMA_BUF_ERROR ? "Unexpected end of xz data" : "Corrupt xz data";
+            ok = false;
+            break;
+        }
+    }
+
+    lzma_end(&stream);
+    return ok;
+}
+#endif
+
+#ifdef FAKEG_HAVE_ZSTD
+bool decodeZstd(std::istream& input, Decompressor::Output& out, std::string& error) {
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream) {
+        error = "Cannot initialize zstd decoder";
+        return false;
+    }
+
+    std::vector<char> block(kInputBlock);
+    ZSTD_inBuffer in{block.data(), 0, 0};
+    size_t pending = 1;  // 0 表示当前帧已完整解出
+    bool ok = true;
+    while (true) {
+        if (in.pos == in.size) {
+            input.read(block.data(), static_cast<std::streamsize>(block.size()));
+            in.size = static_cast<size_t>(input.gcount());
+            in.pos = 0;
+            if (in.size == 0) {
+                if (pending != 0) {
+                    error = "Unexpected end of zstd data";
+                    ok = false;
+                }
+                break;
+            }
+        }
+
+        char* buffer = out.buffer();
+        if (!buffer) {
+            break;
+        }
+        ZSTD_outBuffer output{buffer, out.space(), 0};
+        pending = ZSTD_decompressStream(stream, &output, &in);
+        out.commit(output.pos);
+        if (ZSTD_isError(pending)) {
+            error = std::string("Corrupt zstd data: ") + ZSTD_getErrorName(pending);
+            ok = false;
+            break;
+        }
+    }
+
+    ZSTD_freeDStream(stream);
+    return ok;
+}
+#endif
+
+} // namespace
+
+Compression detectCompression(std::string_view head) {
+    auto startsWith = [head](std::string_view magic) {
+        return head.substr(0, magic.size()) == magic;
+    };
+
+    if (startsWith("\x1f\x8b")) {
+        return Compression::Gzip;
+    }
+    if (startsWith("\x28\xb5\x2f\xfd")) {
+        return Compression::Zstd;
+    }
+    if (startsWith(std::string_view("\xfd" "7zXZ\x00", 6))) {
+        return Compression::Xz;
+    }
+    return Compression::None;
+}
+
+Compression detectFileCompression(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[8];
+    file.read(magic, sizeof(magic));
+    return detectCompression(std::string_view(magic, static_cast<size_t>(file.gcount())));
+}
+
+const char* compressionName(Compression type) {
+    switch (type) {
+        case Compression::Gzip: return "gzip";
+        case Compression::Zstd: return "zstd";
+        case Compression::Xz: return "xz";
+        case Compression::None: break;
+    }
+    return "none";
+}
+
+bool isCompressionSupported(Compression type) {
+    switch (type) {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+#ifdef FAKEG_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Zstd:
+#ifdef FAKEG_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Xz:
+#ifdef FAKEG_HAVE_LZMA
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool readFileHead(const std::string& filename, std::string& head, size_t bytes) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    head.resize(bytes);
+    file.read(head.data(), static_cast<std::streamsize>(bytes));
+    head.resize(static_cast<size_t>(file.gcount()));
+
+    const Compression type = detectCompression(head);
+    if (type == Compression::None) {
+        return true;
+    }
+
+    // 只解压到够用为止，析构时放弃剩余部分
+    Decompressor decompressor;
+    if (!decompressor.start(filename, type)) {
+        return false;
+    }
+    head.clear();
+    std::string_view chunk;
+    while (head.size() < bytes && decompressor.next(chunk)) {
+        head.append(chunk.substr(0, bytes - head.size()));
+    }
+    return !head.empty() || decompressor.error().empty();
+}
+
+Decompressor::Decompressor()
+    : ring_(kRingSlots), readIndex_(0), filled_(0), holding_(false), done_(true), cancelled_(false) {}
+
+Decompressor::~Decompressor() {
+    stop();
+}
+
+bool Decompressor::start(const std::string& filename, Compression type) {
+    stop();
+    file_.close();
+    file_.clear();
+    file_.open(filename, std::ios::binary);
+    if (!file_.is_open()) {
+        return false;
+    }
+    return start(file_, type);
+}
+
+bool Decompressor::start(std::istream& input, Compression type) {
+    stop();
+    if (type == Compression::None || !isCompressionSupported(type)) {
+        return false;
+    }
+
+    for (auto& slot : ring_) {
+        slot.data.resize(kChunkSize);
+        slot.size = 0;
+    }
+    readIndex_ = 0;
+    filled_ = 0;
+    holding_ = false;
+    done_ = false;
+    cancelled_ = false;
+    error_.clear();
+
+    worker_ = std::thread(&Decompressor::run, this, &input, type);
+    return true;
+}
+
+void Decompressor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+    writable_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void Decompressor::run(std::istream* stream, Compression type) {
+    std::istream& input = *stream;
+    Output out(*this);
+    std::string message;
+    bool ok = false;
+
+    switch (type) {
+#ifdef FAKEG_HAVE_ZLIB
+        case Compression::Gzip:
+            ok = inflateGzip(input, out, message);
+            break;
+#endif
+#ifdef FAKEG_HAVE_LZMA
+        case Compression::Xz:
+            ok = decodeXz(input, out, message);
+            break;
+#endif
+#ifdef FAKEG_HAVE_ZSTD
+        case Compression::Zstd:
+            ok = decodeZstd(input, out, message);
+            break;
+#endif
+        default:
+            message = std::string(compressionName(type)) + " is not supported";
+            break;
+    }
+
+    if (ok) {
+        out.flush();
+    }
+    if (input.bad()) {
+        message = "Read error";
+    }
+    finish(message);
+}
+
+Decompressor::Slot* Decompressor::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    writable_.wait(lock, [this] { return cancelled_ || filled_ < ring_.size(); });
+    if (cancelled_) {
+        return nullptr;
+    }
+    return &ring_[(readIndex_ + filled_) % ring_.size()];
+}
+
+void Decompressor::publish(Slot* slot) {
+    (void)slot; // 提交的总是 acquire 返回的那一块
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filled_++;
+    }
+    readable_.notify_one();
+}
+
+void Decompressor::finish(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = message;
+        done_ = true;
+    }
+    readable_.notify_one();
+}
+
+bool Decompressor::next(std::string_view& chunk) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 归还上一次取走的块
+    if (holding_) {
+        holding_ = false;
+        readIndex_ = (readIndex_ + 1) % ring_.size();
+        filled_--;
+        writable_.notify_one();
+    }
+
+    readable_.wait(lock, [this] { return filled_ > 0 || done_; });
+    if (filled_ == 0) {
+        return false;
+    }
+
+    const Slot& slot = ring_[readIndex_];
+    chunk = std::string_view(slot.data.data(), slot.size);
+    holding_ = true;
+    return true;
+}
+
+std::string Decompressor::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+bool DecompressingStreamBuf::open(const std::string& filename, Compression type) {
+    setg(nullptr, nullptr, nullptr);
+    return decompressor_.start(filename, type);
+}
+
+bool DecompressingStreamBuf::open(std::istream& input, Compression type) {
+    setg(nullptr, nullptr, nullptr);
+    return decompressor_.start(input, type);
+}
+
+std::string_view DecompressingStreamBuf::peek() {
+    if (gptr() == egptr() && traits_type::eq_int_type(underflow(), traits_type::eof())) {
+        return {};
+    }
+    return std::string_view(gptr(), static_cast<size_t>(egptr() - gptr()));
+}
+
+std::string DecompressingStreamBuf::error() const {
+    return decompressor_.error();
+}
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    // 取下一块时上一块归还给解压线程，读取区直接指向环中的块，不再复制
+    std::string_view chunk;
+    if (!decompressor_.next(chunk)) {
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+    char* data = const_cast<char*>(chunk.data());
+    setg(data, data, data + chunk.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+} // namespace io
+} // namespace fakeg
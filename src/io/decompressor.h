@@ -0,0 +1,122 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fakeg {
+namespace io {
+
+// 压缩格式（按文件开头的魔数识别，与扩展名无关）
+enum class Compression {
+    None,
+    Gzip,
+    Zstd,
+    Xz
+};
+
+Compression detectCompression(std::string_view head);
+// 读取文件开头的魔数判断压缩格式，无法读取时返回 None
+Compression detectFileCompression(const std::string& filename);
+const char* compressionName(Compression type);
+// 编译时是否带了对应的解压库（zstd 等库可能不存在）
+bool isCompressionSupported(Compression type);
+
+// 读取文件开头最多 bytes 字节；压缩文件返回解压后的开头
+bool readFileHead(const std::string& filename, std::string& head, size_t bytes);
+
+// 在后台线程解压整个文件
+//
+// 解压线程把数据写入固定数量的缓冲块组成的环，调用线程用 next() 依次取出；
+// 环满时解压线程等待，因此尚未处理的解压数据最多占 kRingSlots 个块。
+// 析构时停止并等待解压线程，可以只读取开头的一部分后提前放弃。
+class Decompressor {
+public:
+    static constexpr size_t kChunkSize = 1 << 20;
+    static constexpr size_t kRingSlots = 4;
+
+    Decompressor();
+    ~Decompressor();
+
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    // 打开文件并启动解压线程；文件无法打开或格式不支持时返回false
+    bool start(const std::string& filename, Compression type);
+    // 从已打开的流解压（例如标准输入中的内容），流在解压结束前必须有效
+    bool start(std::istream& input, Compression type);
+
+    // 取下一块解压数据，只在下一次调用 next 之前有效。全部取完或出错时返回false
+    bool next(std::string_view& chunk);
+
+    // 解压失败（数据损坏、文件截断等）时的错误信息，成功时为空
+    std::string error() const;
+
+    // 供解压线程使用的输出端
+    class Output;
+
+private:
+    struct Slot {
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    void run(std::istream* input, Compression type);
+    void stop();
+
+    // 解压线程：取得一个空闲块 / 提交已写满的块
+    Slot* acquire();
+    void publish(Slot* slot);
+    void finish(const std::string& message);
+
+    std::vector<Slot> ring_;
+    size_t readIndex_;   // 下一个交给调用线程的块
+    size_t filled_;      // 已提交、尚未被取走的块数
+    bool holding_;       // 调用线程正持有 readIndex_ 之前的那一块
+    bool done_;
+    bool cancelled_;
+    std::string error_;
+    std::ifstream file_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable readable_;
+    std::condition_variable writable_;
+    std::thread worker_;
+};
+
+// 以输入流的形式读取 Decompressor 的输出
+//
+// 解析器边读边解压，内存中只有环里的几个块，不需要整个解压后的内容。
+// 只能顺序读取（不支持seek）；解压出错时内容提前结束，读完后用 error() 检查
+class DecompressingStreamBuf : public std::streambuf {
+public:
+    DecompressingStreamBuf() = default;
+
+    DecompressingStreamBuf(const DecompressingStreamBuf&) = delete;
+    DecompressingStreamBuf& operator=(const DecompressingStreamBuf&) = delete;
+
+    bool open(const std::string& filename, Compression type);
+    // input 在读完之前必须有效
+    bool open(std::istream& input, Compression type);
+
+    // 已解压、尚未读取的内容（没有时先取下一块），不移动读取位置；读完时为空
+    std::string_view peek();
+
+    std::string error() const;
+
+protected:
+    int_type underflow() override;
+
+private:
+    Decompressor decompressor_;
+};
+
+} // namespace io
+} // namespace fakeg
@@ -1,42 +1,125 @@
 #include "file_reader.h"
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <filesystem>
 #include <algorithm>
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
 namespace fakeg {
 namespace io {
 
+bool isStdioPath(const std::string& path) {
+    return path == "-";
+}
+
+// 分块读取标准输入的streambuf，内存中只有当前一块。
+// 第一块读入后先不消费（peek），用于识别压缩格式和文件格式
+class FileReader::StdinBuffer : public std::streambuf {
+public:
+    static constexpr size_t kBlockSize = 256 * 1024;
+    static_assert(kBlockSize >= kHeadBytes);
+
+    StdinBuffer() : block_(kBlockSize), failed_(false) {}
+
+    // 尚未读取的内容（没有时先读入下一块），不移动读取位置；读完时为空
+    std::string_view peek() {
+        if (gptr() == egptr() && traits_type::eq_int_type(underflow(), traits_type::eof())) {
+            return {};
+        }
+        return std::string_view(gptr(), static_cast<size_t>(egptr() - gptr()));
+    }
+
+    bool failed() const { return failed_; }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        // fread 在管道上也会读满一块，除非已到末尾
+        const size_t got = std::fread(block_.data(), 1, block_.size(), stdin);
+        if (got == 0) {
+            failed_ = std::ferror(stdin) != 0;
+            setg(nullptr, nullptr, nullptr);
+            return traits_type::eof();
+        }
+        setg(block_.data(), block_.data(), block_.data() + got);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::vector<char> block_;
+    bool failed_;
+};
+
 // FileReader类实现
-FileReader::FileReader() : encoding(FileEncoding::AUTO_DETECT) {}
+FileReader::FileReader()
+    : encoding(FileEncoding::AUTO_DETECT), mode(ReadMode::MemoryMap), viewStart(0), compression(Compression::None),
+      inMemory(false), stdinStream(nullptr), sequentialStream(nullptr), sizeHint(0) {}
 
-FileReader::FileReader(const std::string& filename, FileEncoding encoding) 
-    : filename(filename), encoding(encoding) {
-    open(filename, encoding);
+FileReader::FileReader(const std::string& filename, FileEncoding encoding, ReadMode mode) 
+    : filename(filename), encoding(encoding), mode(mode), viewStart(0), compression(Compression::None),
+      inMemory(false), stdinStream(nullptr), sequentialStream(nullptr), sizeHint(0) {
+    open(filename, encoding, mode);
 }
 
 FileReader::~FileReader() {
     close();
 }
 
-bool FileReader::open(const std::string& filename, FileEncoding encoding) {
+bool FileReader::open(const std::string& filename, FileEncoding encoding, ReadMode mode) {
     close(); // 关闭之前的文件
     
     this->filename = filename;
     this->encoding = encoding;
+    this->mode = mode;
+    
+    if (isStdioPath(filename)) {
+        return openStdin();
+    }
+    
+    // 按魔数识别压缩文件（与扩展名无关）
+    compression = detectFileCompression(filename);
+    if (compression != Compression::None) {
+        if (openCompressed()) {
+            return true;
+        }
+        compression = Compression::None;
+        return false;
+    }
+    
+    // 优先使用内存映射，失败时回退到流读取
+    if (mode == ReadMode::MemoryMap) {
+        if (mapping.open(filename)) {
+            mappedStream.reset(mapping.view());
+            // 只看开头，不为检测编码把整个映射读一遍
+            if (encoding == FileEncoding::AUTO_DETECT) {
+                this->encoding = detectEncoding(head());
+            }
+            return true;
+        }
+        this->mode = ReadMode::Stream;
+    }
     
     file.open(filename);
     if (!file.is_open()) {
+        lastError = "Cannot open file";
         return false;
     }
     
-    // 如果需要自动检测编码
+    // 留一份开头用于格式识别和编码检测
+    headBuffer.resize(kHeadBytes);
+    file.read(headBuffer.data(), static_cast<std::streamsize>(kHeadBytes));
+    headBuffer.resize(static_cast<size_t>(file.gcount()));
+    file.clear();
+    file.seekg(0, std::ios::beg);
     if (encoding == FileEncoding::AUTO_DETECT) {
-        std::string content = readAll();
-        this->encoding = detectEncoding(content);
-        // 重新打开文件
-        file.close();
-        file.open(filename);
+        this->encoding = detectEncoding(headBuffer);
     }
     
     return file.is_open();
@@ -46,16 +129,166 @@ void FileReader::close() {
     if (file.is_open()) {
         file.close();
     }
+    mapping.close();
+    mappedStream.reset(std::string_view());
+    viewStart = 0;
+    compression = Compression::None;
+    inMemory = false;
+    std::string().swap(inflated);
+    lastError.clear();
+    // 解压线程可能还在读标准输入，先停止解压再释放标准输入的缓冲
+    sequentialStream.rdbuf(nullptr);
+    decompressed.reset();
+    stdinStream.rdbuf(nullptr);
+    stdinBuffer.reset();
+    headBuffer.clear();
+    sizeHint = 0;
+}
+
+bool FileReader::openCompressed() {
+    if (!isCompressionSupported(compression)) {
+        lastError = std::string(compressionName(compression)) + " compressed input is not supported by this build";
+        return false;
+    }
+    
+    decompressed = std::make_unique<DecompressingStreamBuf>();
+    const bool started = stdinBuffer ? decompressed->open(stdinStream, compression)
+                                     : decompressed->open(filename, compression);
+    if (!started) {
+        decompressed.reset();
+        lastError = "Cannot open file";
+        return false;
+    }
+    
+    // 第一块解压数据就是开头；开头就损坏的文件在这里直接报错
+    const std::string_view first = decompressed->peek();
+    if (first.empty() && !decompressed->error().empty()) {
+        lastError = decompressed->error();
+        decompressed.reset();
+        return false;
+    }
+    headBuffer.assign(first.substr(0, std::min(first.size(), kHeadBytes)));
+    if (encoding == FileEncoding::AUTO_DETECT) {
+        this->encoding = detectEncoding(headBuffer);
+    }
+    
+    // 解压比例未知，整个读入时先按压缩文件大小的几倍预留，减少扩容拷贝
+    std::error_code ec;
+    const uintmax_t packedSize = std::filesystem::file_size(filename, ec);
+    sizeHint = ec ? 0 : static_cast<size_t>(packedSize) * 4;
+    
+    sequentialStream.rdbuf(decompressed.get());
+    return true;
+}
+
+bool FileReader::bufferContent() {
+    if (!isSequential()) {
+        return true;
+    }
+    
+    // 直接读入 inflated 的空闲部分，不经过中间缓冲
+    std::streambuf* source = sequentialStream.rdbuf();
+    size_t size = 0;
+    inflated.resize(std::max(sizeHint, kHeadBytes));
+    while (true) {
+        if (size == inflated.size()) {
+            inflated.resize(inflated.size() * 2);
+        }
+        const std::streamsize got = source->sgetn(inflated.data() + size,
+                                                  static_cast<std::streamsize>(inflated.size() - size));
+        if (got <= 0) {
+            break;
+        }
+        size += static_cast<size_t>(got);
+    }
+    inflated.resize(size);
+    
+    const std::string error = getError();
+    sequentialStream.rdbuf(nullptr);
+    decompressed.reset();
+    stdinStream.rdbuf(nullptr);
+    stdinBuffer.reset();
+    if (!error.empty()) {
+        lastError = error;
+        std::string().swap(inflated);
+        return false;
+    }
+    
+    finishInMemory(encoding);
+    return true;
+}
+
+bool FileReader::isSequential() const {
+    return sequentialStream.rdbuf() != nullptr;
+}
+
+bool FileReader::openStdin() {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    
+    // 管道无法回退：只读入第一块用于识别，其余内容在解析时继续读取；
+    // 内容是压缩数据时（例如 cat job.aop.gz |）边读边解压
+    stdinBuffer = std::make_unique<StdinBuffer>();
+    const std::string_view first = stdinBuffer->peek();
+    if (stdinBuffer->failed()) {
+        stdinBuffer.reset();
+        lastError = "Cannot read standard input";
+        return false;
+    }
+    
+    compression = detectCompression(first);
+    if (compression != Compression::None) {
+        stdinStream.rdbuf(stdinBuffer.get());
+        if (openCompressed()) {
+            return true;
+        }
+        compression = Compression::None;
+        return false;
+    }
+    
+    headBuffer.assign(first.substr(0, std::min(first.size(), kHeadBytes)));
+    if (encoding == FileEncoding::AUTO_DETECT) {
+        this->encoding = detectEncoding(headBuffer);
+    }
+    sequentialStream.rdbuf(stdinBuffer.get());
+    return true;
+}
+
+void FileReader::finishInMemory(FileEncoding detected) {
+    if (encoding == FileEncoding::AUTO_DETECT) {
+        this->encoding = detected;
+    }
+    inMemory = true;
+    mappedStream.reset(content());
+}
+
+std::string_view FileReader::content() const {
+    return inMemory ? std::string_view(inflated) : mapping.view();
 }
 
 bool FileReader::isOpen() const {
-    return file.is_open();
+    return isMapped() || isSequential() || file.is_open();
 }
 
-std::ifstream& FileReader::getStream() {
+std::istream& FileReader::getStream() {
+    if (isMapped()) {
+        return mappedStream;
+    }
+    if (isSequential()) {
+        return sequentialStream;
+    }
     return file;
 }
 
+std::string_view FileReader::head() const {
+    if (isMapped()) {
+        const std::string_view content = view();
+        return content.substr(0, std::min(content.size(), kHeadBytes));
+    }
+    return headBuffer;
+}
+
 std::string FileReader::getFilename() const {
     return filename;
 }
@@ -64,18 +297,71 @@ FileEncoding FileReader::getEncoding() const {
     return encoding;
 }
 
+Compression FileReader::getCompression() const {
+    return compression;
+}
+
+std::string FileReader::getError() const {
+    if (!lastError.empty()) {
+        return lastError;
+    }
+    if (decompressed && !decompressed->error().empty()) {
+        return decompressed->error();
+    }
+    if (stdinBuffer && stdinBuffer->failed()) {
+        return "Cannot read standard input";
+    }
+    return lastError;
+}
+
+ReadMode FileReader::getReadMode() const {
+    return mode;
+}
+
 size_t FileReader::getFileSize() const {
+    if (isMapped()) {
+        return content().size();
+    }
     if (!std::filesystem::exists(filename)) {
         return 0;
     }
     return std::filesystem::file_size(filename);
 }
 
+bool FileReader::isMapped() const {
+    return mapping.isOpen() || inMemory;
+}
+
+std::string_view FileReader::view() const {
+    return content().substr(viewStart);
+}
+
+bool FileReader::setViewStart(size_t offset) {
+    if (!isMapped() || offset > content().size()) {
+        return false;
+    }
+    viewStart = offset;
+    mappedStream.reset(view());
+    return true;
+}
+
+size_t FileReader::getViewStart() const {
+    return viewStart;
+}
+
+LineIterator FileReader::lines(size_t startOffset) const {
+    return LineIterator(view(), startOffset);
+}
+
 std::string FileReader::readAll() {
     if (!isOpen()) return "";
     
+    if (isMapped()) {
+        return std::string(view());
+    }
+    
     std::ostringstream oss;
-    oss << file.rdbuf();
+    oss << getStream().rdbuf();
     return oss.str();
 }
 
@@ -83,15 +369,16 @@ std::vector<std::string> FileReader::readLines() {
     std::vector<std::string> lines;
     if (!isOpen()) return lines;
     
+    std::istream& stream = getStream();
     std::string line;
-    while (std::getline(file, line)) {
+    while (std::getline(stream, line)) {
         lines.push_back(line);
     }
     
     return lines;
 }
 
-FileEncoding FileReader::detectEncoding(const std::string& content) {
+FileEncoding FileReader::detectEncoding(std::string_view content) {
     // 简单的编码检测逻辑
     // 在实际项目中可能需要更复杂的检测算法
     
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <istream>
+#include <memory>
 #include <vector>
 
+#include "io/decompressor.h"
+#include "io/line_iterator.h"
+#include "io/mapped_file.h"
+#include "io/memory_stream.h"
+
 namespace fakeg {
 namespace io {
 
@@ -15,35 +23,102 @@ enum class FileEncoding {
     AUTO_DETECT
 };
 
+// 文件读取方式
+enum class ReadMode {
+    MemoryMap,  // 映射整个文件，编码检测、查找和解析共用同一份映射（映射失败时回退到Stream）
+    Stream      // 传统 std::ifstream 读取
+};
+
+// 文件名 "-" 表示标准输入（读取）或标准输出（写入），用于管道
+bool isStdioPath(const std::string& path);
+
 // 文件读取器类
+//
+// 标准输入和压缩文件无法映射，打开后只读入（解压）开头（见 head()），其余内容在解析器从 getStream()
+// 顺序读取时边读边解压，内存中只有几个数据块。需要在内容中回退和跳转（view()、seekg）的解析器
+// 先调用 bufferContent() 把内容整个读入内存，之后与映射的文件用法相同
 class FileReader {
 private:
     std::string filename;
     FileEncoding encoding;
+    ReadMode mode;
     std::ifstream file;
 
-    // 编码检测和转换
-    FileEncoding detectEncoding(const std::string& content);
+    // MemoryMap 模式下的映射和基于映射的输入流
+    MappedFile mapping;
+    MemoryInputStream mappedStream;
+    size_t viewStart;  // 可见内容在映射中的起点（见 setViewStart）
+
+    // bufferContent() 读入内存的完整内容，之后与映射内容的用法相同
+    Compression compression;
+    bool inMemory;
+    std::string inflated;
+    std::string lastError;
+
+    // 顺序读取：sequentialStream 读 stdinBuffer（标准输入）或 decompressed（压缩数据），
+    // 标准输入中是压缩数据时 decompressed 经 stdinStream 读 stdinBuffer。headBuffer 为（解压后的）开头
+    class StdinBuffer;
+    std::unique_ptr<StdinBuffer> stdinBuffer;
+    std::istream stdinStream;
+    std::unique_ptr<DecompressingStreamBuf> decompressed;
+    std::istream sequentialStream;
+    std::string headBuffer;
+    size_t sizeHint;  // bufferContent 预留的大小
+
+    bool openStdin();
+    bool openCompressed();
+    void finishInMemory(FileEncoding detected);
+    std::string_view content() const;
+
+    // 编码检测（只看开头 kHeadBytes）和转换
+    FileEncoding detectEncoding(std::string_view content);
     std::string convertEncoding(const std::string& content, FileEncoding from, FileEncoding to);
 
 public:
     FileReader();
-    FileReader(const std::string& filename, FileEncoding encoding = FileEncoding::AUTO_DETECT);
+    FileReader(const std::string& filename, FileEncoding encoding = FileEncoding::AUTO_DETECT,
+               ReadMode mode = ReadMode::MemoryMap);
     ~FileReader();
 
     // 文件操作
-    bool open(const std::string& filename, FileEncoding encoding = FileEncoding::AUTO_DETECT);
+    bool open(const std::string& filename, FileEncoding encoding = FileEncoding::AUTO_DETECT,
+              ReadMode mode = ReadMode::MemoryMap);
     void close();
     bool isOpen() const;
 
     // 获取文件流的引用（用于解析器）
-    std::ifstream& getStream();
+    std::istream& getStream();
+
+    // 内容开头（最多 kHeadBytes 字节），用于识别格式，不影响 getStream() 的读取位置
+    static constexpr size_t kHeadBytes = 64 * 1024;
+    std::string_view head() const;
+
+    // 只能顺序读取的内容（标准输入、压缩文件）整个读入内存，之后 isMapped() 为true；
+    // 已经可以随机访问时直接返回true。必须在从 getStream() 读取之前调用
+    bool bufferContent();
+    bool isSequential() const;
 
     // 文件信息
     std::string getFilename() const;
     FileEncoding getEncoding() const;
+    Compression getCompression() const;
+    // open 失败的原因；顺序读取时解压出错只表现为内容提前结束，读完后也要检查
+    std::string getError() const;
+    ReadMode getReadMode() const;
     size_t getFileSize() const;
 
+    // 映射内容（MemoryMap 模式、标准输入或压缩文件读入后可用，否则为空）
+    bool isMapped() const;
+    std::string_view view() const;
+
+    // 只把映射中 offset 之后的内容交给解析器（view、lines、getStream 都从这里开始）。
+    // 断点续转时用来只解析文件尾部；仅 MemoryMap 模式可用
+    bool setViewStart(size_t offset);
+    size_t getViewStart() const;
+
+    // 按行遍历映射内容，行的起始偏移可直接用于 seekg
+    LineIterator lines(size_t startOffset = 0) const;
+
     // 读取整个文件内容
     std::string readAll();
 
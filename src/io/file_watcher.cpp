@@ -0,0 +1,63 @@
+#include "file_watcher.h"
+
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fakeg {
+namespace io {
+
+FileWatcher::FileWatcher(const std::string& filename) : inotifyFd_(-1), watchFd_(-1) {
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ >= 0) {
+        watchFd_ = inotify_add_watch(inotifyFd_, filename.c_str(),
+                                     IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        if (watchFd_ < 0) {
+            ::close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+    }
+#else
+    (void)filename; // 抑制未使用参数警告
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        ::close(inotifyFd_);
+    }
+#endif
+}
+
+bool FileWatcher::wait(int timeoutMs) {
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        pollfd fd{inotifyFd_, POLLIN, 0};
+        if (::poll(&fd, 1, timeoutMs) <= 0) {
+            return false;
+        }
+        
+        // 取走所有排队的事件，具体内容由调用方重新读取文件得知
+        char events[4096];
+        while (::read(inotifyFd_, events, sizeof(events)) > 0) {
+        }
+        return true;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    return false;
+}
+
+bool FileWatcher::isNotifying() const {
+    return inotifyFd_ >= 0;
+}
+
+} // namespace io
+} // namespace fakeg
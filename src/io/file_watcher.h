@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+namespace fakeg {
+namespace io {
+
+// 等待文件内容变化（跟踪模式）
+//
+// Notes:
+// - Linux 上使用 inotify，文件被写入时立即返回
+// - 其它平台或 inotify 不可用时退化为轮询：每次等满超时时间，由调用方重新检查文件
+// - 不可拷贝
+class FileWatcher {
+private:
+    int inotifyFd_;
+    int watchFd_;
+
+public:
+    explicit FileWatcher(const std::string& filename);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // 最多等待 timeoutMs 毫秒；收到变化通知时返回true，超时（或轮询模式）返回false
+    bool wait(int timeoutMs);
+
+    bool isNotifying() const;
+};
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,130 @@
+#include "format_buffer.h"
+
+#include <charconv>
+#include <iomanip>
+#include <sstream>
+
+namespace fakeg {
+namespace io {
+
+namespace {
+
+// 足够容纳任何double的fixed表示（最大约309位整数部分）加上常用精度
+constexpr size_t kNumberScratch = 400;
+
+} // namespace
+
+FormatBuffer::FormatBuffer(std::ostream* sink, size_t capacity) : sink_(nullptr), capacity_(capacity) {
+    attach(sink);
+}
+
+FormatBuffer::~FormatBuffer() {
+    flush();
+}
+
+void FormatBuffer::attach(std::ostream* sink) {
+    flush();
+    sink_ = sink;
+    // 未绑定输出流时不占用内存
+    if (sink_ && data_.capacity() < capacity_) {
+        data_.reserve(capacity_ + kNumberScratch);
+    }
+}
+
+bool FormatBuffer::flush() {
+    if (!sink_) {
+        return false;
+    }
+    if (!data_.empty()) {
+        sink_->write(data_.data(), static_cast<std::streamsize>(data_.size()));
+        data_.clear();
+    }
+    sink_->flush();
+    return sink_->good();
+}
+
+void FormatBuffer::discard() {
+    data_.clear();
+}
+
+size_t FormatBuffer::size() const {
+    return data_.size();
+}
+
+void FormatBuffer::pad(size_t length, int width) {
+    if (width > 0 && length < static_cast<size_t>(width)) {
+        data_.append(static_cast<size_t>(width) - length, ' ');
+    }
+}
+
+void FormatBuffer::flushIfFull() {
+    if (data_.size() >= capacity_ && sink_) {
+        sink_->write(data_.data(), static_cast<std::streamsize>(data_.size()));
+        data_.clear();
+    }
+}
+
+FormatBuffer& FormatBuffer::text(std::string_view value) {
+    data_.append(value);
+    return *this;
+}
+
+FormatBuffer& FormatBuffer::text(std::string_view value, int width) {
+    pad(value.size(), width);
+    data_.append(value);
+    return *this;
+}
+
+FormatBuffer& FormatBuffer::left(std::string_view value, int width) {
+    data_.append(value);
+    pad(value.size(), width);
+    return *this;
+}
+
+FormatBuffer& FormatBuffer::spaces(int count) {
+    pad(0, count);
+    return *this;
+}
+
+FormatBuffer& FormatBuffer::integer(long long value, int width) {
+    char scratch[24];
+    const auto result = std::to_chars(scratch, scratch + sizeof(scratch), value);
+    return text(std::string_view(scratch, static_cast<size_t>(result.ptr - scratch)), width);
+}
+
+FormatBuffer& FormatBuffer::fixed(double value, int precision, int width) {
+    char scratch[kNumberScratch];
+    const auto result = std::to_chars(scratch, scratch + sizeof(scratch), value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        // 精度过大时放不下，回退到iostream
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(precision) << value;
+        return text(oss.str(), width);
+    }
+    return text(std::string_view(scratch, static_cast<size_t>(result.ptr - scratch)), width);
+}
+
+FormatBuffer& FormatBuffer::scientific(double value, int precision, int width) {
+    char scratch[kNumberScratch];
+    const auto result = std::to_chars(scratch, scratch + sizeof(scratch), value, std::chars_format::scientific, precision);
+    if (result.ec != std::errc()) {
+        std::ostringstream oss;
+        oss << std::scientific << std::setprecision(precision) << value;
+        return text(oss.str(), width);
+    }
+    return text(std::string_view(scratch, static_cast<size_t>(result.ptr - scratch)), width);
+}
+
+FormatBuffer& FormatBuffer::newline() {
+    data_.push_back('\n');
+    flushIfFull();
+    return *this;
+}
+
+FormatBuffer& FormatBuffer::line(std::string_view value) {
+    data_.append(value);
+    return newline();
+}
+
+} // namespace io
+} // namespace fakeg
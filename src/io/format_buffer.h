@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace fakeg {
+namespace io {
+
+// 定宽字段格式化缓冲区
+//
+// 数值用 std::to_chars 直接格式化进一块大缓冲区，攒满后一次性写入输出流，
+// 避免逐字段经过 iostream 的 locale/facet 和 std::endl 的逐行flush。
+//
+// Notes:
+// - 输出与 iostream 逐字节一致：fixed/scientific 等价于 std::fixed/std::scientific 加 setprecision，
+//   width 等价于 setw（默认右对齐，left 对应 std::left），宽度不足时不截断
+// - 析构时自动 flush；需要检查写入是否成功时显式调用 flush()
+class FormatBuffer {
+private:
+    std::ostream* sink_;
+    std::string data_;
+    size_t capacity_;
+
+    void pad(size_t length, int width);
+    void flushIfFull();
+
+public:
+    static constexpr size_t kDefaultCapacity = 1 << 20;
+
+    explicit FormatBuffer(std::ostream* sink = nullptr, size_t capacity = kDefaultCapacity);
+    ~FormatBuffer();
+
+    FormatBuffer(const FormatBuffer&) = delete;
+    FormatBuffer& operator=(const FormatBuffer&) = delete;
+
+    // 绑定输出流（之前缓冲的内容先写入原来的流）
+    void attach(std::ostream* sink);
+
+    // 把缓冲内容写入输出流，返回流的状态
+    bool flush();
+    // 丢弃未写出的内容
+    void discard();
+    size_t size() const;
+
+    // 字段
+    FormatBuffer& text(std::string_view value);
+    FormatBuffer& text(std::string_view value, int width);     // 右对齐
+    FormatBuffer& left(std::string_view value, int width);     // 左对齐
+    FormatBuffer& spaces(int count);
+    FormatBuffer& integer(long long value, int width = 0);
+    FormatBuffer& fixed(double value, int precision, int width = 0);
+    FormatBuffer& scientific(double value, int precision, int width = 0);
+
+    // 行结束（缓冲区满时在行边界写出）
+    FormatBuffer& newline();
+    FormatBuffer& line(std::string_view value);  // text(value).newline()
+};
+
+} // namespace io
+} // namespace fakeg
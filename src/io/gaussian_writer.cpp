@@ -1,16 +1,19 @@
 #include "gaussian_writer.h"
-#include <iomanip>
+#include "file_reader.h"
 #include <filesystem>
-#include <sstream>
 #include <algorithm>
+#include <system_error>
 
 namespace fakeg {
 namespace io {
 
-GaussianWriter::GaussianWriter() : programInfo("FakeG"), authorInfo("FakeG Project"), versionInfo("1.0") {}
+GaussianWriter::GaussianWriter()
+    : programInfo("FakeG"), authorInfo("FakeG Project"), versionInfo("1.0"), compression(Compression::None),
+      compressionLevel(0), streamFailed(false), streamBuffer(nullptr) {}
 
 GaussianWriter::GaussianWriter(const std::string& outputFilename) 
-    : outputFilename(outputFilename), programInfo("FakeG"), authorInfo("FakeG Project"), versionInfo("1.0") {}
+    : outputFilename(outputFilename), programInfo("FakeG"), authorInfo("FakeG Project"), versionInfo("1.0"),
+      compression(Compression::None), compressionLevel(0), streamFailed(false), streamBuffer(nullptr) {}
 
 void GaussianWriter::setOutputFilename(const std::string& filename) {
     outputFilename = filename;
@@ -26,50 +29,46 @@ void GaussianWriter::setProgramInfo(const std::string& program, const std::strin
     authorInfo = author;
 }
 
-std::string GaussianWriter::generateOutputFilename(const std::string& inputFilename, const std::string& suffix) {
-    size_t dotPos = inputFilename.find_last_of('.');
-    if (dotPos != std::string::npos) {
-        return inputFilename.substr(0, dotPos) + suffix + ".log";
-    } else {
-        return inputFilename + suffix + ".log";
-    }
-}
-
-std::string GaussianWriter::formatEnergy(double energy, int precision) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(precision) << energy;
-    return oss.str();
-}
-
-std::string GaussianWriter::formatCoordinate(double coord, int precision) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(precision) << std::setw(12) << coord;
-    return oss.str();
+void GaussianWriter::setCompression(Compression type, int level) {
+    compression = type;
+    compressionLevel = level;
 }
 
-std::string GaussianWriter::formatFrequency(double freq, int precision) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(precision) << std::setw(12) << freq;
-    return oss.str();
+Compression GaussianWriter::getCompression() const {
+    return compression;
 }
 
-std::string GaussianWriter::formatIntensity(double intensity, int precision) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(precision) << std::setw(12) << intensity;
-    return oss.str();
+std::string GaussianWriter::generateOutputFilename(const std::string& inputFilename, const std::string& suffix) {
+    // 压缩输入先去掉压缩扩展名（job.aop.gz -> job_fake.log）
+    std::string baseName = inputFilename;
+    for (const char* compressed : {".gz", ".zst", ".xz"}) {
+        const size_t length = std::char_traits<char>::length(compressed);
+        if (baseName.size() > length && baseName.compare(baseName.size() - length, length, compressed) == 0) {
+            baseName.resize(baseName.size() - length);
+            break;
+        }
+    }
+    
+    size_t dotPos = baseName.find_last_of('.');
+    if (dotPos != std::string::npos) {
+        return baseName.substr(0, dotPos) + suffix + ".log";
+    } else {
+        return baseName + suffix + ".log";
+    }
 }
 
-
 bool GaussianWriter::writeGaussianOutput(const data::ParsedData& data) {
     return writeGaussianOutput(data, outputFilename);
 }
 
 bool GaussianWriter::writeGaussianOutput(const data::ParsedData& data, const std::string& filename) {
-    std::ofstream out(filename);
-    if (!out.is_open()) {
+    OutputFile file;
+    file.open(filename, compression, compressionLevel);
+    if (!file.is_open()) {
         return false;
     }
     
+    FormatBuffer out(&file);
     writeHeader(out, data);
     
     for (size_t i = 0; i < data.optSteps.size(); i++) {
@@ -80,63 +79,168 @@ bool GaussianWriter::writeGaussianOutput(const data::ParsedData& data, const std
         writeOptimizationStep(out, data.optSteps[i], tddftData);
     }
     
+    writeTrailer(out, data);
+    const bool written = out.flush();
+    file.close();
+    return written && !file.fail();
+}
+
+void GaussianWriter::beginStream(const std::string& filename) {
+    if (streamOut.is_open()) {
+        streamBuffer.discard();
+        streamOut.close();
+    }
+    streamFilename = filename;
+    streamFailed = false;
+}
+
+bool GaussianWriter::openStream(const data::ParsedData& data) {
+    if (streamFailed) {
+        return false;
+    }
+    if (streamOut.is_open()) {
+        return true;
+    }
+    
+    streamOut.open(streamFilename, compression, compressionLevel);
+    if (!streamOut.is_open()) {
+        streamFailed = true;
+        return false;
+    }
+    
+    streamBuffer.attach(&streamOut);
+    writeHeader(streamBuffer, data);
+    return true;
+}
+
+bool GaussianWriter::consumeStep(const data::ParsedData& data, const data::FrameView& step, const data::TDDFTData* tddft) {
+    if (!openStream(data)) {
+        return false;
+    }
+    
+    writeOptimizationStep(streamBuffer, step, tddft && tddft->hasData ? tddft : nullptr);
+    return streamOut.good();
+}
+
+bool GaussianWriter::finishStream(const data::ParsedData& data) {
+    // 没有任何步骤时头部在这里写出
+    if (!openStream(data)) {
+        return false;
+    }
+    
+    writeTrailer(streamBuffer, data);
+    const bool written = streamBuffer.flush();
+    streamBuffer.attach(nullptr);
+    streamOut.close();
+    return written && !streamOut.fail();
+}
+
+bool GaussianWriter::flushStream() {
+    if (!streamOut.is_open()) {
+        return !streamFailed;
+    }
+    const bool written = streamBuffer.flush();
+    streamOut.flush();
+    return written && streamOut.good();
+}
+
+bool GaussianWriter::resumeStream(const std::string& filename, uintmax_t offset) {
+    beginStream(filename);
+    
+    // 压缩流不能从中间截断后续写
+    if (compression != Compression::None) {
+        return false;
+    }
+    
+    std::error_code ec;
+    std::filesystem::resize_file(filename, offset, ec);
+    if (ec) {
+        return false;
+    }
+    
+    streamOut.open(filename, Compression::None, 0, true);
+    if (!streamOut.is_open()) {
+        streamFailed = true;
+        return false;
+    }
+    streamBuffer.attach(&streamOut);
+    return true;
+}
+
+uintmax_t GaussianWriter::streamPosition() {
+    if (!streamOut.is_open() || !flushStream()) {
+        return 0;
+    }
+    return static_cast<uintmax_t>(streamOut.tellp());
+}
+
+void GaussianWriter::abortStream() {
+    if (streamOut.is_open()) {
+        streamBuffer.discard();
+        streamBuffer.attach(nullptr);
+        streamOut.close();
+        if (!isStdioPath(streamFilename)) {
+            std::error_code ec;
+            std::filesystem::remove(streamFilename, ec);
+        }
+    }
+    streamFailed = false;
+}
+
+void GaussianWriter::writeTrailer(FormatBuffer& out, const data::ParsedData& data) {
     if (data.hasOpt) {
-        out << std::endl << " Normal termination of Gaussian" << std::endl;
+        out.newline().line(" Normal termination of Gaussian");
     }
     
     if (data.hasFreq && !data.frequencies.empty()) {
         writeFrequencies(out, data);
-        out << std::endl << " Normal termination of Gaussian" << std::endl;
+        out.newline().line(" Normal termination of Gaussian");
     }
     
     writeFooter(out);
-    out.close();
-    return true;
 }
 
-void GaussianWriter::writeHeader(std::ofstream& out, const data::ParsedData& data) {
-    out << "! This file was generated by " << programInfo << " version " << versionInfo << std::endl;
-    out << "! Author: " << authorInfo << std::endl;
-    out << "! Converted quantum chemistry output to Gaussian format" << std::endl;
-    out << "! Entering Gaussian System? Nops, this line just for Multiwfn analysis." << std::endl;
-    out << std::endl;
+void GaussianWriter::writeHeader(FormatBuffer& out, const data::ParsedData& data) {
+    out.text("! This file was generated by ").text(programInfo).text(" version ").text(versionInfo).newline();
+    out.text("! Author: ").text(authorInfo).newline();
+    out.line("! Converted quantum chemistry output to Gaussian format");
+    out.line("! Entering Gaussian System? Nops, this line just for Multiwfn analysis.");
+    out.newline();
     
     // 如果有charge和spin信息，输出它们
     if (data.hasChargeSpinInfo) {
-        out << " Charge = " << std::setw(4) << data.charge 
-            << " Multiplicity = " << data.spin << std::endl;
+        out.text(" Charge = ").integer(data.charge, 4)
+           .text(" Multiplicity = ").integer(data.spin).newline();
     }
     
-    out << "0 basis functions" << std::endl;
-    out << "0 alpha electrons" << std::endl;
-    out << "0 beta electrons" << std::endl;
-    out << "GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad" << std::endl;
-    out << "GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad" << std::endl;
+    out.line("0 basis functions");
+    out.line("0 alpha electrons");
+    out.line("0 beta electrons");
+    out.line("GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad");
+    out.line("GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad");
 }
 
-void GaussianWriter::writeOptimizationStep(std::ofstream& out, const data::OptStep& step, const data::TDDFTData* tddftData) {
-    out << std::endl;
-    out << "                        Standard orientation:" << std::endl;
-    out << "---------------------------------------------------------------------" << std::endl;
-    out << " Center     Atomic      Atomic             Coordinates (Angstroms)" << std::endl;
-    out << " Number     Number       Type             X           Y           Z" << std::endl;
-    out << "---------------------------------------------------------------------" << std::endl;
-    
-    for (size_t i = 0; i < step.atoms.size(); i++) {
-        const auto& atom = step.atoms[i];
-        out << std::setw(7) << (i + 1)
-            << std::setw(11) << atom.atomicNumber
-            << std::setw(12) << 0
-            << "    "
-            << std::fixed << std::setprecision(6)
-            << std::setw(12) << atom.x
-            << std::setw(12) << atom.y
-            << std::setw(12) << atom.z << std::endl;
-    }
-    out << "---------------------------------------------------------------------" << std::endl;
-    
-    out << std::endl;
-    out << " SCF Done:  E(theory) = " << formatEnergy(step.energy) << std::endl;
+void GaussianWriter::writeOptimizationStep(FormatBuffer& out, const data::FrameView& step, const data::TDDFTData* tddftData) {
+    out.newline();
+    out.line("                        Standard orientation:");
+    out.line("---------------------------------------------------------------------");
+    out.line(" Center     Atomic      Atomic             Coordinates (Angstroms)");
+    out.line(" Number     Number       Type             X           Y           Z");
+    out.line("---------------------------------------------------------------------");
+    
+    for (size_t i = 0; i < step.atomCount(); i++) {
+        out.integer(static_cast<long long>(i + 1), 7)
+           .integer(step.atomicNumber(i), 11)
+           .integer(0, 12)
+           .text("    ")
+           .fixed(step.x(i), 6, 12)
+           .fixed(step.y(i), 6, 12)
+           .fixed(step.z(i), 6, 12).newline();
+    }
+    out.line("---------------------------------------------------------------------");
+    
+    out.newline();
+    out.text(" SCF Done:  E(theory) = ").fixed(step.energy, 9).newline();
     
     // TDDFT数据紧跟在SCF Done后面
     if (tddftData && tddftData->hasData) {
@@ -144,39 +248,39 @@ void GaussianWriter::writeOptimizationStep(std::ofstream& out, const data::OptSt
     }
     
     if (step.stepNumber > 0) {
-        out << std::endl;
-        out << " GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad" << std::endl;
-        out << " Step number" << std::setw(4) << step.stepNumber << std::endl;
-        out << "         Item               Value     Threshold  Converged?" << std::endl;
+        out.newline();
+        out.line(" GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad");
+        out.text(" Step number").integer(step.stepNumber, 4).newline();
+        out.line("         Item               Value     Threshold  Converged?");
         
         double tolRMSG = 3.0e-4, tolMAXG = 4.5e-4, tolRMSD = 1.2e-3, tolMAXD = 1.8e-3;
         
-        out << " Maximum Force       " << std::fixed << std::setprecision(6)
-            << std::setw(13) << step.maxGrad 
-            << std::setw(13) << tolMAXG << "     "
-            << (step.maxGrad < tolMAXG ? "YES" : "NO") << std::endl;
-        out << " RMS     Force       " 
-            << std::setw(13) << step.rmsGrad 
-            << std::setw(13) << tolRMSG << "     "
-            << (step.rmsGrad < tolRMSG ? "YES" : "NO") << std::endl;
-        out << " Maximum Displacement" 
-            << std::setw(13) << step.maxStep 
-            << std::setw(13) << tolMAXD << "     "
-            << (step.maxStep < tolMAXD ? "YES" : "NO") << std::endl;
-        out << " RMS     Displacement" 
-            << std::setw(13) << step.rmsStep 
-            << std::setw(13) << tolRMSD << "     "
-            << (step.rmsStep < tolRMSD ? "YES" : "NO") << std::endl;
-        out << " GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad" << std::endl;
+        out.text(" Maximum Force       ")
+           .fixed(step.maxGrad, 6, 13)
+           .fixed(tolMAXG, 6, 13).text("     ")
+           .text(step.maxGrad < tolMAXG ? "YES" : "NO").newline();
+        out.text(" RMS     Force       ")
+           .fixed(step.rmsGrad, 6, 13)
+           .fixed(tolRMSG, 6, 13).text("     ")
+           .text(step.rmsGrad < tolRMSG ? "YES" : "NO").newline();
+        out.text(" Maximum Displacement")
+           .fixed(step.maxStep, 6, 13)
+           .fixed(tolMAXD, 6, 13).text("     ")
+           .text(step.maxStep < tolMAXD ? "YES" : "NO").newline();
+        out.text(" RMS     Displacement")
+           .fixed(step.rmsStep, 6, 13)
+           .fixed(tolRMSD, 6, 13).text("     ")
+           .text(step.rmsStep < tolRMSD ? "YES" : "NO").newline();
+        out.line(" GradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGradGrad");
     }
 }
 
-void GaussianWriter::writeFrequencies(std::ofstream& out, const data::ParsedData& data) {
-    out << std::endl;
-    out << " Harmonic frequencies (cm**-1), IR intensities (KM/Mole), Raman scattering" << std::endl;
-    out << " activities (A**4/AMU), depolarization ratios for plane and unpolarized" << std::endl;
-    out << " incident light, reduced masses (AMU), force constants (mDyne/A)," << std::endl;
-    out << " and normal coordinates:" << std::endl;
+void GaussianWriter::writeFrequencies(FormatBuffer& out, const data::ParsedData& data) {
+    out.newline();
+    out.line(" Harmonic frequencies (cm**-1), IR intensities (KM/Mole), Raman scattering");
+    out.line(" activities (A**4/AMU), depolarization ratios for plane and unpolarized");
+    out.line(" incident light, reduced masses (AMU), force constants (mDyne/A),");
+    out.line(" and normal coordinates:");
     
     int nFreqs = data.frequencies.size();
     int nFrames = (nFreqs + 2) / 3;
@@ -192,134 +296,124 @@ void GaussianWriter::writeFrequencies(std::ofstream& out, const data::ParsedData
     }
 }
 
-void GaussianWriter::writeFrequencyBlock(std::ofstream& out, const data::ParsedData& data, int startIdx, int endIdx) {
-    int nAtoms = data.optSteps.empty() ? 0 : data.optSteps.back().atoms.size();
+void GaussianWriter::writeFrequencyBlock(FormatBuffer& out, const data::ParsedData& data, int startIdx, int endIdx) {
+    int nAtoms = data.optSteps.empty() ? 0 : static_cast<int>(data.optSteps.back().atomCount());
     
     for (int i = startIdx; i < endIdx; i++) {
-        out << std::setw(23) << (i + 1);
+        out.integer(i + 1, 23);
     }
-    out << std::endl;
+    out.newline();
     
     for (int i = startIdx; i < endIdx; i++) {
-        out << std::setw(22) << "" << data.frequencies[i].irrep;
+        out.spaces(22).text(data.frequencies[i].irrep);
     }
-    out << std::endl;
+    out.newline();
     
     for (int icol = 0; icol < (endIdx - startIdx); icol++) {
         int i = startIdx + icol;
         if (icol == 0) {
-            out << " Frequencies --" << formatFrequency(data.frequencies[i].frequency);
+            out.text(" Frequencies --").fixed(data.frequencies[i].frequency, 4, 12);
         } else {
-            out << std::setw(11) << "" << formatFrequency(data.frequencies[i].frequency);
+            out.spaces(11).fixed(data.frequencies[i].frequency, 4, 12);
         }
     }
-    out << std::endl;
+    out.newline();
     
     for (int icol = 0; icol < (endIdx - startIdx); icol++) {
         int i = startIdx + icol;
         if (icol == 0) {
-            out << " IR Inten    --" << formatIntensity(data.frequencies[i].irIntensity);
+            out.text(" IR Inten    --").fixed(data.frequencies[i].irIntensity, 4, 12);
         } else {
-            out << std::setw(11) << "" << formatIntensity(data.frequencies[i].irIntensity);
+            out.spaces(11).fixed(data.frequencies[i].irIntensity, 4, 12);
         }
     }
-    out << std::endl;
+    out.newline();
     
     for (int icol = 0; icol < (endIdx - startIdx); icol++) {
         if (icol == 0) {
-            out << "  Atom  AN      X      Y      Z  ";
+            out.text("  Atom  AN      X      Y      Z  ");
         } else {
-            out << "      X      Y      Z  ";
+            out.text("      X      Y      Z  ");
         }
     }
-    out << std::endl;
+    out.newline();
     
+    const data::FrameView geometry = nAtoms > 0 ? data.optSteps.back() : data::FrameView{};
     for (int iatom = 0; iatom < nAtoms; iatom++) {
-        if (!data.optSteps.empty()) {
-            int atomicNumber = data.optSteps.back().atoms[iatom].atomicNumber;
+        int atomicNumber = geometry.atomicNumber(iatom);
+        
+        for (int icol = 0; icol < (endIdx - startIdx); icol++) {
+            int i = startIdx + icol;
+            if (icol == 0) {
+                out.integer(iatom + 1, 6).integer(atomicNumber, 4).text("  ");
+            } else {
+                out.text("  ");
+            }
             
-            for (int icol = 0; icol < (endIdx - startIdx); icol++) {
-                int i = startIdx + icol;
-                if (icol == 0) {
-                    out << std::setw(6) << (iatom + 1) << std::setw(4) << atomicNumber << "  ";
-                    if (static_cast<size_t>(i) < data.frequencies.size() && 
-                        static_cast<size_t>(iatom) < data.frequencies[i].displacements.size() &&
-                        data.frequencies[i].displacements[iatom].size() >= 3) {
-                        out << std::fixed << std::setprecision(2)
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][0]
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][1]
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][2];
-                    } else {
-                        out << "   0.00   0.00   0.00";
-                    }
-                } else {
-                    out << "  ";
-                    if (static_cast<size_t>(i) < data.frequencies.size() && 
-                        static_cast<size_t>(iatom) < data.frequencies[i].displacements.size() &&
-                        data.frequencies[i].displacements[iatom].size() >= 3) {
-                        out << std::fixed << std::setprecision(2)
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][0]
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][1]
-                            << std::setw(7) << data.frequencies[i].displacements[iatom][2];
-                    } else {
-                        out << "   0.00   0.00   0.00";
-                    }
-                }
+            if (static_cast<size_t>(i) < data.displacements.modeCount() &&
+                static_cast<size_t>(iatom) < data.displacements.atomCount()) {
+                const auto displacement = data.displacements.atom(i, iatom);
+                out.fixed(displacement[0], 2, 7)
+                   .fixed(displacement[1], 2, 7)
+                   .fixed(displacement[2], 2, 7);
+            } else {
+                out.text("   0.00   0.00   0.00");
             }
-            out << std::endl;
         }
+        out.newline();
     }
 }
 
-void GaussianWriter::writeThermoData(std::ofstream& out, const data::ThermoData& thermoData) {
-    out << std::endl;
-    out << " Temperature" << std::fixed << std::setprecision(3) << std::setw(10) << thermoData.temperature 
-        << " Kelvin.  Pressure" << std::setprecision(5) << std::setw(10) << thermoData.pressure << " Atm." << std::endl;
-    out << " Zero-point correction=                           " << std::setprecision(6) << std::setw(8) << thermoData.zpe << " Hartree" << std::endl;
-    out << " Thermal correction to Energy=                    " << std::setprecision(6) << std::setw(8) << thermoData.thermalEnergyCorr << std::endl;
-    out << " Thermal correction to Enthalpy=                  " << std::setprecision(6) << std::setw(8) << thermoData.thermalEnthalpyCorr << std::endl;
-    out << " Thermal correction to Gibbs Free Energy=        " << std::setprecision(6) << std::setw(8) << thermoData.thermalGibbsCorr << std::endl;
-    out << " Electronic energy=                          " << std::setprecision(6) << std::setw(20) << thermoData.electronicEnergy << std::endl;
-    out << " Sum of electronic and zero-point Energies=  " << std::setprecision(6) << std::setw(20) << (thermoData.electronicEnergy + thermoData.zpe) << std::endl;
-    out << " Sum of electronic and thermal Energies=     " << std::setprecision(6) << std::setw(20) << (thermoData.electronicEnergy + thermoData.thermalEnergyCorr) << std::endl;
-    out << " Sum of electronic and thermal Enthalpies=   " << std::setprecision(6) << std::setw(20) << (thermoData.electronicEnergy + thermoData.thermalEnthalpyCorr) << std::endl;
-    out << " Sum of electronic and thermal Free Energies=" << std::setprecision(6) << std::setw(20) << (thermoData.electronicEnergy + thermoData.thermalGibbsCorr) << std::endl;
+void GaussianWriter::writeThermoData(FormatBuffer& out, const data::ThermoData& thermoData) {
+    out.newline();
+    out.text(" Temperature").fixed(thermoData.temperature, 3, 10)
+       .text(" Kelvin.  Pressure").fixed(thermoData.pressure, 5, 10).text(" Atm.").newline();
+    out.text(" Zero-point correction=                           ").fixed(thermoData.zpe, 6, 8).text(" Hartree").newline();
+    out.text(" Thermal correction to Energy=                    ").fixed(thermoData.thermalEnergyCorr, 6, 8).newline();
+    out.text(" Thermal correction to Enthalpy=                  ").fixed(thermoData.thermalEnthalpyCorr, 6, 8).newline();
+    out.text(" Thermal correction to Gibbs Free Energy=        ").fixed(thermoData.thermalGibbsCorr, 6, 8).newline();
+    out.text(" Electronic energy=                          ").fixed(thermoData.electronicEnergy, 6, 20).newline();
+    out.text(" Sum of electronic and zero-point Energies=  ").fixed(thermoData.electronicEnergy + thermoData.zpe, 6, 20).newline();
+    out.text(" Sum of electronic and thermal Energies=     ").fixed(thermoData.electronicEnergy + thermoData.thermalEnergyCorr, 6, 20).newline();
+    out.text(" Sum of electronic and thermal Enthalpies=   ").fixed(thermoData.electronicEnergy + thermoData.thermalEnthalpyCorr, 6, 20).newline();
+    out.text(" Sum of electronic and thermal Free Energies=").fixed(thermoData.electronicEnergy + thermoData.thermalGibbsCorr, 6, 20).newline();
 }
 
-void GaussianWriter::writeConvergenceData(std::ofstream& out, const data::ThermoData& thermoData) {
-    out << std::endl;
-    out << " Convergence of gradients" << std::endl;
-    out << "                                  Value     Tolerance      Converged?" << std::endl;
-    
-    out << "  Maximum Delta-X          " << std::fixed << std::setprecision(6) << std::setw(12) << thermoData.maxDeltaX
-        << std::setw(13) << "0.004000" << "            " 
-        << (thermoData.maxDeltaX < 0.004000 ? "Yes" : "No") << std::endl;
-    
-    out << "      RMS Delta-X          " << std::setw(12) << thermoData.rmsDeltaX
-        << std::setw(13) << "0.002500" << "            "
-        << (thermoData.rmsDeltaX < 0.002500 ? "Yes" : "No") << std::endl;
-    
-    out << "    Maximum Force          " << std::setw(12) << thermoData.maxForce
-        << std::setw(13) << "0.000800" << "            "
-        << (thermoData.maxForce < 0.000800 ? "Yes" : "No") << std::endl;
-    
-    out << "        RMS Force          " << std::setw(12) << thermoData.rmsForce
-        << std::setw(13) << "0.000500" << "            "
-        << (thermoData.rmsForce < 0.000500 ? "Yes" : "No") << std::endl;
-    
-    out << " Expected Delta-E          " << std::scientific << std::setprecision(2) << std::setw(12) << thermoData.expectedDeltaE
-        << std::setw(13) << "0.50E-05" << "            "
-        << (thermoData.expectedDeltaE < 0.50e-05 ? "Yes" : "No") << std::endl;
+void GaussianWriter::writeConvergenceData(FormatBuffer& out, const data::ThermoData& thermoData) {
+    out.newline();
+    out.line(" Convergence of gradients");
+    out.line("                                  Value     Tolerance      Converged?");
+    
+    out.text("  Maximum Delta-X          ").fixed(thermoData.maxDeltaX, 6, 12)
+       .text("0.004000", 13).text("            ")
+       .text(thermoData.maxDeltaX < 0.004000 ? "Yes" : "No").newline();
+    
+    out.text("      RMS Delta-X          ").fixed(thermoData.rmsDeltaX, 6, 12)
+       .text("0.002500", 13).text("            ")
+       .text(thermoData.rmsDeltaX < 0.002500 ? "Yes" : "No").newline();
+    
+    out.text("    Maximum Force          ").fixed(thermoData.maxForce, 6, 12)
+       .text("0.000800", 13).text("            ")
+       .text(thermoData.maxForce < 0.000800 ? "Yes" : "No").newline();
+    
+    out.text("        RMS Force          ").fixed(thermoData.rmsForce, 6, 12)
+       .text("0.000500", 13).text("            ")
+       .text(thermoData.rmsForce < 0.000500 ? "Yes" : "No").newline();
+    
+    out.text(" Expected Delta-E          ").scientific(thermoData.expectedDeltaE, 2, 12)
+       .text("0.50E-05", 13).text("            ")
+       .text(thermoData.expectedDeltaE < 0.50e-05 ? "Yes" : "No").newline();
 }
 
-void GaussianWriter::writeFooter(std::ofstream& out) {
+void GaussianWriter::writeFooter(FormatBuffer& out) {
     (void)out; // 抑制未使用参数警告
     // 当前不需要特殊的文件尾
 }
 
 bool GaussianWriter::validateOutput(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // FileReader 同样能读取压缩的输出
+    FileReader reader(filename);
+    if (!reader.isOpen()) {
         return false;
     }
     
@@ -327,7 +421,7 @@ bool GaussianWriter::validateOutput(const std::string& filename) {
     bool hasHeader = false;
     bool hasGeometry = false;
     
-    while (std::getline(file, line)) {
+    while (std::getline(reader.getStream(), line)) {
         if (line.find("This file was generated by") != std::string::npos) {
             hasHeader = true;
         }
@@ -339,70 +433,69 @@ bool GaussianWriter::validateOutput(const std::string& filename) {
     return hasHeader && hasGeometry;
 }
 
-void GaussianWriter::writeTDDFTData(std::ofstream& out, const data::TDDFTData& tddftData) {
+void GaussianWriter::writeTDDFTData(FormatBuffer& out, const data::TDDFTData& tddftData) {
     if (!tddftData.hasData || tddftData.excitedStates.empty()) {
         return;
     }
     
-    out << std::endl;
-    out << " Excitation energies and oscillator strengths:" << std::endl;
-    out << std::endl;
+    out.newline();
+    out.line(" Excitation energies and oscillator strengths:");
+    out.newline();
     
     for (const auto& excitedState : tddftData.excitedStates) {
         writeExcitedState(out, excitedState);
     }
     
     // 添加激发态块结束语句
-    out << " SavETr:  write IOETrn=     0 NScale=  0 NData=   0 NLR=  NState=    0 LETran=       0." << std::endl;
+    out.line(" SavETr:  write IOETrn=     0 NScale=  0 NData=   0 NLR=  NState=    0 LETran=       0.");
 }
 
-void GaussianWriter::writeExcitedState(std::ofstream& out, const data::ExcitedState& excitedState) {
+void GaussianWriter::writeExcitedState(FormatBuffer& out, const data::ExcitedState& excitedState) {
     // 输出激发态标题行
-    out << " Excited State" << std::setw(4) << excitedState.stateNumber << ":      "
-        << std::setw(10) << std::left << excitedState.symmetry << std::right
-        << std::fixed << std::setprecision(4) << std::setw(8) << excitedState.excitationEnergy_eV
-        << " eV" << std::setw(8) << std::setprecision(2) << excitedState.wavelength_nm
-        << " nm  f=" << std::setprecision(4) << std::setw(6) << excitedState.oscillatorStrength
-        << "  <S**2>=" << std::setprecision(3) << excitedState.s2Value << std::endl;
+    out.text(" Excited State").integer(excitedState.stateNumber, 4).text(":      ")
+       .left(excitedState.symmetry, 10)
+       .fixed(excitedState.excitationEnergy_eV, 4, 8)
+       .text(" eV").fixed(excitedState.wavelength_nm, 2, 8)
+       .text(" nm  f=").fixed(excitedState.oscillatorStrength, 4, 6)
+       .text("  <S**2>=").fixed(excitedState.s2Value, 3).newline();
     
     // 输出轨道跃迁信息
     writeOrbitalTransitions(out, excitedState.transitions);
     
     // 如果有优化相关信息
     if (excitedState.hasOptimizationInfo) {
-        out << " This state for optimization and/or second-order correction." << std::endl;
+        out.line(" This state for optimization and/or second-order correction.");
     }
     
     // 如果有总能量信息
     if (excitedState.hasTotalEnergy) {
-        out << " Total Energy, E(TD-HF/TD-DFT) = " << std::fixed << std::setprecision(10)
-            << std::setw(15) << excitedState.totalEnergy << "    " << std::endl;
+        out.text(" Total Energy, E(TD-HF/TD-DFT) = ").fixed(excitedState.totalEnergy, 10, 15)
+           .text("    ").newline();
     }
     
     // 输出额外信息
     if (!excitedState.additionalInfo.empty()) {
-        out << " " << excitedState.additionalInfo << std::endl;
+        out.text(" ").text(excitedState.additionalInfo).newline();
     }
     
-    out << std::endl;
+    out.newline();
 }
 
-void GaussianWriter::writeOrbitalTransitions(std::ofstream& out, const std::vector<data::OrbitalTransition>& transitions) {
+void GaussianWriter::writeOrbitalTransitions(FormatBuffer& out, std::span<const data::OrbitalTransition> transitions) {
     for (const auto& transition : transitions) {
-        out << "      " << std::setw(2) << transition.fromOrb;
+        out.text("      ").integer(transition.fromOrb, 2);
         
         // 根据原始箭头方向输出：--> 转为 ->，<-- 转为 <-
         if (transition.isForward) {
-            out << " -> " << std::setw(2) << transition.toOrb;
+            out.text(" -> ").integer(transition.toOrb, 2);
         } else {
-            out << " <- " << std::setw(2) << transition.toOrb;
+            out.text(" <- ").integer(transition.toOrb, 2);
         }
         
-        out << "         " << std::fixed << std::setprecision(5) 
-            << transition.coefficient << std::endl;
+        out.text("         ").fixed(transition.coefficient, 5).newline();
     }
 }
 
 
 } // namespace io
-} // namespace fakeg 
\ No newline at end of file
+} // namespace fakeg
\ No newline at end of file
@@ -1,39 +1,59 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include "../data/structures.h"
+#include "compressor.h"
+#include "format_buffer.h"
 
 namespace fakeg {
 namespace io {
 
 // Gaussian输出写入器类
-class GaussianWriter {
+//
+// 两种用法：
+// - writeGaussianOutput 一次写出完整的 ParsedData
+// - 流式写出：beginStream 后作为 StepSink 交给解析器，每个优化步骤到达时立即写出，
+//   解析结束后 finishStream 写出频率、热力学等尾部内容。两种方式的输出逐字节相同
+class GaussianWriter : public data::StepSink {
+public:
+    // 转换结果的修订号：解析器或写出器的改动使同一输入的输出发生变化时加一。
+    // 记在增量模式的记录和断点续转的检查点中，修订号不同时旧输出不再沿用
+    static constexpr int kOutputRevision = 1;
+
 private:
     std::string outputFilename;
     std::string programInfo;
     std::string authorInfo;
     std::string versionInfo;
     
+    // 输出压缩（默认不压缩）
+    Compression compression;
+    int compressionLevel;
+    
+    // 流式写出状态（文件在第一个步骤到达时才创建，解析失败时不会留下空文件）
+    std::string streamFilename;
+    OutputFile streamOut;
+    bool streamFailed;
+    FormatBuffer streamBuffer;
+    
+    bool openStream(const data::ParsedData& data);
+    
     // 内部写入方法
-    void writeHeader(std::ofstream& out, const data::ParsedData& data);
-    void writeOptimizationStep(std::ofstream& out, const data::OptStep& step, const data::TDDFTData* tddftData = nullptr);
-    void writeFrequencies(std::ofstream& out, const data::ParsedData& data);
-    void writeFrequencyBlock(std::ofstream& out, const data::ParsedData& data, int startIdx, int endIdx);
-    void writeThermoData(std::ofstream& out, const data::ThermoData& thermoData);
-    void writeConvergenceData(std::ofstream& out, const data::ThermoData& thermoData);
-    void writeFooter(std::ofstream& out);
+    void writeHeader(FormatBuffer& out, const data::ParsedData& data);
+    void writeTrailer(FormatBuffer& out, const data::ParsedData& data);
+    void writeOptimizationStep(FormatBuffer& out, const data::FrameView& step, const data::TDDFTData* tddftData = nullptr);
+    void writeFrequencies(FormatBuffer& out, const data::ParsedData& data);
+    void writeFrequencyBlock(FormatBuffer& out, const data::ParsedData& data, int startIdx, int endIdx);
+    void writeThermoData(FormatBuffer& out, const data::ThermoData& thermoData);
+    void writeConvergenceData(FormatBuffer& out, const data::ThermoData& thermoData);
+    void writeFooter(FormatBuffer& out);
     
     // TDDFT写入方法
-    void writeTDDFTData(std::ofstream& out, const data::TDDFTData& tddftData);
-    void writeExcitedState(std::ofstream& out, const data::ExcitedState& excitedState);
-    void writeOrbitalTransitions(std::ofstream& out, const std::vector<data::OrbitalTransition>& transitions);
-    
-    // 格式化辅助方法
-    std::string formatEnergy(double energy, int precision = 9);
-    std::string formatCoordinate(double coord, int precision = 6);
-    std::string formatFrequency(double freq, int precision = 4);
-    std::string formatIntensity(double intensity, int precision = 4);
+    void writeTDDFTData(FormatBuffer& out, const data::TDDFTData& tddftData);
+    void writeExcitedState(FormatBuffer& out, const data::ExcitedState& excitedState);
+    void writeOrbitalTransitions(FormatBuffer& out, std::span<const data::OrbitalTransition> transitions);
     
 public:
     GaussianWriter();
@@ -46,10 +66,23 @@ public:
     // 设置程序信息
     void setProgramInfo(const std::string& program, const std::string& version, const std::string& author);
     
+    // 压缩输出（gzip/zstd，压缩在后台线程进行；level 为 0 时用默认级别）
+    void setCompression(Compression type, int level = 0);
+    Compression getCompression() const;
+    
     // 主要写入方法
     bool writeGaussianOutput(const data::ParsedData& data);
     bool writeGaussianOutput(const data::ParsedData& data, const std::string& filename);
     
+    // 流式写出
+    void beginStream(const std::string& filename);
+    bool consumeStep(const data::ParsedData& data, const data::FrameView& step, const data::TDDFTData* tddft) override;
+    bool finishStream(const data::ParsedData& data);
+    bool flushStream();  // 把已写出的步骤刷到文件（跟踪模式下让查看程序看到最新内容）
+    bool resumeStream(const std::string& filename, uintmax_t offset);  // 把已有输出截到offset后继续追加（仅不压缩的输出）
+    uintmax_t streamPosition();  // 刷新后输出文件的长度
+    void abortStream();  // 关闭并删除已写出的部分文件
+    
     // 生成输出文件名（根据输入文件名）
     static std::string generateOutputFilename(const std::string& inputFilename, 
                                              const std::string& suffix = "_fake");
@@ -0,0 +1,80 @@
+#include "line_iterator.h"
+
+#include "string/byte_search.h"
+
+namespace fakeg {
+namespace io {
+
+LineIterator::LineIterator() : position_(0), lineOffset_(0) {}
+
+LineIterator::LineIterator(std::string_view buffer, size_t startOffset)
+    : buffer_(buffer), position_(startOffset < buffer.size() ? startOffset : buffer.size()), lineOffset_(position_) {}
+
+bool LineIterator::next(std::string_view& line) {
+    if (position_ >= buffer_.size()) {
+        return false;
+    }
+
+    const size_t newline = string_utils::byte_search::findByte(buffer_, '\n', position_);
+
+    lineOffset_ = position_;
+    if (newline != std::string_view::npos) {
+        line = buffer_.substr(position_, newline - position_);
+        position_ = newline + 1;
+    } else {
+        line = buffer_.substr(position_);
+        position_ = buffer_.size();
+    }
+
+    return true;
+}
+
+bool LineIterator::findLine(std::string_view marker, std::string_view& line) {
+    namespace bs = string_utils::byte_search;
+
+    // 跨行的标记无法逐行命中，退回逐行比较
+    if (marker.empty() || bs::findByte(marker, '\n') != bs::npos) {
+        while (next(line)) {
+            if (line.find(marker) != std::string_view::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const size_t hit = bs::findSubstring(buffer_, marker, position_);
+    if (hit == bs::npos) {
+        position_ = buffer_.size();
+        lineOffset_ = position_;
+        return false;
+    }
+
+    // 命中所在行的行首（不早于当前位置）
+    const size_t previous = bs::findLastByte(buffer_, '\n', hit);
+    position_ = (previous == bs::npos || previous < position_) ? position_ : previous + 1;
+    return next(line);
+}
+
+size_t LineIterator::offset() const {
+    return lineOffset_;
+}
+
+size_t LineIterator::position() const {
+    return position_;
+}
+
+void LineIterator::seek(size_t offset) {
+    position_ = offset < buffer_.size() ? offset : buffer_.size();
+    lineOffset_ = position_;
+}
+
+bool LineIterator::atEnd() const {
+    return position_ >= buffer_.size();
+}
+
+std::string_view LineIterator::buffer() const {
+    return buffer_;
+}
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace fakeg {
+namespace io {
+
+// 在内存缓冲区上逐行迭代（行以string_view返回，不分配内存）
+//
+// Notes:
+// - 返回的行不含 '\n'，与 std::getline 的结果一致（'\r' 保留）
+// - offset() 为最近一次返回行的起始字节偏移，可用于之后直接 seek 回该行
+// - 换行符和标记的查找使用 byte_search 中的SIMD内核
+class LineIterator {
+private:
+    std::string_view buffer_;
+    size_t position_;
+    size_t lineOffset_;
+
+public:
+    LineIterator();
+    explicit LineIterator(std::string_view buffer, size_t startOffset = 0);
+
+    // 读取下一行，到达末尾时返回false
+    bool next(std::string_view& line);
+
+    // 跳到下一个包含 marker 的行并返回该行（与 LineProcessor::findLine 语义一致），
+    // 找不到时停在末尾并返回false
+    bool findLine(std::string_view marker, std::string_view& line);
+
+    // 最近一次返回行的起始偏移
+    size_t offset() const;
+
+    // 下一行的起始偏移
+    size_t position() const;
+    void seek(size_t offset);
+    bool atEnd() const;
+
+    std::string_view buffer() const;
+};
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,193 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fakeg {
+namespace io {
+
+MappedFile::MappedFile() {
+    reset();
+}
+
+MappedFile::MappedFile(const std::string& filename) : MappedFile() {
+    open(filename);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        open_ = other.open_;
+#ifdef _WIN32
+        fileHandle_ = other.fileHandle_;
+        mappingHandle_ = other.mappingHandle_;
+#else
+        fd_ = other.fd_;
+#endif
+        other.reset();
+    }
+    return *this;
+}
+
+void MappedFile::reset() {
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+#ifdef _WIN32
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+#else
+    fd_ = -1;
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle_ = file;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    // 空文件无法建立映射，直接视为已打开的空内容
+    if (size_ == 0) {
+        open_ = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mappingHandle_ = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        close();
+        return false;
+    }
+
+    data_ = static_cast<const char*>(view);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    }
+    if (fileHandle_) {
+        CloseHandle(static_cast<HANDLE>(fileHandle_));
+    }
+    reset();
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    size_ = static_cast<size_t>(st.st_size);
+
+    // 空文件无法建立映射，直接视为已打开的空内容
+    if (size_ == 0) {
+        open_ = true;
+        return true;
+    }
+
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    // 解析器基本按顺序读取，提示内核加大预读
+    ::madvise(addr, size_, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(addr);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    reset();
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+    return open_;
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+std::string_view MappedFile::view() const {
+    return data_ ? std::string_view(data_, size_) : std::string_view();
+}
+
+} // namespace io
+} // namespace fakeg
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace fakeg {
+namespace io {
+
+// 只读内存映射文件
+//
+// Notes:
+// - 整个文件只映射一次，内容通过 view() 以 string_view 暴露，不做任何拷贝
+// - 空文件不会真正建立映射，view() 返回空视图
+// - 不可拷贝，可移动
+class MappedFile {
+private:
+    const char* data_;
+    size_t size_;
+    bool open_;
+
+#ifdef _WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#else
+    int fd_;
+#endif
+
+    void reset();
+
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+
+    const char* data() const;
+    size_t size() const;
+    std::string_view view() const;
+};
+
+} // namespace io
+} // namespace fakeg
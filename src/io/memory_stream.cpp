@@ -0,0 +1,76 @@
+#include "memory_stream.h"
+
+namespace fakeg {
+namespace io {
+
+// MemoryStreamBuf类实现
+MemoryStreamBuf::MemoryStreamBuf() {
+    reset(std::string_view());
+}
+
+MemoryStreamBuf::MemoryStreamBuf(std::string_view buffer) {
+    reset(buffer);
+}
+
+void MemoryStreamBuf::reset(std::string_view buffer) {
+    // streambuf 接口要求非const指针，但本类从不写入
+    char* begin = const_cast<char*>(buffer.data());
+    setg(begin, begin, begin + buffer.size());
+}
+
+std::string_view MemoryStreamBuf::unread() const {
+    return std::string_view(gptr(), static_cast<size_t>(egptr() - gptr()));
+}
+
+void MemoryStreamBuf::skip(size_t count) {
+    const size_t remaining = static_cast<size_t>(egptr() - gptr());
+    setg(eback(), gptr() + (count < remaining ? count : remaining), egptr());
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                   std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+        base = gptr() - eback();
+    } else if (dir == std::ios_base::end) {
+        base = egptr() - eback();
+    }
+
+    const off_type target = base + off;
+    if (target < 0 || target > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + target, egptr());
+    return pos_type(target);
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+std::streamsize MemoryStreamBuf::showmanyc() {
+    const std::streamsize remaining = egptr() - gptr();
+    return remaining > 0 ? remaining : -1;
+}
+
+// MemoryInputStream类实现
+MemoryInputStream::MemoryInputStream() : std::istream(nullptr) {
+    rdbuf(&buffer_);
+}
+
+MemoryInputStream::MemoryInputStream(std::string_view buffer) : std::istream(nullptr), buffer_(buffer) {
+    rdbuf(&buffer_);
+}
+
+void MemoryInputStream::reset(std::string_view buffer) {
+    buffer_.reset(buffer);
+    clear();
+}
+
+} // namespace io
+} // namespace fakeg
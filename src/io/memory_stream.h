@@ -0,0 +1,45 @@
+#pragma once
+
+#include <istream>
+#include <streambuf>
+#include <string_view>
+
+namespace fakeg {
+namespace io {
+
+// 直接读取一段内存的只读streambuf（不拷贝数据）
+//
+// 支持 tellg/seekg，使解析器可以像使用 std::ifstream 一样在映射内容上回退或跳转。
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf();
+    explicit MemoryStreamBuf(std::string_view buffer);
+
+    void reset(std::string_view buffer);
+
+    // 尚未读取的内容，以及直接前移读取位置（供按缓冲区查找的快速路径使用）
+    std::string_view unread() const;
+    void skip(size_t count);
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which = std::ios_base::in) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override;
+    std::streamsize showmanyc() override;
+};
+
+// 基于 MemoryStreamBuf 的输入流
+class MemoryInputStream : public std::istream {
+private:
+    MemoryStreamBuf buffer_;
+
+public:
+    MemoryInputStream();
+    explicit MemoryInputStream(std::string_view buffer);
+
+    // 重新指向新的内存区域并清除流状态
+    void reset(std::string_view buffer);
+};
+
+} // namespace io
+} // namespace fakeg
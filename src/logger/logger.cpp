@@ -8,7 +8,7 @@ namespace logger {
 Logger globalLogger;
 
 Logger::Logger(bool debug, LogLevel level) 
-    : debugMode(debug), minLevel(level), prefix("") {}
+    : debugMode(debug), minLevel(level), prefix(""), output(nullptr) {}
 
 void Logger::setDebugMode(bool enable) {
     debugMode = enable;
@@ -29,6 +29,10 @@ void Logger::setPrefix(const std::string& prefix) {
     this->prefix = prefix;
 }
 
+void Logger::setOutput(std::ostream* stream) {
+    output = stream;
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
     if (level < minLevel) return;
     
@@ -40,15 +44,17 @@ void Logger::log(LogLevel level, const std::string& message) {
         case LogLevel::ERROR:   levelStr = "[ERROR]"; break;
     }
     
+    std::ostream& out = output ? *output : std::cout;
+    
     if (!prefix.empty()) {
-        std::cout << prefix << " ";
+        out << prefix << " ";
     }
     
     if (level != LogLevel::INFO) {
-        std::cout << levelStr << " ";
+        out << levelStr << " ";
     }
     
-    std::cout << message << std::endl;
+    out << message << std::endl;
 }
 
 void Logger::debug(const std::string& message) {
@@ -21,6 +21,7 @@ private:
     bool debugMode;
     LogLevel minLevel;
     std::string prefix;
+    std::ostream* output;  // nullptr 表示 std::cout
     
 public:
     Logger(bool debug = false, LogLevel level = LogLevel::INFO);
@@ -35,6 +36,9 @@ public:
     // 设置前缀
     void setPrefix(const std::string& prefix);
     
+    // 设置输出流（nullptr 恢复为 std::cout），批量模式下每个文件的日志先写入各自的缓冲
+    void setOutput(std::ostream* stream);
+    
     // 基础输出方法
     void log(LogLevel level, const std::string& message);
     void debug(const std::string& message);
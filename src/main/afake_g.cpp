@@ -11,5 +11,5 @@ int main(int argc, char* argv[]) {
         .inputPrompt = "Please enter AMESP output file path: ",
     };
 
-    return fakeg::cli::runAppMain(argc, argv, std::make_unique<fakeg::parsers::AmespParser>(), spec);
+    return fakeg::cli::runAppMain(argc, argv, [] { return std::make_unique<fakeg::parsers::AmespParser>(); }, spec);
 }
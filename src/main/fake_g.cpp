@@ -0,0 +1,15 @@
+#include "cli/app_runner.h"
+
+#include "parsers/auto_detect_parser.h"
+
+int main(int argc, char* argv[]) {
+    fakeg::cli::AppSpec spec{
+        .programName = "FakeG",
+        .version = "1.0.0",
+        .author = "Bane Dysta & Claude 4.0",
+        .descriptionLine = "FakeG: Convert AMESP/BDF/XYZ/xTB output to fake Gaussian format (format detected automatically)",
+        .inputPrompt = "Please enter output file path: ",
+    };
+
+    return fakeg::cli::runAppMain(argc, argv, [] { return std::make_unique<fakeg::parsers::AutoDetectParser>(); }, spec);
+}
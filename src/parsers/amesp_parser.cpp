@@ -1,762 +1,1094 @@
 #include "amesp_parser.h"
 #include "../string/string_utils.h"
+#include "../string/fixed_tokenizer.h"
+#include "../string/multi_pattern_scanner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <sstream>
+#include <utility>
 
 namespace fakeg {
 namespace parsers {
 
-AmespParser::AmespParser() = default;
+namespace {
 
-bool AmespParser::parse(io::FileReader& reader, data::ParsedData& data) {
-    auto& file = reader.getStream();
-    
-    debugLog("Starting AMESP file parsing: " + reader.getFilename());
-    
-    // 检查是否有TD-DFT数据
-    string_utils::LineProcessor::resetToBeginning(file);
-    if (string_utils::LineProcessor::findLineFromBeginning(file, "E[Eexc]")) {
-        data.hasTDDFT = true;
-        infoLog("Found TD-DFT data (E[Eexc])");
+// 状态机识别的行标记（顺序与 markerScanner 中的注册顺序一致）
+enum Marker : uint32_t {
+    MARKER_OPT_STEP,
+    MARKER_GEOMETRY,
+    MARKER_GEOMETRY_END,
+    MARKER_E_DFT,
+    MARKER_E_ATB,
+    MARKER_EEXC,
+    MARKER_CONVERGENCE,
+    MARKER_OPT_CONVERGED,
+    MARKER_CONVERGENCE_TABLE,
+    MARKER_TDDFT,
+    MARKER_TDDFT_TIME,
+    MARKER_TDDFT_END,
+    MARKER_FREQUENCY,
+    MARKER_HARMONIC,
+    MARKER_ZERO_POINT,
+    MARKER_IR_SPECTRUM,
+    MARKER_NORMAL_MODES,
+    MARKER_THERMO_SUMMARY,
+    MARKER_TEMPERATURE,
+    MARKER_PRESSURE,
+    MARKER_ZPE,
+    MARKER_THERMAL_U,
+    MARKER_THERMAL_H,
+    MARKER_THERMAL_G,
+    MARKER_FINAL_ENERGY,
+};
+
+const string_utils::MultiPatternScanner& markerScanner() {
+    static const string_utils::MultiPatternScanner scanner({
+        "Geom Opt Step:",
+        "Current Geometry(angstroms):",
+        "----------------------------------------------------------------",
+        "E[DFT]",
+        "E[aTB]",
+        "E[Eexc]",
+        "Geometry Convergence:",
+        "Geometry Optimization Converged",
+        "Item              Value        Threshold       Converged?",
+        "========= Excitation energies and oscillator strengths =========",
+        "Time of TDDFT",
+        "================================================================",
+        "========================== Frequency ===========================",
+        "Harmonic frequencies(cm-1):",
+        "Zero-point",
+        ">>>>>>>>>>>>>>>> IR spectrum (T^2,KM/Mole) <<<<<<<<<<<<<<<<",
+        "Normal Modes:",
+        ">>>>>>>>>>> Summary of Thermodynamic Quantities <<<<<<<<<<<<<",
+        "Temperature:",
+        "Pressure:",
+        "Zero-point vibrational energy:",
+        "Thermal correction to U(T):",
+        "Thermal correction to H(T):",
+        "Thermal correction to G(T):",
+        "Final Energy:",
+    });
+    return scanner;
+}
+
+// 一行中出现的标记（一次自动机扫描得到，之后各段落的判断只查位）
+class LineMarkers {
+public:
+    explicit LineMarkers(std::string_view line) : bits_(0) {
+        markerScanner().scan(line, [this](size_t id, size_t) {
+            bits_ |= 1u << id;
+            return true;
+        });
     }
-    
-    // 检查优化
-    string_utils::LineProcessor::resetToBeginning(file);
-    if (string_utils::LineProcessor::findLineFromBeginning(file, "Geom Opt Step:")) {
-        data.hasOpt = true;
-        infoLog("Found geometry optimization");
-        if (!parseOptimizationSteps(file, data)) {
-            errorLog("Optimization steps parsing failed");
-            return false;
-        }
-    } else {
-        // 单点计算
-        infoLog("Single point calculation detected");
-        if (!parseSinglePoint(file, data)) {
-            errorLog("Single point calculation parsing failed");
-            return false;
-        }
+
+    bool has(Marker marker) const { return (bits_ & (1u << marker)) != 0; }
+    bool empty() const { return bits_ == 0; }
+
+private:
+    uint32_t bits_;
+};
+
+// "E[DFT] = value" 这类行中等号之后的数值
+bool parseValueAfterEquals(std::string_view line, double& value) {
+    const size_t pos = line.find('=');
+    if (pos == std::string_view::npos) {
+        return false;
     }
-    
-    // 解析TD-DFT数据
-    if (data.hasTDDFT) {
-        if (!parseTDDFT(file, data)) {
-            errorLog("TD-DFT data parsing failed");
-            return false;
-        }
-        infoLog("TD-DFT data parsing completed");
+    value = string_utils::toDouble(string_utils::trimView(line.substr(pos + 1)));
+    return true;
+}
+
+} // namespace
+
+// 单遍解析AMESP输出的状态机
+//
+// 每一行先用多模式扫描器找出其中的段落标记，再交给各段落的子状态机：
+// - 优化步骤：从 "Geom Opt Step:" 行到下一个标记行（或文件末尾）为一个步骤块，
+//   块内依次是几何、能量（E[DFT]，没有时用 E[aTB]）、激发态和收敛表，块结束时有原子的步骤通过 emitStep 提交
+// - 单点计算：第一个几何及其后的能量，只在整个文件没有优化步骤标记时使用
+// - TD-DFT：激发态块按出现顺序对应各个步骤，追踪态（E(TD) = E[Eexc]）在 finish 时标记；
+//   流式模式下激发态块及其 E[Eexc] 都在步骤块之内，步骤块结束时标记并随步骤一起提交
+// - 频率：谐振频率、IR强度和法向模式按出现顺序读入 frequencies
+// - 热力学：任意位置出现的热力学关键字直接写入 thermoData
+class AmespParser::StateMachine {
+public:
+    // emit 为false时步骤直接追加到 data.optSteps（跟踪模式解析单个步骤块时使用）
+    StateMachine(AmespParser& parser, data::ParsedData& data, bool emit);
+
+    void feed(std::string_view line);
+    // 输入结束：收尾未结束的步骤块、频率列表和激发态
+    void finish();
+
+    bool foundOptimization() const { return optimization; }
+    bool foundExcitationEnergy() const { return excitationEnergy; }
+
+    // 单点计算的步骤，没有几何时返回false
+    bool takeSinglePoint();
+    // 激发态块依次对应已解析的步骤，没有任何对应的块时返回false
+    bool takeTDDFT();
+    std::pmr::vector<data::TDDFTData>& tddftBlocks() { return tddft; }
+
+private:
+    // 一个步骤块的解析进度
+    struct StepProgress {
+        enum class Geometry { Search, Header, Atoms, Done };
+        enum class Convergence { Disabled, Search, Table, Separator, Rows, Done };
+
+        data::OptStep step;
+        bool active = false;
+        Geometry geometry = Geometry::Search;
+        Convergence convergence = Convergence::Disabled;
+        int rowsLeft = 0;
+        bool energyFound = false;
+        bool fallbackFound = false;  // E[aTB]，没有 E[DFT] 时使用
+        double fallbackEnergy = 0.0;
+    };
+
+    void beginStep(std::string_view markerLine);
+    void feedStep(StepProgress& progress, std::string_view line, const LineMarkers& markers);
+    void closeStep(StepProgress& progress, bool atEnd);
+    // 提交一个有原子的步骤（优化步骤或单点计算），流式模式下带上对应的激发态块
+    bool submitStep(const data::OptStep& step);
+    const data::TDDFTData* streamedTDDFT(size_t block);
+    void markTrackedStates(size_t lastBlock);
+    void parseAtom(std::string_view line, std::vector<data::Atom>& atoms);
+    void parseConvergenceRow(std::string_view line, data::OptStep& step);
+    void checkConvergence(data::OptStep& step);
+
+    void feedTDDFT(std::string_view line, const LineMarkers& markers);
+    bool beginExcitedState(std::string_view line);
+    void parseExcitedStateLine(std::string_view line);
+    void closeExcitedState();
+
+    void feedFrequency(std::string_view line, const LineMarkers& markers);
+    void closeFrequencyList();
+    void feedNormalModes(std::string_view line, const LineMarkers& markers);
+    int currentAtomCount() const;
+
+    void feedThermo(std::string_view line, const LineMarkers& markers);
+
+    AmespParser& parser;
+    data::ParsedData& data;
+    const bool emit;
+    const bool streaming;
+    bool sinkFailed;
+
+    // 优化步骤和单点计算
+    bool optimization;
+    size_t submittedSteps;
+    StepProgress current;
+    StepProgress singlePoint;
+
+    // TD-DFT：已读到的激发态块及各块中带总能量的激发态
+    enum class TDDFTPhase { Idle, Block, State };
+    struct TotalEnergy {
+        size_t block;
+        size_t state;
+        double value;
+    };
+    bool excitationEnergy;
+    TDDFTPhase tddftPhase;
+    bool searchingEexc;  // 在当前块之后查找 E[Eexc]，遇到下一块或下一步骤为止
+    // 与 data 使用同一个内存资源；流式模式下已提交的块随即释放，改用堆内存
+    std::pmr::memory_resource* tddftResource;
+    std::pmr::vector<data::TDDFTData> tddft;
+    std::vector<double> eExcValues;
+    std::vector<TotalEnergy> totalEnergies;
+    size_t markedTotals;  // totalEnergies 中已检查过是否为追踪态的个数
+    data::ExcitedState state;
+    bool stateHasTotal;
+    double stateTotal;
+
+    // 频率
+    enum class FrequencyPhase { Idle, Harmonic, Header, Values, IRSearch, IRHeader, IRRows, Done };
+    FrequencyPhase frequencyPhase;
+    int skipLines;
+    size_t irRow;
+    std::vector<double> freqValues;
+
+    // 法向模式：每块最多5个模式，每块 nAtoms*3 行，块之间有空行和表头
+    enum class ModesPhase { Idle, Skip, Rows, Done };
+    ModesPhase modesPhase;
+    int modesSkip;
+    int modesAtoms;
+    int modeStart;
+    int modesInBlock;
+    int modeRowsLeft;
+};
+
+AmespParser::StateMachine::StateMachine(AmespParser& parser, data::ParsedData& data, bool emit)
+    : parser(parser), data(data), emit(emit), streaming(emit && parser.isStreaming()), sinkFailed(false),
+      optimization(false), submittedSteps(0),
+      excitationEnergy(false), tddftPhase(TDDFTPhase::Idle), searchingEexc(false),
+      tddftResource(streaming ? std::pmr::new_delete_resource() : data.resource()), tddft(tddftResource),
+      markedTotals(0), state(tddftResource), stateHasTotal(false), stateTotal(0.0),
+      frequencyPhase(FrequencyPhase::Idle), skipLines(0), irRow(0),
+      modesPhase(ModesPhase::Idle), modesSkip(0), modesAtoms(0), modeStart(0), modesInBlock(0), modeRowsLeft(0) {
+    singlePoint.active = true;
+    singlePoint.step.stepNumber = 1;
+    singlePoint.step.converged = true;
+}
+
+void AmespParser::StateMachine::feed(std::string_view line) {
+    const LineMarkers markers(line);
+
+    if (markers.has(MARKER_OPT_STEP)) {
+        closeStep(current, false);
+        beginStep(line);
+    } else if (current.active) {
+        feedStep(current, line, markers);
     }
-    
-    // 解析频率
-    if (parseFrequencies(file, data)) {
-        data.hasFreq = true;
-        infoLog("Frequency parsing completed");
+
+    // 出现优化步骤后单点计算的结果不再使用
+    if (!optimization && singlePoint.active) {
+        feedStep(singlePoint, line, markers);
     }
-    
-    // 解析热力学数据
-    if (parseThermoData(file, data)) {
-        infoLog("Thermodynamic data parsing completed");
+
+    if (markers.has(MARKER_EEXC)) {
+        excitationEnergy = true;
+    }
+    feedTDDFT(line, markers);
+
+    if (frequencyPhase != FrequencyPhase::Done) {
+        feedFrequency(line, markers);
+    }
+    if (modesPhase != ModesPhase::Done) {
+        feedNormalModes(line, markers);
+    }
+    if (!markers.empty()) {
+        feedThermo(line, markers);
     }
-    
-    debugLog("AMESP file parsing completed");
-    return true;
 }
 
-bool AmespParser::validateInput(const std::string& filename) {
-    // 只检查文件是否存在，不检查扩展名
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        errorLog("Cannot open file: " + filename);
-        return false;
+void AmespParser::StateMachine::finish() {
+    closeStep(current, true);
+    if (!optimization) {
+        closeStep(singlePoint, true);
+    }
+
+    closeExcitedState();
+    markTrackedStates(tddft.size());
+    for (auto& block : tddft) {
+        block.hasData = !block.excitedStates.empty();
+    }
+
+    if (frequencyPhase == FrequencyPhase::Values) {
+        closeFrequencyList();
+    }
+    if (frequencyPhase == FrequencyPhase::IRSearch) {
+        parser.debugLog("IR spectrum data not found");
     }
-    
-    // 用户指定的文件就是想要转换的文件，不需要额外验证
-    return true;
 }
 
-std::string AmespParser::getParserName() const {
-    return "AmespParser";
+bool AmespParser::StateMachine::takeSinglePoint() {
+    if (singlePoint.step.atoms.empty()) {
+        return false;
+    }
+    return submitStep(singlePoint.step);
 }
 
-std::string AmespParser::getParserVersion() const {
-    return "1.0.0";
+bool AmespParser::StateMachine::takeTDDFT() {
+    // 为每个优化步骤或单点计算分配对应的TD-DFT数据
+    const size_t expectedSteps = data.optSteps.size();
+    const size_t blocks = std::min(tddft.size(), expectedSteps);
+    data.tddftData.resize(expectedSteps);
+    for (size_t i = 0; i < blocks; i++) {
+        data.tddftData[i] = std::move(tddft[i]);
+        if (data.tddftData[i].hasData) {
+            parser.debugLog("Parsed " + std::to_string(data.tddftData[i].excitedStates.size()) +
+                            " excited states for step " + std::to_string(i + 1));
+        }
+    }
+
+    parser.debugLog("TD-DFT parsing completed, processed " + std::to_string(blocks) + " steps");
+    return blocks > 0;
 }
 
-std::vector<std::string> AmespParser::getSupportedKeywords() const {
-    return {"OPT", "FREQ", "SP", "SINGLE_POINT", "OPTIMIZATION", "FREQUENCY"};
+void AmespParser::StateMachine::beginStep(std::string_view markerLine) {
+    optimization = true;
+    current = StepProgress();
+    current.active = true;
+    current.convergence = StepProgress::Convergence::Search;
+
+    // 提取步骤编号
+    std::istringstream iss{std::string(markerLine)};
+    std::string dummy1, dummy2, dummy3;
+    if (iss >> dummy1 >> dummy2 >> dummy3 >> current.step.stepNumber) {
+        parser.debugLog("Processing optimization step " + std::to_string(current.step.stepNumber));
+    }
 }
 
-bool AmespParser::parseOptimizationSteps(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.find("Geom Opt Step:") != std::string::npos) {
-            data::OptStep step;
-            step.energy = 0.0;
-            step.rmsGrad = step.maxGrad = step.rmsStep = step.maxStep = 0.0;
-            step.converged = false;
-            
-            // 提取步骤编号
-            std::istringstream iss(line);
-            std::string dummy1, dummy2, dummy3;
-            if (iss >> dummy1 >> dummy2 >> dummy3 >> step.stepNumber) {
-                debugLog("Processing optimization step " + std::to_string(step.stepNumber));
-            }
-            
-            // 查找并解析几何
-            if (string_utils::LineProcessor::findLine(file, "Current Geometry(angstroms):")) {
-                std::getline(file, line); // 跳过头行
-                parseGeometry(file, step.atoms);
+void AmespParser::StateMachine::feedStep(StepProgress& progress, std::string_view line, const LineMarkers& markers) {
+    using Geometry = StepProgress::Geometry;
+    using Convergence = StepProgress::Convergence;
+
+    switch (progress.geometry) {
+        case Geometry::Search:
+            if (markers.has(MARKER_GEOMETRY)) {
+                progress.geometry = Geometry::Header;
             }
-            
-            // 解析能量
-            step.energy = parseEnergyFromCurrentPosition(file);
-            
-            // 解析收敛性
-            parseConvergence(file, step);
-            
-            if (!step.atoms.empty()) {
-                data.optSteps.push_back(step);
-                debugLog("Added step " + std::to_string(step.stepNumber) + 
-                        " containing " + std::to_string(step.atoms.size()) + " atoms");
+            return;
+        case Geometry::Header:
+            // 跳过头行
+            progress.geometry = Geometry::Atoms;
+            return;
+        case Geometry::Atoms:
+            // 停在分隔线
+            if (markers.has(MARKER_GEOMETRY_END)) {
+                progress.geometry = Geometry::Done;
+            } else {
+                parseAtom(line, progress.step.atoms);
             }
+            return;
+        case Geometry::Done:
+            break;
+    }
+
+    // 几何之后的第一个 E[DFT]，没有时用第一个 E[aTB]
+    if (!progress.energyFound) {
+        double energy = 0.0;
+        if (markers.has(MARKER_E_DFT) && parseValueAfterEquals(line, energy)) {
+            progress.step.energy = energy;
+            progress.energyFound = true;
+            parser.debugLog("Found energy E[DFT]: " + std::to_string(energy));
+        } else if (!progress.fallbackFound && markers.has(MARKER_E_ATB) && parseValueAfterEquals(line, energy)) {
+            progress.fallbackEnergy = energy;
+            progress.fallbackFound = true;
         }
     }
-    
-    infoLog("Total optimization steps: " + std::to_string(data.optSteps.size()));
-    return !data.optSteps.empty();
+
+    switch (progress.convergence) {
+        case Convergence::Search:
+            if (markers.has(MARKER_CONVERGENCE)) {
+                parser.debugLog("Found convergence section, step " + std::to_string(progress.step.stepNumber));
+                progress.convergence = Convergence::Table;
+            } else if (markers.has(MARKER_OPT_CONVERGED)) {
+                progress.convergence = Convergence::Done;
+            }
+            break;
+        case Convergence::Table:
+            if (markers.has(MARKER_CONVERGENCE_TABLE)) {
+                progress.convergence = Convergence::Separator;
+            }
+            break;
+        case Convergence::Separator:
+            // 跳过分隔线
+            progress.convergence = Convergence::Rows;
+            progress.rowsLeft = 4;
+            break;
+        case Convergence::Rows:
+            parseConvergenceRow(line, progress.step);
+            if (--progress.rowsLeft == 0) {
+                checkConvergence(progress.step);
+                progress.convergence = Convergence::Done;
+            }
+            break;
+        case Convergence::Disabled:
+        case Convergence::Done:
+            break;
+    }
 }
 
-bool AmespParser::parseSinglePoint(std::ifstream& file, data::ParsedData& data) {
-    data::OptStep step;
-    step.stepNumber = 1;
-    step.converged = true;
-    
-    // 查找几何
-    string_utils::LineProcessor::resetToBeginning(file);
-    if (string_utils::LineProcessor::findLineFromBeginning(file, "Current Geometry(angstroms):")) {
-        std::string line;
-        std::getline(file, line); // 跳过头行
-        parseGeometry(file, step.atoms);
+void AmespParser::StateMachine::closeStep(StepProgress& progress, bool atEnd) {
+    using Convergence = StepProgress::Convergence;
+
+    if (!progress.active) {
+        return;
     }
-    
-    // 解析能量
-    step.energy = parseEnergyFromCurrentPosition(file);
-    
-    if (!step.atoms.empty()) {
-        data.optSteps.push_back(step);
-        return true;
+    progress.active = false;
+
+    if (!progress.energyFound && progress.fallbackFound) {
+        progress.step.energy = progress.fallbackEnergy;
+        parser.debugLog("Found energy E[aTB]: " + std::to_string(progress.fallbackEnergy));
+    }
+
+    // 收敛表读到一半时按已读到的值判断；只找到 "Geometry Convergence:" 而没有表头时，
+    // 只有到文件末尾才判断（下一步骤开始则视为没有收敛信息）
+    if (progress.convergence == Convergence::Separator || progress.convergence == Convergence::Rows ||
+        (progress.convergence == Convergence::Table && atEnd)) {
+        checkConvergence(progress.step);
+    }
+
+    if (&progress == &current && !progress.step.atoms.empty() && submitStep(progress.step)) {
+        if (parser.isDebugEnabled()) {
+            parser.debugLog("Added step " + std::to_string(progress.step.stepNumber) +
+                            " containing " + std::to_string(progress.step.atoms.size()) + " atoms");
+        }
     }
-    
-    return false;
 }
 
-bool AmespParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    if (!string_utils::LineProcessor::findLineFromBeginning(file, "========================== Frequency ===========================")) {
-        debugLog("Frequency analysis not found");
+bool AmespParser::StateMachine::submitStep(const data::OptStep& step) {
+    const size_t index = submittedSteps++;
+    if (!emit) {
+        data.optSteps.append(step);
+        return true;
+    }
+    // sink失败后不再提交后续步骤
+    if (sinkFailed) {
         return false;
     }
-    
-    debugLog("Found frequency analysis");
-    
-    // 查找谐振频率
-    if (!string_utils::LineProcessor::findLine(file, "Harmonic frequencies(cm-1):")) {
+
+    const data::TDDFTData* stepTDDFT = streaming ? streamedTDDFT(index) : nullptr;
+    if (!parser.emitStep(data, step, stepTDDFT)) {
+        sinkFailed = true;
         return false;
     }
-    
-    // 跳过空行
-    std::string line;
-    std::getline(file, line);
-    
-    // 读取频率值
-    std::vector<double> freqValues;
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        if (line.empty() || line.find("Zero-point") != std::string::npos) {
-            break;
-        }
-        
-        std::istringstream iss(line);
-        int index;
-        double freq;
-        if (iss >> index >> freq) {
-            freqValues.push_back(freq);
+    // 已写出的激发态不再需要
+    if (stepTDDFT) {
+        tddft[index].excitedStates.clear();
+        tddft[index].excitedStates.shrink_to_fit();
+    }
+    return true;
+}
+
+const data::TDDFTData* AmespParser::StateMachine::streamedTDDFT(size_t block) {
+    // 与 takeTDDFT 相同，第 block 个激发态块属于第 block 个步骤；
+    // 到这一步为止还没有出现过 E[Eexc] 时不输出激发态
+    if (!excitationEnergy || block >= tddft.size()) {
+        return nullptr;
+    }
+    markTrackedStates(block + 1);
+    tddft[block].hasData = !tddft[block].excitedStates.empty();
+    return &tddft[block];
+}
+
+void AmespParser::StateMachine::markTrackedStates(size_t lastBlock) {
+    // totalEnergies 按块的顺序追加，只检查前 lastBlock 个块中尚未检查的部分
+    for (; markedTotals < totalEnergies.size() && totalEnergies[markedTotals].block < lastBlock; markedTotals++) {
+        const TotalEnergy& total = totalEnergies[markedTotals];
+        // 检查是否为追踪态 (E(TD) = E[Eexc])
+        const double tolerance = 1e-9; // 浮点数比较容差
+        if (std::abs(total.value - eExcValues[total.block]) < tolerance) {
+            data::ExcitedState& tracked = tddft[total.block].excitedStates[total.state];
+            tracked.hasOptimizationInfo = true;
+            tracked.hasTotalEnergy = true;
+            tracked.totalEnergy = total.value;
+            tracked.additionalInfo = "Copying the excited state density for this state as the 1-particle RhoCI density.";
+            parser.debugLog("Excited state " + std::to_string(tracked.stateNumber) + " is the tracked state (E(TD)/E(TDA-aTB) = E[Eexc])");
         }
     }
-    
-    debugLog("Parsed " + std::to_string(freqValues.size()) + " frequencies");
-    
-    // 查找IR强度
-    std::vector<double> irValues;
-    if (string_utils::LineProcessor::findLine(file, ">>>>>>>>>>>>>>>> IR spectrum (T^2,KM/Mole) <<<<<<<<<<<<<<<<")) {
-        std::getline(file, line); // 跳过空行
-        std::getline(file, line); // 跳过表头 "freq(cm^-1)     T^2         Tx         Ty         Tz"
-        
-        for (size_t i = 0; i < freqValues.size(); i++) {
-            if (std::getline(file, line)) {
-                std::istringstream iss(line);
-                int index;
-                double freq, intensity;
-                if (iss >> index >> freq >> intensity) {
-                    irValues.push_back(intensity);
-                    debugLog("Frequency " + std::to_string(i+1) + ": " + std::to_string(freq) + " cm-1, IR intensity: " + std::to_string(intensity));
-                } else {
-                    irValues.push_back(0.0);
-                }
-            } else {
-                irValues.push_back(0.0);
-            }
+}
+
+void AmespParser::StateMachine::parseAtom(std::string_view line, std::vector<data::Atom>& atoms) {
+    // 解析原子行：Element X Y Z
+    string_utils::FixedTokenizer<4> fields;
+    double x, y, z;
+    if (fields.split(line) > 0 && fields.get(1, x) && fields.get(2, y) && fields.get(3, z)) {
+        data::Atom atom;
+        atom.symbol = fields[0];
+        atom.atomicNumber = data::elements::atomicNumber(fields[0]);
+        atom.x = x;
+        atom.y = y;
+        atom.z = z;
+        atoms.push_back(atom);
+
+        if (parser.isDebugEnabled()) {
+            parser.debugLog("Read atom: " + atom.symbol.str() + " (" + std::to_string(atom.atomicNumber) +
+                            ") at (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
         }
-    } else {
-        debugLog("IR spectrum data not found");
-        // 如果没有找到IR数据，用0填充
-        irValues.resize(freqValues.size(), 0.0);
     }
-    
-    // 创建频率模式
-    for (size_t i = 0; i < freqValues.size(); i++) {
-        data::FreqMode mode;
-        mode.frequency = freqValues[i];
-        mode.irIntensity = (i < irValues.size()) ? irValues[i] : 0.0;
-        mode.irrep = "A"; // 默认对称性
-        data.frequencies.push_back(mode);
+}
+
+void AmespParser::StateMachine::parseConvergenceRow(std::string_view line, data::OptStep& step) {
+    std::istringstream iss{std::string(line)};
+    std::string word1, word2;
+    double value, threshold;
+    std::string converged;
+
+    if (iss >> word1 >> word2 >> value >> threshold >> converged) {
+        if (word1 == "RMS" && word2 == "Force") {
+            step.rmsGrad = value;
+        } else if (word1 == "Max" && word2 == "Force") {
+            step.maxGrad = value;
+        } else if (word1 == "RMS" && word2 == "Step") {
+            step.rmsStep = value;
+        } else if (word1 == "Max" && word2 == "Step") {
+            step.maxStep = value;
+        }
     }
-    
-    debugLog("Frequency parsing completed, " + std::to_string(data.frequencies.size()) + " modes");
-    
-    // 解析法向模式
-    parseNormalModes(file, data);
-    
-    return !data.frequencies.empty();
 }
 
-bool AmespParser::parseThermoData(std::ifstream& file, data::ParsedData& data) {
-    std::string line;
-    
-    // 重置文件位置到开始
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    // 首先尝试找到热力学摘要部分
-    if (string_utils::LineProcessor::findLine(file, ">>>>>>>>>>> Summary of Thermodynamic Quantities <<<<<<<<<<<<<")) {
-        data.thermoData.hasData = true;
-        debugLog("Found thermodynamic summary section");
-    } else {
-        // 如果没有找到摘要部分，从头开始查找单独的热力学值
-        string_utils::LineProcessor::resetToBeginning(file);
+void AmespParser::StateMachine::checkConvergence(data::OptStep& step) {
+    step.converged = (step.rmsGrad < 0.0003 && step.maxGrad < 0.00045 &&
+                      step.rmsStep < 0.0012 && step.maxStep < 0.0018);
+
+    parser.debugLog("Step " + std::to_string(step.stepNumber) + " convergence info: " +
+                    "RMS gradient=" + std::to_string(step.rmsGrad) + ", " +
+                    "Max gradient=" + std::to_string(step.maxGrad) + ", " +
+                    "Converged=" + (step.converged ? "Yes" : "No"));
+}
+
+void AmespParser::StateMachine::feedTDDFT(std::string_view line, const LineMarkers& markers) {
+    // TD-DFT块的开始标记
+    if (markers.has(MARKER_TDDFT)) {
+        closeExcitedState();
+        tddft.emplace_back();
+        eExcValues.push_back(0.0);
+        tddftPhase = TDDFTPhase::Block;
+        searchingEexc = true;
+        parser.debugLog("Found TD-DFT section " + std::to_string(tddft.size()));
+        return;
     }
-    
-    // 解析文件中的所有热力学数据
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
-        // 解析温度
-        if (string_utils::contains(line, "Temperature:")) {
-            std::istringstream iss(line);
-            std::string dummy;
-            double temp;
-            if (iss >> dummy >> temp) {
-                data.thermoData.temperature = temp;
-                data.thermoData.hasData = true;
-                debugLog("Found temperature: " + std::to_string(temp) + " K");
-            }
+
+    // 块之后的 E[Eexc] 属于这一块；遇到下一个步骤时停止查找
+    if (searchingEexc) {
+        double eExcValue = 0.0;
+        if (markers.has(MARKER_EEXC) && parseValueAfterEquals(line, eExcValue)) {
+            eExcValues.back() = eExcValue;
+            searchingEexc = false;
+            parser.debugLog("Found E[Eexc] for TD-DFT section " + std::to_string(tddft.size()) + ": " +
+                            std::to_string(eExcValue));
+        } else if (markers.has(MARKER_OPT_STEP)) {
+            searchingEexc = false;
         }
-        // 解析压力
-        else if (string_utils::contains(line, "Pressure:")) {
-            std::istringstream iss(line);
-            std::string dummy;
-            double press;
-            if (iss >> dummy >> press) {
-                data.thermoData.pressure = press;
-                data.thermoData.hasData = true;
-                debugLog("Found pressure: " + std::to_string(press) + " atm");
-            }
+    }
+
+    if (tddftPhase == TDDFTPhase::Idle) {
+        return;
+    }
+
+    const std::string_view text = string_utils::trimView(line);
+    if (tddftPhase == TDDFTPhase::State) {
+        // 空行、E(TD)行或下一个State行结束当前激发态
+        if (text.empty()) {
+            closeExcitedState();
+            return;
         }
-        // 解析零点振动能
-        else if (string_utils::contains(line, "Zero-point vibrational energy:")) {
-            std::istringstream iss(line);
-            std::string dummy1, dummy2, dummy3;
-            double zpe;
-            if (iss >> dummy1 >> dummy2 >> dummy3 >> zpe) {
-                data.thermoData.zpe = zpe;
-                data.thermoData.hasData = true;
-                debugLog("Found zero-point energy: " + std::to_string(zpe) + " Hartree");
-            }
+        if (text.find("-->") != std::string_view::npos || text.find("<--") != std::string_view::npos) {
+            parseExcitedStateLine(text);
+            return;
         }
-        // 解析热力学修正到U(T) - 对应"Thermal correction to Energy"
-        else if (string_utils::contains(line, "Thermal correction to U(T):")) {
-            std::istringstream iss(line);
-            std::string dummy1, dummy2, dummy3, dummy4;
-            double value;
-            if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
-                data.thermoData.thermalEnergyCorr = value;
-                data.thermoData.hasData = true;
-                debugLog("Found thermal correction to U(T): " + std::to_string(value) + " Hartree");
-            }
+        if (text.find("E(TD)") != std::string_view::npos || text.find("E(TDA-aTB)") != std::string_view::npos) {
+            parseExcitedStateLine(text);
+            closeExcitedState();
+            return;
         }
-        // 解析热力学修正到H(T) - 对应"Thermal correction to Enthalpy"
-        else if (string_utils::contains(line, "Thermal correction to H(T):")) {
-            std::istringstream iss(line);
-            std::string dummy1, dummy2, dummy3, dummy4;
-            double value;
-            if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
-                data.thermoData.thermalEnthalpyCorr = value;
-                data.thermoData.hasData = true;
-                debugLog("Found thermal correction to H(T): " + std::to_string(value) + " Hartree");
-            }
+        if (text.find("State") == std::string_view::npos || text.find(':') == std::string_view::npos) {
+            return;
         }
-        // 解析热力学修正到G(T) - 对应"Thermal correction to Gibbs Free Energy"
-        else if (string_utils::contains(line, "Thermal correction to G(T):")) {
-            std::istringstream iss(line);
-            std::string dummy1, dummy2, dummy3, dummy4;
-            double value;
-            if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
-                data.thermoData.thermalGibbsCorr = value;
-                data.thermoData.hasData = true;
-                debugLog("Found thermal correction to G(T): " + std::to_string(value) + " Hartree");
+        closeExcitedState();
+    }
+
+    // 检查是否是激发态开始行
+    if (text.find("State") != std::string_view::npos && text.find(':') != std::string_view::npos &&
+        text.find("E =") != std::string_view::npos && beginExcitedState(text)) {
+        return;
+    }
+
+    // 检查是否到达TD-DFT块结束
+    if (markers.has(MARKER_TDDFT_TIME) || markers.has(MARKER_TDDFT_END)) {
+        tddftPhase = TDDFTPhase::Idle;
+    }
+}
+
+bool AmespParser::StateMachine::beginExcitedState(std::string_view line) {
+    state = data::ExcitedState(tddftResource);
+    stateHasTotal = false;
+
+    // 解析状态行：State    1 : E =    7.1627 eV     173.097 nm      57770.95 cm-1
+    std::istringstream iss{std::string(line)};
+    std::string dummy;
+    if (iss >> dummy >> state.stateNumber >> dummy >> dummy >> dummy >> state.excitationEnergy_eV
+        >> dummy >> state.wavelength_nm >> dummy) {
+
+        parser.debugLog("Parsing excited state " + std::to_string(state.stateNumber) +
+                        ", E = " + std::to_string(state.excitationEnergy_eV) + " eV");
+
+        // 设置默认对称性（AMESP输出中没有明确的对称性信息）
+        state.symmetry = "Singlet-A";
+        tddftPhase = TDDFTPhase::State;
+        return true;
+    }
+
+    // 状态行不完整时只保留已读出的编号，不读后续的跃迁
+    tddftPhase = TDDFTPhase::State;
+    closeExcitedState();
+    return false;
+}
+
+void AmespParser::StateMachine::parseExcitedStateLine(std::string_view line) {
+    const std::string text(line);
+
+    // 解析轨道跃迁：11 -->   13      0.5002429 或 10 <--   12     -0.5002429
+    if (text.find("-->") != std::string::npos || text.find("<--") != std::string::npos) {
+        std::istringstream transIss(text);
+        int fromOrb, toOrb;
+        std::string arrow;
+        double coeff;
+
+        if (transIss >> fromOrb >> arrow >> toOrb >> coeff) {
+            data::OrbitalTransition transition;
+            transition.fromOrb = fromOrb;
+            transition.toOrb = toOrb;
+            transition.coefficient = coeff; // 保持原始系数，包括负号
+            transition.isForward = (arrow == "-->"); // --> 为true，<-- 为false
+            state.transitions.push_back(transition);
+
+            if (parser.isDebugEnabled()) {
+                parser.debugLog("  Transition: " + std::to_string(fromOrb) + " " + arrow + " " +
+                                std::to_string(toOrb) + " (" + std::to_string(coeff) + ")");
             }
         }
-        // 解析最终电子能量
-        else if (string_utils::contains(line, "Final Energy:")) {
-            std::istringstream iss(line);
-            std::string dummy1, dummy2;
-            double energy;
-            if (iss >> dummy1 >> dummy2 >> energy) {
-                data.thermoData.electronicEnergy = energy;
-                data.thermoData.hasData = true;
-                debugLog("Found final energy: " + std::to_string(energy) + " Hartree");
-            }
+        return;
+    }
+
+    // 解析E(TD)行：E(TD) =   -188.290813700      <S**2>= 0.000     f=  0.0000
+    // 或者：E(TDA-aTB) =   -188.290813700      <S**2>= 0.000     f=  0.0000
+    std::istringstream etdIss(text);
+    std::string etd, eq;
+    double totalEnergy;
+    if (!(etdIss >> etd >> eq >> totalEnergy)) {
+        return;
+    }
+
+    // 是否为追踪态要等读到这一块的 E[Eexc] 之后才能判断
+    stateHasTotal = true;
+    stateTotal = totalEnergy;
+
+    // 查找<S**2>值
+    size_t s2Pos = text.find("<S**2>=");
+    if (s2Pos != std::string::npos) {
+        std::string s2Str = text.substr(s2Pos + 7);
+        size_t spacePos = s2Str.find(' ');
+        if (spacePos != std::string::npos) {
+            state.s2Value = string_utils::toDouble(s2Str.substr(0, spacePos));
         }
     }
-    
-    if (data.thermoData.hasData) {
-        debugLog("Thermodynamic data parsing completed:");
-        debugLog("  Temperature: " + std::to_string(data.thermoData.temperature) + " K");
-        debugLog("  Pressure: " + std::to_string(data.thermoData.pressure) + " atm");
-        debugLog("  Electronic energy: " + std::to_string(data.thermoData.electronicEnergy) + " Hartree");
-        debugLog("  Zero-point energy: " + std::to_string(data.thermoData.zpe) + " Hartree");
-        debugLog("  Thermal correction to energy: " + std::to_string(data.thermoData.thermalEnergyCorr) + " Hartree");
-        debugLog("  Thermal correction to enthalpy: " + std::to_string(data.thermoData.thermalEnthalpyCorr) + " Hartree");
-        debugLog("  Thermal correction to Gibbs: " + std::to_string(data.thermoData.thermalGibbsCorr) + " Hartree");
+
+    // 查找振荡强度f值
+    size_t fPos = text.find("f=");
+    if (fPos != std::string::npos) {
+        state.oscillatorStrength = string_utils::toDouble(string_utils::trimView(std::string_view(text).substr(fPos + 2)));
     }
-    
-    return data.thermoData.hasData;
+
+    parser.debugLog("  Total energy: " + std::to_string(totalEnergy) +
+                    ", <S**2>: " + std::to_string(state.s2Value) +
+                    ", f: " + std::to_string(state.oscillatorStrength));
 }
 
-void AmespParser::parseGeometry(std::ifstream& file, std::vector<data::Atom>& atoms) {
-    atoms.clear();
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
-        // 停在分隔线
-        if (line.find("----------------------------------------------------------------") != std::string::npos) {
+void AmespParser::StateMachine::closeExcitedState() {
+    if (tddftPhase != TDDFTPhase::State) {
+        return;
+    }
+    tddftPhase = TDDFTPhase::Block;
+
+    if (state.stateNumber > 0) {
+        auto& states = tddft.back().excitedStates;
+        if (stateHasTotal) {
+            totalEnergies.push_back({tddft.size() - 1, states.size(), stateTotal});
+        }
+        states.push_back(std::move(state));
+        parser.debugLog("Parsed excited state " + std::to_string(states.back().stateNumber));
+    }
+}
+
+void AmespParser::StateMachine::feedFrequency(std::string_view line, const LineMarkers& markers) {
+    switch (frequencyPhase) {
+        case FrequencyPhase::Idle:
+            if (markers.has(MARKER_FREQUENCY)) {
+                parser.debugLog("Found frequency analysis");
+                frequencyPhase = FrequencyPhase::Harmonic;
+            }
+            break;
+        case FrequencyPhase::Harmonic:
+            // 查找谐振频率
+            if (markers.has(MARKER_HARMONIC)) {
+                frequencyPhase = FrequencyPhase::Header;
+            }
+            break;
+        case FrequencyPhase::Header:
+            // 跳过空行
+            frequencyPhase = FrequencyPhase::Values;
+            break;
+        case FrequencyPhase::Values: {
+            // 读取频率值
+            if (string_utils::trimView(line).empty() || markers.has(MARKER_ZERO_POINT)) {
+                closeFrequencyList();
+                break;
+            }
+            std::istringstream iss{std::string(line)};
+            int index;
+            double freq;
+            if (iss >> index >> freq) {
+                freqValues.push_back(freq);
+            }
             break;
         }
-        
-        // 解析原子行：Element X Y Z
-        if (!line.empty()) {
-            std::istringstream iss(line);
-            std::string element;
-            double x, y, z;
-            
-            if (iss >> element >> x >> y >> z) {
-                data::Atom atom;
-                atom.symbol = element;
-                atom.atomicNumber = elementMap->getAtomicNumber(element);
-                atom.x = x;
-                atom.y = y;
-                atom.z = z;
-                atoms.push_back(atom);
-                
-                debugLog("Read atom: " + element + " (" + std::to_string(atom.atomicNumber) +
-                        ") at (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
+        case FrequencyPhase::IRSearch:
+            // 查找IR强度
+            if (markers.has(MARKER_IR_SPECTRUM)) {
+                frequencyPhase = FrequencyPhase::IRHeader;
+                skipLines = 2; // 空行和表头 "freq(cm^-1)     T^2         Tx         Ty         Tz"
+            }
+            break;
+        case FrequencyPhase::IRHeader:
+            if (--skipLines == 0) {
+                frequencyPhase = data.frequencies.empty() ? FrequencyPhase::Done : FrequencyPhase::IRRows;
+            }
+            break;
+        case FrequencyPhase::IRRows: {
+            std::istringstream iss{std::string(line)};
+            int index;
+            double freq, intensity;
+            if (iss >> index >> freq >> intensity) {
+                data.frequencies[irRow].irIntensity = intensity;
+                if (parser.isDebugEnabled()) {
+                    parser.debugLog("Frequency " + std::to_string(irRow + 1) + ": " + std::to_string(freq) +
+                                    " cm-1, IR intensity: " + std::to_string(intensity));
+                }
+            }
+            if (++irRow == data.frequencies.size()) {
+                frequencyPhase = FrequencyPhase::Done;
             }
+            break;
         }
+        case FrequencyPhase::Done:
+            break;
     }
 }
 
-double AmespParser::parseEnergyFromCurrentPosition(std::ifstream& file) {
-    std::string line;
-    double energy = 0.0;
-    
-    // 首先尝试查找E[DFT]，如果找不到则查找E[aTB]
-    std::vector<std::string> energyPatterns = {"E[DFT]", "E[aTB]"};
-    
-    for (const auto& targetPattern : energyPatterns) {
-        // 重置文件位置到当前位置开始
-        std::streampos startPos = file.tellg();
-        
-        while (std::getline(file, line)) {
-            if (line.find(targetPattern) != std::string::npos) {
-                size_t pos = line.find("=");
-                if (pos != std::string::npos) {
-                    std::string energyStr = string_utils::trim(line.substr(pos + 1));
-                    energy = string_utils::toDouble(energyStr);
-                    debugLog("Found energy " + targetPattern + ": " + std::to_string(energy));
-                    return energy;
+void AmespParser::StateMachine::closeFrequencyList() {
+    parser.debugLog("Parsed " + std::to_string(freqValues.size()) + " frequencies");
+
+    // 创建频率模式，IR强度在读到IR谱之前为0
+    for (double value : freqValues) {
+        data::FreqMode mode;
+        mode.frequency = value;
+        mode.irIntensity = 0.0;
+        mode.irrep = "A"; // 默认对称性
+        data.frequencies.push_back(mode);
+    }
+    freqValues.clear();
+    frequencyPhase = FrequencyPhase::IRSearch;
+
+    parser.debugLog("Frequency parsing completed, " + std::to_string(data.frequencies.size()) + " modes");
+}
+
+int AmespParser::StateMachine::currentAtomCount() const {
+    if (!optimization) {
+        return static_cast<int>(singlePoint.step.atoms.size());
+    }
+    // 最后一个步骤块还没有结束时它就是最后一步
+    if (current.active && !current.step.atoms.empty()) {
+        return static_cast<int>(current.step.atoms.size());
+    }
+    return data.optSteps.empty() ? 0 : static_cast<int>(data.optSteps.back().atomCount());
+}
+
+void AmespParser::StateMachine::feedNormalModes(std::string_view line, const LineMarkers& markers) {
+    const int nFreqs = static_cast<int>(data.frequencies.size());
+
+    switch (modesPhase) {
+        case ModesPhase::Idle: {
+            if (!markers.has(MARKER_NORMAL_MODES)) {
+                break;
+            }
+            // 只解析第一个 "Normal Modes:" 段，且只在频率列表之后
+            modesPhase = ModesPhase::Done;
+            if (frequencyPhase == FrequencyPhase::Idle || frequencyPhase == FrequencyPhase::Harmonic ||
+                frequencyPhase == FrequencyPhase::Header || frequencyPhase == FrequencyPhase::Values) {
+                break;
+            }
+
+            modesAtoms = currentAtomCount();
+            if (modesAtoms == 0) {
+                parser.debugLog("No geometry information, cannot parse normal modes");
+                break;
+            }
+            parser.debugLog("Starting normal mode parsing, number of atoms: " + std::to_string(modesAtoms) +
+                            ", number of frequencies: " + std::to_string(nFreqs));
+
+            // 初始化位移矩阵
+            data.displacements.clear();
+            data.displacements.resize(data.frequencies.size(), static_cast<size_t>(modesAtoms));
+            if (nFreqs == 0) {
+                break;
+            }
+
+            // 跳过空行和表头
+            modeStart = 0;
+            modesInBlock = std::min(5, nFreqs);
+            modeRowsLeft = modesAtoms * 3;
+            modesSkip = 2;
+            modesPhase = ModesPhase::Skip;
+            break;
+        }
+        case ModesPhase::Skip:
+            if (--modesSkip == 0) {
+                modesPhase = ModesPhase::Rows;
+            }
+            break;
+        case ModesPhase::Rows: {
+            // 行格式: index atom X|Y|Z d1 d2 ...（逐token解析，不构造字符串流）
+            size_t pos = 0;
+            int index, atom;
+            if (string_utils::parseNumber(string_utils::nextToken(line, pos), index) &&
+                string_utils::parseNumber(string_utils::nextToken(line, pos), atom)) {
+                const std::string_view coord = string_utils::nextToken(line, pos);
+                int actualAtom = atom - 1; // 转换为0基索引
+                int coordIdx = (coord == "X") ? 0 : (coord == "Y") ? 1 : 2;
+
+                if (!coord.empty() && actualAtom >= 0 && actualAtom < modesAtoms) {
+                    for (int modeIdx = 0; modeIdx < modesInBlock; modeIdx++) {
+                        double displacement;
+                        if (!string_utils::parseNumber(string_utils::nextToken(line, pos), displacement)) {
+                            break;
+                        }
+                        data.displacements.atom(modeStart + modeIdx, actualAtom)[coordIdx] = displacement;
+                    }
                 }
             }
-            
-            if (line.find("Geom Opt Step:") != std::string::npos) {
+
+            if (--modeRowsLeft > 0) {
                 break;
             }
+            modeStart += modesInBlock;
+            if (modeStart < nFreqs) {
+                // 下一个块之前是空行和表头
+                modesInBlock = std::min(5, nFreqs - modeStart);
+                modeRowsLeft = modesAtoms * 3;
+                modesSkip = 2;
+                modesPhase = ModesPhase::Skip;
+            } else {
+                modesPhase = ModesPhase::Done;
+                parser.debugLog("Normal mode parsing completed, processed " + std::to_string(nFreqs) + " frequencies");
+            }
+            break;
         }
-        
-        // 重置到开始位置，尝试下一个模式
-        file.clear();
-        file.seekg(startPos);
+        case ModesPhase::Done:
+            break;
     }
-    
-    return energy;
 }
 
-void AmespParser::parseConvergence(std::ifstream& file, data::OptStep& step) {
-    std::string line;
-    
-    // 查找收敛部分
-    while (std::getline(file, line)) {
-        if (line.find("Geometry Convergence:") != std::string::npos) {
-            debugLog("Found convergence section, step " + std::to_string(step.stepNumber));
-            break;
+void AmespParser::StateMachine::feedThermo(std::string_view line, const LineMarkers& markers) {
+    data::ThermoData& thermo = data.thermoData;
+
+    if (markers.has(MARKER_THERMO_SUMMARY)) {
+        thermo.hasData = true;
+        parser.debugLog("Found thermodynamic summary section");
+    }
+
+    // 解析温度
+    if (markers.has(MARKER_TEMPERATURE)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy;
+        double temp;
+        if (iss >> dummy >> temp) {
+            thermo.temperature = temp;
+            thermo.hasData = true;
+            parser.debugLog("Found temperature: " + std::to_string(temp) + " K");
         }
-        if (line.find("Geom Opt Step:") != std::string::npos || 
-            line.find("Geometry Optimization Converged") != std::string::npos) {
-            return;
+    }
+    // 解析压力
+    else if (markers.has(MARKER_PRESSURE)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy;
+        double press;
+        if (iss >> dummy >> press) {
+            thermo.pressure = press;
+            thermo.hasData = true;
+            parser.debugLog("Found pressure: " + std::to_string(press) + " atm");
         }
     }
-    
-    // 查找收敛表
-    while (std::getline(file, line)) {
-        if (line.find("Item              Value        Threshold       Converged?") != std::string::npos) {
-            std::getline(file, line); // 跳过分隔线
-            break;
+    // 解析零点振动能
+    else if (markers.has(MARKER_ZPE)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy1, dummy2, dummy3;
+        double zpe;
+        if (iss >> dummy1 >> dummy2 >> dummy3 >> zpe) {
+            thermo.zpe = zpe;
+            thermo.hasData = true;
+            parser.debugLog("Found zero-point energy: " + std::to_string(zpe) + " Hartree");
         }
-        if (line.find("Geom Opt Step:") != std::string::npos) {
-            return;
+    }
+    // 解析热力学修正到U(T) - 对应"Thermal correction to Energy"
+    else if (markers.has(MARKER_THERMAL_U)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy1, dummy2, dummy3, dummy4;
+        double value;
+        if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
+            thermo.thermalEnergyCorr = value;
+            thermo.hasData = true;
+            parser.debugLog("Found thermal correction to U(T): " + std::to_string(value) + " Hartree");
         }
     }
-    
-    // 解析收敛值
-    for (int i = 0; i < 4; i++) {
-        if (std::getline(file, line)) {
-            line = string_utils::trim(line);
-            std::istringstream iss(line);
-            std::string word1, word2;
-            double value, threshold;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> value >> threshold >> converged) {
-                if (word1 == "RMS" && word2 == "Force") {
-                    step.rmsGrad = value;
-                } else if (word1 == "Max" && word2 == "Force") {
-                    step.maxGrad = value;
-                } else if (word1 == "RMS" && word2 == "Step") {
-                    step.rmsStep = value;
-                } else if (word1 == "Max" && word2 == "Step") {
-                    step.maxStep = value;
-                }
-            }
+    // 解析热力学修正到H(T) - 对应"Thermal correction to Enthalpy"
+    else if (markers.has(MARKER_THERMAL_H)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy1, dummy2, dummy3, dummy4;
+        double value;
+        if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
+            thermo.thermalEnthalpyCorr = value;
+            thermo.hasData = true;
+            parser.debugLog("Found thermal correction to H(T): " + std::to_string(value) + " Hartree");
+        }
+    }
+    // 解析热力学修正到G(T) - 对应"Thermal correction to Gibbs Free Energy"
+    else if (markers.has(MARKER_THERMAL_G)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy1, dummy2, dummy3, dummy4;
+        double value;
+        if (iss >> dummy1 >> dummy2 >> dummy3 >> dummy4 >> value) {
+            thermo.thermalGibbsCorr = value;
+            thermo.hasData = true;
+            parser.debugLog("Found thermal correction to G(T): " + std::to_string(value) + " Hartree");
+        }
+    }
+    // 解析最终电子能量
+    else if (markers.has(MARKER_FINAL_ENERGY)) {
+        std::istringstream iss{std::string(line)};
+        std::string dummy1, dummy2;
+        double energy;
+        if (iss >> dummy1 >> dummy2 >> energy) {
+            thermo.electronicEnergy = energy;
+            thermo.hasData = true;
+            parser.debugLog("Found final energy: " + std::to_string(energy) + " Hartree");
         }
     }
-    
-    // 检查是否收敛
-    step.converged = (step.rmsGrad < 0.0003 && step.maxGrad < 0.00045 && 
-                     step.rmsStep < 0.0012 && step.maxStep < 0.0018);
-    
-    debugLog("Step " + std::to_string(step.stepNumber) + " convergence info: " +
-            "RMS gradient=" + std::to_string(step.rmsGrad) + ", " +
-            "Max gradient=" + std::to_string(step.maxGrad) + ", " +
-            "Converged=" + (step.converged ? "Yes" : "No"));
 }
 
-void AmespParser::parseNormalModes(std::ifstream& file, data::ParsedData& data) {
-    std::string line;
-    
-    // 重置文件位置到开始
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    if (!string_utils::LineProcessor::findLine(file, "Normal Modes:")) {
-        debugLog("Normal Modes section not found");
-        return;
+bool AmespParser::parse(io::FileReader& reader, data::ParsedData& data) {
+    debugLog("Starting AMESP file parsing: " + reader.getFilename());
+
+    // 顺序读一遍输入，各段落在读到时直接写入 data（流式模式下步骤逐个交给sink）
+    StateMachine machine(*this, data, true);
+    if (reader.isMapped()) {
+        io::LineIterator lines = reader.lines();
+        std::string_view line;
+        while (lines.next(line)) {
+            machine.feed(line);
+        }
+    } else {
+        std::istream& file = reader.getStream();
+        std::string line;
+        while (std::getline(file, line)) {
+            machine.feed(line);
+        }
     }
-    
-    if (data.optSteps.empty()) {
-        debugLog("No geometry information, cannot parse normal modes");
-        return;
+    machine.finish();
+
+    // 检查是否有TD-DFT数据
+    if (machine.foundExcitationEnergy()) {
+        data.hasTDDFT = true;
+        infoLog("Found TD-DFT data (E[Eexc])");
     }
-    
-    int nAtoms = data.optSteps.back().atoms.size();
-    int nFreqs = data.frequencies.size();
-    
-    debugLog("Starting normal mode parsing, number of atoms: " + std::to_string(nAtoms) + ", number of frequencies: " + std::to_string(nFreqs));
-    
-    // 初始化位移向量
-    for (int i = 0; i < nFreqs; i++) {
-        data.frequencies[i].displacements.resize(nAtoms);
-        for (int j = 0; j < nAtoms; j++) {
-            data.frequencies[i].displacements[j].resize(3, 0.0);
+
+    // 检查优化
+    if (machine.foundOptimization()) {
+        data.hasOpt = true;
+        infoLog("Found geometry optimization");
+        infoLog("Total optimization steps: " + std::to_string(data.stepCount()));
+        if (data.optSteps.empty()) {
+            errorLog("Optimization steps parsing failed");
+            return false;
         }
-    }
-    
-    // 跳过空行和表头
-    std::getline(file, line);
-    std::getline(file, line); // header line with mode numbers
-    
-    // 解析位移数据
-    int currentModeStart = 0;
-    int modesInBlock = std::min(5, nFreqs); // 每块最多5个模式
-    
-    while (currentModeStart < nFreqs) {
-        // 确定这个块中有多少个模式
-        modesInBlock = std::min(5, nFreqs - currentModeStart);
-        
-        // 读取原子位移数据
-        for (int atomIdx = 0; atomIdx < nAtoms * 3; atomIdx++) {
-            if (!std::getline(file, line)) break;
-            
-            std::istringstream iss(line);
-            int index, atom;
-            std::string coord;
-            if (!(iss >> index >> atom >> coord)) continue;
-            
-            int actualAtom = atom - 1; // 转换为0基索引
-            int coordIdx = (coord == "X") ? 0 : (coord == "Y") ? 1 : 2;
-            
-            if (actualAtom >= 0 && actualAtom < nAtoms && coordIdx >= 0 && coordIdx < 3) {
-                for (int modeIdx = 0; modeIdx < modesInBlock; modeIdx++) {
-                    double displacement;
-                    if (iss >> displacement) {
-                        int globalModeIdx = currentModeStart + modeIdx;
-                        if (globalModeIdx < nFreqs) {
-                            data.frequencies[globalModeIdx].displacements[actualAtom][coordIdx] = displacement;
-                        }
-                    }
-                }
-            }
+    } else {
+        // 单点计算
+        infoLog("Single point calculation detected");
+        if (!machine.takeSinglePoint()) {
+            errorLog("Single point calculation parsing failed");
+            return false;
         }
-        
-        currentModeStart += modesInBlock;
-        
-        // 如果还有下一个块，跳过空行和表头
-        if (currentModeStart < nFreqs) {
-            std::getline(file, line); // 空行
-            std::getline(file, line); // 表头行
+    }
+
+    // TD-DFT数据
+    if (data.hasTDDFT) {
+        if (!machine.takeTDDFT()) {
+            errorLog("TD-DFT data parsing failed");
+            return false;
         }
+        infoLog("TD-DFT data parsing completed");
+    }
+
+    // 频率
+    if (!data.frequencies.empty()) {
+        data.hasFreq = true;
+        infoLog("Frequency parsing completed");
+    }
+
+    // 热力学数据
+    if (data.thermoData.hasData) {
+        debugLog("Thermodynamic data parsing completed:");
+        debugLog("  Temperature: " + std::to_string(data.thermoData.temperature) + " K");
+        debugLog("  Pressure: " + std::to_string(data.thermoData.pressure) + " atm");
+        debugLog("  Electronic energy: " + std::to_string(data.thermoData.electronicEnergy) + " Hartree");
+        debugLog("  Zero-point energy: " + std::to_string(data.thermoData.zpe) + " Hartree");
+        debugLog("  Thermal correction to energy: " + std::to_string(data.thermoData.thermalEnergyCorr) + " Hartree");
+        debugLog("  Thermal correction to enthalpy: " + std::to_string(data.thermoData.thermalEnthalpyCorr) + " Hartree");
+        debugLog("  Thermal correction to Gibbs: " + std::to_string(data.thermoData.thermalGibbsCorr) + " Hartree");
+        infoLog("Thermodynamic data parsing completed");
+    }
+
+    debugLog("AMESP file parsing completed");
+    return true;
+}
+
+bool AmespParser::validateInput(const std::string& filename) {
+    // 只检查文件是否存在，不检查扩展名
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        errorLog("Cannot open file: " + filename);
+        return false;
     }
     
-    debugLog("Normal mode parsing completed, processed " + std::to_string(nFreqs) + " frequencies");
+    // 用户指定的文件就是想要转换的文件，不需要额外验证
+    return true;
 }
 
-bool AmespParser::findOptimizationSection(std::ifstream& file) {
-    return string_utils::LineProcessor::findLineFromBeginning(file, "Geom Opt Step:");
+std::string AmespParser::getParserName() const {
+    return "AmespParser";
 }
 
-bool AmespParser::findFrequencySection(std::ifstream& file) {
-    return string_utils::LineProcessor::findLineFromBeginning(file, "========================== Frequency ===========================");
+std::string AmespParser::getParserVersion() const {
+    return "1.0.0";
 }
 
-bool AmespParser::findThermoSection(std::ifstream& file) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    return string_utils::LineProcessor::findLineFromBeginning(file, "Temperature:") ||
-           string_utils::LineProcessor::findLineFromBeginning(file, "Zero-point vibrational energy:");
+std::vector<std::string> AmespParser::getSupportedKeywords() const {
+    return {"OPT", "FREQ", "SP", "SINGLE_POINT", "OPTIMIZATION", "FREQUENCY"};
 }
 
-bool AmespParser::parseTDDFT(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    // 为每个优化步骤或单点计算查找对应的TD-DFT数据
-    int expectedSteps = data.optSteps.size();
-    data.tddftData.resize(expectedSteps);
-    
-    debugLog("Parsing TD-DFT data for " + std::to_string(expectedSteps) + " steps");
-    
-    int currentStep = 0;
-    std::string line;
+int AmespParser::scoreContent(std::string_view head) const {
+    // 程序横幅可以直接确定格式；截断的输出只能依靠各段落标记
+    if (string_utils::contains(head, "Amesp")) {
+        return 100;
+    }
     
-    while (std::getline(file, line) && currentStep < expectedSteps) {
-        // 查找TD-DFT块的开始标记
-        if (line.find("========= Excitation energies and oscillator strengths =========") != std::string::npos) {
-            debugLog("Found TD-DFT section for step " + std::to_string(currentStep + 1));
-            
-            // 先查找这个步骤对应的E[Eexc]值
-            double eExcValue = 0.0;
-            std::streampos currentPos = file.tellg();
-            
-            // 向前查找E[Eexc]值
-            while (std::getline(file, line)) {
-                if (line.find("E[Eexc]") != std::string::npos) {
-                    size_t pos = line.find("=");
-                    if (pos != std::string::npos) {
-                        std::string energyStr = string_utils::trim(line.substr(pos + 1));
-                        eExcValue = string_utils::toDouble(energyStr);
-                        debugLog("Found E[Eexc] for step " + std::to_string(currentStep + 1) + ": " + std::to_string(eExcValue));
-                        break;
-                    }
-                }
-                // 如果遇到下一个TD-DFT块或其他标记，停止搜索
-                if (line.find("========= Excitation energies and oscillator strengths =========") != std::string::npos ||
-                    line.find("Geom Opt Step:") != std::string::npos) {
-                    break;
-                }
-            }
-            
-            // 重置到TD-DFT块开始位置
-            file.clear();
-            file.seekg(currentPos);
-            
-            // 解析这个TD-DFT块，传入E[Eexc]值
-            data.tddftData[currentStep] = parseTDDFTSection(file, eExcValue);
-            data.tddftData[currentStep].hasData = !data.tddftData[currentStep].excitedStates.empty();
-            
-            if (data.tddftData[currentStep].hasData) {
-                debugLog("Parsed " + std::to_string(data.tddftData[currentStep].excitedStates.size()) + 
-                        " excited states for step " + std::to_string(currentStep + 1));
-            }
-            
-            currentStep++;
+    int score = 0;
+    for (std::string_view marker : {"Geom Opt Step:", "Current Geometry(angstroms):", "E[DFT]", "Final Energy:"}) {
+        if (string_utils::contains(head, marker)) {
+            score += 20;
         }
     }
-    
-    debugLog("TD-DFT parsing completed, processed " + std::to_string(currentStep) + " steps");
-    return currentStep > 0;
+    return score;
 }
 
-data::TDDFTData AmespParser::parseTDDFTSection(std::ifstream& file, double eExcValue) {
-    data::TDDFTData tddftData;
+bool AmespParser::isJobFinished(std::string_view content) const {
+    return string_utils::contains(content, "Normal Termination of Amesp");
+}
+
+bool AmespParser::parseFollowedStep(std::istream& block, const std::string& markerLine,
+                                    data::OptStep& step, data::TDDFTData& tddft) {
+    // 用同一个状态机解析这一个步骤块；块内的TD-DFT结果属于这一步
+    data::ParsedData blockData;
+    StateMachine machine(*this, blockData, false);
+    machine.feed(markerLine);
     std::string line;
-    
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
-        // 检查是否是激发态开始行
-        if (line.find("State") != std::string::npos && line.find(":") != std::string::npos && 
-            line.find("E =") != std::string::npos) {
-            
-            data::ExcitedState excitedState = parseExcitedState(file, line, eExcValue);
-            if (excitedState.stateNumber > 0) {
-                tddftData.excitedStates.push_back(excitedState);
-                debugLog("Parsed excited state " + std::to_string(excitedState.stateNumber));
-            }
-        }
-        
-        // 检查是否到达TD-DFT块结束
-        if (line.find("Time of TDDFT") != std::string::npos || 
-            line.find("================================================================") != std::string::npos) {
-            break;
-        }
+    while (std::getline(block, line)) {
+        machine.feed(line);
     }
-    
-    return tddftData;
-}
+    machine.finish();
 
-data::ExcitedState AmespParser::parseExcitedState(std::ifstream& file, const std::string& stateLine, double eExcValue) {
-    data::ExcitedState excitedState;
-    
-    // 解析状态行：State    1 : E =    7.1627 eV     173.097 nm      57770.95 cm-1
-    std::istringstream iss(stateLine);
-    std::string dummy;
-    if (iss >> dummy >> excitedState.stateNumber >> dummy >> dummy >> dummy >> excitedState.excitationEnergy_eV 
-        >> dummy >> excitedState.wavelength_nm >> dummy) {
-        
-        debugLog("Parsing excited state " + std::to_string(excitedState.stateNumber) + 
-                ", E = " + std::to_string(excitedState.excitationEnergy_eV) + " eV");
-        
-        // 设置默认对称性（AMESP输出中没有明确的对称性信息）
-        excitedState.symmetry = "Singlet-A";
-        
-        // 解析轨道跃迁和其他信息
-        std::string line;
-        while (std::getline(file, line)) {
-            line = string_utils::trim(line);
-            
-            // 空行可能表示激发态结束
-            if (line.empty()) {
-                break;
-            }
-            
-            // 解析轨道跃迁：11 -->   13      0.5002429 或 10 <--   12     -0.5002429
-            if (line.find("-->") != std::string::npos || line.find("<--") != std::string::npos) {
-                std::istringstream transIss(line);
-                int fromOrb, toOrb;
-                std::string arrow;
-                double coeff;
-                
-                if (transIss >> fromOrb >> arrow >> toOrb >> coeff) {
-                    data::OrbitalTransition transition;
-                    transition.fromOrb = fromOrb;
-                    transition.toOrb = toOrb;
-                    transition.coefficient = coeff; // 保持原始系数，包括负号
-                    transition.isForward = (arrow == "-->"); // --> 为true，<-- 为false
-                    excitedState.transitions.push_back(transition);
-                    
-                    debugLog("  Transition: " + std::to_string(fromOrb) + " " + arrow + " " + 
-                            std::to_string(toOrb) + " (" + std::to_string(coeff) + ")");
-                }
-            }
-            
-            // 解析E(TD)行：E(TD) =   -188.290813700      <S**2>= 0.000     f=  0.0000
-            // 或者：E(TDA-aTB) =   -188.290813700      <S**2>= 0.000     f=  0.0000
-            else if (line.find("E(TD)") != std::string::npos || line.find("E(TDA-aTB)") != std::string::npos) {
-                std::istringstream etdIss(line);
-                std::string etd, eq;
-                double totalEnergy;
-                
-                if (etdIss >> etd >> eq >> totalEnergy) {
-                    // 检查是否为追踪态 (E(TD) = E[Eexc])
-                    const double tolerance = 1e-9; // 浮点数比较容差
-                    bool isTrackedState = (std::abs(totalEnergy - eExcValue) < tolerance);
-                    
-                    if (isTrackedState) {
-                        excitedState.hasOptimizationInfo = true;
-                        excitedState.hasTotalEnergy = true;
-                        excitedState.totalEnergy = totalEnergy;
-                        excitedState.additionalInfo = "Copying the excited state density for this state as the 1-particle RhoCI density.";
-                        
-                        debugLog("  This is the tracked state (E(TD)/E(TDA-aTB) = E[Eexc])");
-                    }
-                    
-                    // 查找<S**2>值
-                    size_t s2Pos = line.find("<S**2>=");
-                    if (s2Pos != std::string::npos) {
-                        std::string s2Str = line.substr(s2Pos + 7);
-                        size_t spacePos = s2Str.find(' ');
-                        if (spacePos != std::string::npos) {
-                            excitedState.s2Value = string_utils::toDouble(s2Str.substr(0, spacePos));
-                        }
-                    }
-                    
-                    // 查找振荡强度f值
-                    size_t fPos = line.find("f=");
-                    if (fPos != std::string::npos) {
-                        std::string fStr = line.substr(fPos + 2);
-                        excitedState.oscillatorStrength = string_utils::toDouble(string_utils::trim(fStr));
-                    }
-                    
-                    debugLog("  Total energy: " + std::to_string(totalEnergy) + 
-                            ", <S**2>: " + std::to_string(excitedState.s2Value) +
-                            ", f: " + std::to_string(excitedState.oscillatorStrength) +
-                            ", tracked: " + (isTrackedState ? "Yes" : "No"));
-                }
-                break; // E(TD)或E(TDA-aTB)行通常是激发态的最后一行
-            }
-            
-            // 如果遇到下一个State行，停止解析当前激发态
-            else if (line.find("State") != std::string::npos && line.find(":") != std::string::npos) {
-                // 将文件指针回退到这一行的开始
-                std::streampos currentPos = file.tellg();
-                file.seekg(currentPos - static_cast<std::streampos>(line.length() + 1));
-                break;
-            }
-        }
+    if (blockData.optSteps.empty()) {
+        return false;
     }
-    
-    return excitedState;
+    step = blockData.optSteps.step(0);
+    if (!machine.tddftBlocks().empty()) {
+        tddft = std::move(machine.tddftBlocks().front());
+    }
+    return true;
 }
 
 } // namespace parsers
-} // namespace fakeg 
\ No newline at end of file
+} // namespace fakeg
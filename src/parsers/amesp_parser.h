@@ -8,8 +8,6 @@ namespace parsers {
 
 class AmespParser : public ParserInterface {
 public:
-    AmespParser();
-    
     // 实现接口方法
     bool parse(io::FileReader& reader, data::ParsedData& data) override;
     bool validateInput(const std::string& filename) override;
@@ -17,27 +15,19 @@ public:
     std::string getParserName() const override;
     std::string getParserVersion() const override;
     std::vector<std::string> getSupportedKeywords() const override;
+    int scoreContent(std::string_view head) const override;
+    bool supportsStreaming() const override { return true; }
+    bool isJobFinished(std::string_view content) const override;
+
+protected:
+    std::string_view followStepMarker() const override { return "Geom Opt Step:"; }
+    bool parseFollowedStep(std::istream& block, const std::string& markerLine,
+                           data::OptStep& step, data::TDDFTData& tddft) override;
 
 private:
-    // 解析主要方法
-    bool parseOptimizationSteps(std::ifstream& file, data::ParsedData& data);
-    bool parseSinglePoint(std::ifstream& file, data::ParsedData& data);
-    bool parseFrequencies(std::ifstream& file, data::ParsedData& data);
-    bool parseThermoData(std::ifstream& file, data::ParsedData& data);
-    bool parseTDDFT(std::ifstream& file, data::ParsedData& data);
-    
-    // 解析辅助方法
-    void parseGeometry(std::ifstream& file, std::vector<data::Atom>& atoms);
-    double parseEnergyFromCurrentPosition(std::ifstream& file);
-    void parseConvergence(std::ifstream& file, data::OptStep& step);
-    void parseNormalModes(std::ifstream& file, data::ParsedData& data);
-    data::TDDFTData parseTDDFTSection(std::ifstream& file, double eExcValue);
-    data::ExcitedState parseExcitedState(std::ifstream& file, const std::string& stateLine, double eExcValue);
-    
-    // 查找辅助方法
-    bool findOptimizationSection(std::ifstream& file);
-    bool findFrequencySection(std::ifstream& file);
-    bool findThermoSection(std::ifstream& file);
+    // 逐行消费输入的状态机（定义在 amesp_parser.cpp）：每一行只看一次，
+    // 识别出的几何、能量、收敛、激发态、频率、热力学等段落直接写入对应的 ParsedData 成员
+    class StateMachine;
 };
 
 } // namespace parsers
@@ -0,0 +1,107 @@
+#include "auto_detect_parser.h"
+
+namespace fakeg {
+namespace parsers {
+
+AutoDetectParser::AutoDetectParser() : registry(ParserRegistry::builtin()), threadCount(0) {}
+
+AutoDetectParser::AutoDetectParser(ParserRegistry registry) : registry(std::move(registry)), threadCount(0) {}
+
+bool AutoDetectParser::detect(std::string_view head, const std::string& filename) {
+    delegate.reset();
+    detectedFormat.clear();
+    detectedParserId.clear();
+
+    ParserRegistry::Candidate best{"", 0};
+    delegate = registry.detect(head, &best);
+    if (!delegate) {
+        errorLog("Cannot determine the format of " + filename);
+        return false;
+    }
+
+    detectedFormat = best.name;
+    detectedParserId = delegate->getParserId();
+    delegate->setLogger(logger);
+    delegate->setThreadCount(threadCount);
+    infoLog("Detected format: " + detectedFormat);
+
+    if (isDebugEnabled()) {
+        for (const auto& candidate : registry.score(head)) {
+            debugLog("Format score " + candidate.name + ": " + std::to_string(candidate.score));
+        }
+    }
+    return true;
+}
+
+bool AutoDetectParser::validateInput(const std::string& filename) {
+    std::string head;
+    if (!ParserRegistry::readHead(filename, head)) {
+        errorLog("Cannot open file: " + filename);
+        return false;
+    }
+
+    return detect(head, filename) && delegate->validateInput(filename);
+}
+
+bool AutoDetectParser::validateContent(io::FileReader& reader) {
+    // 在解析前选定解析器，是否流式输出取决于它
+    return detect(reader.head(), reader.getFilename());
+}
+
+bool AutoDetectParser::parse(io::FileReader& reader, data::ParsedData& data) {
+    // 没有经过 validateInput/validateContent 时直接用已打开内容的开头识别
+    if (!delegate && !detect(reader.head(), reader.getFilename())) {
+        return false;
+    }
+
+    delegate->setStepSink(stepSink);
+    const bool parsed = delegate->parse(reader, data);
+    
+    // 下一个文件需要重新识别
+    delegate.reset();
+    return parsed;
+}
+
+std::string AutoDetectParser::getParserName() const {
+    return "AutoDetectParser";
+}
+
+std::string AutoDetectParser::getParserVersion() const {
+    return "1.0.0";
+}
+
+std::string AutoDetectParser::getParserId() const {
+    return detectedParserId.empty() ? ParserInterface::getParserId() : detectedParserId;
+}
+
+bool AutoDetectParser::supportsStreaming() const {
+    return delegate && delegate->supportsStreaming();
+}
+
+void AutoDetectParser::setThreadCount(size_t threads) {
+    threadCount = threads;
+    if (delegate) {
+        delegate->setThreadCount(threads);
+    }
+}
+
+bool AutoDetectParser::supportsFollow() const {
+    return delegate && delegate->supportsFollow();
+}
+
+bool AutoDetectParser::parseAppendedSteps(std::string_view content, size_t keepBlocks, data::ParsedData& data,
+                                          data::StepSink& sink, size_t& consumed) {
+    consumed = 0;
+    return delegate && delegate->parseAppendedSteps(content, keepBlocks, data, sink, consumed);
+}
+
+bool AutoDetectParser::isJobFinished(std::string_view content) const {
+    return delegate && delegate->isJobFinished(content);
+}
+
+const std::string& AutoDetectParser::getDetectedFormat() const {
+    return detectedFormat;
+}
+
+} // namespace parsers
+} // namespace fakeg
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "parser_interface.h"
+#include "parser_registry.h"
+
+namespace fakeg {
+namespace parsers {
+
+// 自动识别格式的解析器
+//
+// validateInput 时读取文件开头（标准输入在 validateContent 时用已读入的开头），
+// 用注册表选出最匹配的解析器，之后的解析全部转交给它。
+// 每个输入文件解析完后都会丢弃所选解析器，因此同一实例可以依次处理不同格式的文件。
+class AutoDetectParser : public ParserInterface {
+public:
+    AutoDetectParser();
+    explicit AutoDetectParser(ParserRegistry registry);
+
+    bool parse(io::FileReader& reader, data::ParsedData& data) override;
+    bool validateInput(const std::string& filename) override;
+    bool validateContent(io::FileReader& reader) override;
+
+    std::string getParserName() const override;
+    std::string getParserVersion() const override;
+    std::string getParserId() const override;  // 识别后为所选解析器的标识，解析完后保留到下次识别
+    bool supportsStreaming() const override;
+    void setThreadCount(size_t threads) override;
+    bool supportsFollow() const override;
+    bool parseAppendedSteps(std::string_view content, size_t keepBlocks, data::ParsedData& data,
+                            data::StepSink& sink, size_t& consumed) override;
+    bool isJobFinished(std::string_view content) const override;
+
+    // 最近一次识别出的格式名称（未识别时为空）
+    const std::string& getDetectedFormat() const;
+
+private:
+    bool detect(std::string_view head, const std::string& filename);
+
+    ParserRegistry registry;
+    std::unique_ptr<ParserInterface> delegate;
+    std::string detectedFormat;
+    std::string detectedParserId;
+    size_t threadCount;  // 识别出格式后转交给所选解析器
+};
+
+} // namespace parsers
+} // namespace fakeg
@@ -1,658 +1,713 @@
 #include "bdf_parser.h"
 #include "../string/string_utils.h"
+#include "../string/fixed_tokenizer.h"
+#include "../string/multi_pattern_scanner.h"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <utility>
 
 namespace fakeg {
 namespace parsers {
 
-BdfParser::BdfParser() = default;
+namespace {
 
-bool BdfParser::parse(io::FileReader& reader, data::ParsedData& data) {
-    std::ifstream& file = reader.getStream();
-    
-    infoLog("Starting BDF file parsing");
-    
-    // 检查是否是优化计算
-    string_utils::LineProcessor::resetToBeginning(file);
-    if (findOptimizationSection(file)) {
-        data.hasOpt = true;
-        infoLog("Found geometry optimization");
-        if (!parseOptimizationSteps(file, data)) {
-            errorLog("Optimization steps parsing failed");
-            return false;
-        }
-        infoLog("Total optimization steps: " + std::to_string(data.optSteps.size()));
-    } else {
-        // 单点计算
-        infoLog("Single point calculation detected");
-        if (!parseSinglePoint(file, data)) {
-            errorLog("Single point calculation parsing failed");
-            return false;
-        }
-    }
-    
-    // 解析频率
-    if (parseFrequencies(file, data)) {
-        data.hasFreq = true;
-        infoLog("Frequency parsing completed");
-    }
-    
-    // 解析热力学数据
-    if (parseThermoData(file, data)) {
-        infoLog("Thermodynamic data parsing completed");
+// 状态机识别的行标记（顺序与 markerScanner 中的注册顺序一致）
+enum Marker : uint32_t {
+    MARKER_OPT_SECTION,
+    MARKER_OPT_STEP,
+    MARKER_ATOM_COORD,
+    MARKER_STATE,
+    MARKER_ENERGY,
+    MARKER_FORCE_RMS,
+    MARKER_CURRENT_VALUES,
+    MARKER_VIBRATIONS,
+    MARKER_VIBRATIONS_HEADER,
+    MARKER_HESSIAN,
+    MARKER_TRANSLATIONS,
+    MARKER_THERMO,
+    MARKER_THERMO_END,
+};
+
+const string_utils::MultiPatternScanner& markerScanner() {
+    static const string_utils::MultiPatternScanner scanner({
+        "Geometry Optimization step",
+        "Geometry Optimization step :",
+        "Atom         Coord",
+        "State=",
+        "Energy=",
+        "Force-RMS",
+        "Current values",
+        "Results of vibrations",
+        "Results of vibrations:",
+        "Start analytical Hessian",
+        "Results of translations",
+        "Thermal Contributions to Energies",
+        "UniMoVib job terminated",
+    });
+    return scanner;
+}
+
+// 一行中出现的标记（一次自动机扫描得到，之后各段落的判断只查位）
+class LineMarkers {
+public:
+    explicit LineMarkers(std::string_view line) : bits_(0) {
+        markerScanner().scan(line, [this](size_t id, size_t) {
+            bits_ |= 1u << id;
+            return true;
+        });
     }
-    
-    return !data.optSteps.empty();
+
+    bool has(Marker marker) const { return (bits_ & (1u << marker)) != 0; }
+
+private:
+    uint32_t bits_;
+};
+
+// "State= 1   Energy=  -115.001" 这类行中 Energy= 之后的数值
+double parseEnergyAfterMarker(std::string_view line) {
+    const size_t pos = line.find("Energy=");
+    return string_utils::toDouble(string_utils::trimView(line.substr(pos + 7)), 0.0);
 }
 
-bool BdfParser::validateInput(const std::string& filename) {
-    // 只检查文件是否存在，不检查扩展名
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        errorLog("Cannot open file: " + filename);
+// 从第 first 个字段开始依次读取 RMS梯度、最大梯度、RMS步长、最大步长，四个都读到时才写入 step
+bool parseConvergenceValues(std::string_view line, size_t first, data::OptStep& step) {
+    const string_utils::FixedTokenizer<7> fields(line);
+    double rmsGrad, maxGrad, rmsStep, maxStep;
+    if (!fields.get(first, rmsGrad) || !fields.get(first + 1, maxGrad) ||
+        !fields.get(first + 2, rmsStep) || !fields.get(first + 3, maxStep)) {
         return false;
     }
-    
-    // 用户指定的文件就是想要转换的文件，不需要额外验证
+    step.rmsGrad = rmsGrad;
+    step.maxGrad = maxGrad;
+    step.rmsStep = rmsStep;
+    step.maxStep = maxStep;
     return true;
 }
 
-std::string BdfParser::getParserName() const {
-    return "BdfParser";
+// "Electronic total energy   :   -1.170752   Hartree" 这类行中冒号后的第一个数值
+bool parseValueAfterColon(std::string_view line, double& value) {
+    size_t pos = line.find(':');
+    return pos != std::string_view::npos && string_utils::parseNumber(string_utils::nextToken(line, ++pos), value);
 }
 
-std::string BdfParser::getParserVersion() const {
-    return "1.1.0";
+// "  Maximum Delta-X   0.000060   0.004000   Yes" 这类收敛判据行的数值（第三个字段），
+// 后面还应有阈值和是否收敛两列
+bool parseCriterionValue(std::string_view line, double& value) {
+    const string_utils::FixedTokenizer<5> fields(line);
+    double tolerance;
+    return fields.size() == 5 && fields.get(2, value) && fields.get(3, tolerance);
 }
 
-std::vector<std::string> BdfParser::getSupportedKeywords() const {
-    return {"Geometry Optimization step", "Results of vibrations", "Thermal Contributions to Energies", "Atom         Coord"};
-}
+} // namespace
 
-bool BdfParser::findOptimizationSection(std::ifstream& file) {
-    return string_utils::LineProcessor::findLine(file, "Geometry Optimization step");
-}
+// 单遍解析BDF输出的状态机
+//
+// 每一行先用多模式扫描器找出其中的段落标记，再交给各段落的子状态机：
+// - 优化步骤：从 "Geometry Optimization step :" 行到下一个步骤标记（或文件末尾）为一个步骤块，
+//   块内依次是坐标、能量和 "Current values" 收敛值，块结束时有原子的步骤通过 emitStep 提交
+// - 单点计算：第一个坐标块及其后的能量，只在整个文件没有优化标记时使用
+// - 频率：“Results of vibrations:” 之后的各频率块，位移按最后一个步骤的原子数读取
+// - 热力学：“Thermal Contributions to Energies” 之后到 UniMoVib 结束标记为止
+class BdfParser::StateMachine {
+public:
+    // emit 为false时步骤直接追加到 data.optSteps（跟踪模式解析单个步骤块时使用）
+    StateMachine(BdfParser& parser, data::ParsedData& data, bool emit);
 
-bool BdfParser::findFrequencySection(std::ifstream& file) {
-    return string_utils::LineProcessor::findLine(file, "Results of vibrations:");
-}
+    void feed(std::string_view line);
+    // 输入结束：提交最后一个步骤块
+    void finish();
+
+    bool foundOptimization() const { return optimization; }
+    bool foundFrequencies() const { return frequencyPhase != FrequencyPhase::Idle; }
+
+    // 提交单点计算的步骤，没有坐标时返回false
+    bool takeSinglePoint();
+
+private:
+    // 一个步骤块的解析进度（几何、能量、收敛值依次查找）
+    struct StepProgress {
+        enum class Phase { Search, Atoms, Energy, Convergence, ConvergenceNextLine, Done };
+
+        data::OptStep step;
+        bool active = false;
+        bool hasConvergence = false;  // 单点计算没有收敛值
+        bool foundConvergence = false;
+        Phase phase = Phase::Search;
+    };
+
+    void beginStep(std::string_view markerLine);
+    void feedStep(StepProgress& progress, std::string_view line, const LineMarkers& markers);
+    void endGeometry(StepProgress& progress);
+    void closeStep();
+    void parseAtom(std::string_view line, data::OptStep& step);
 
-bool BdfParser::findThermoSection(std::ifstream& file) {
-    return string_utils::LineProcessor::findLine(file, "Thermal Contributions to Energies");
+    void feedFrequency(std::string_view line, const LineMarkers& markers);
+    void beginFrequencyModes(const std::string& irLine);
+    int currentAtomCount() const;
+
+    void feedThermo(std::string_view line);
+
+    BdfParser& parser;
+    data::ParsedData& data;
+    const bool emit;
+    bool sinkFailed;
+
+    // 优化步骤和单点计算
+    bool optimization;
+    StepProgress current;
+    StepProgress singlePoint;
+
+    // 频率块：表头行（模式编号）、Irreps、频率、简约质量、力常数、IR强度、位移表
+    enum class FrequencyPhase {
+        Idle, Header, Scan, Irreps, Frequencies, SkipLines, Intensities,
+        DisplacementHeader, Displacements, BlankLine, Done
+    };
+    FrequencyPhase frequencyPhase;
+    int skipLines;
+    int blockFreqs;
+    int blockStart;
+    int blockAtoms;
+    int rowsLeft;
+    std::vector<std::string> irreps;
+    std::vector<double> freqValues;
+
+    enum class ThermoPhase { Idle, Active, Done };
+    ThermoPhase thermoPhase;
+};
+
+BdfParser::StateMachine::StateMachine(BdfParser& parser, data::ParsedData& data, bool emit)
+    : parser(parser), data(data), emit(emit), sinkFailed(false), optimization(false),
+      frequencyPhase(FrequencyPhase::Idle), skipLines(0), blockFreqs(0), blockStart(0), blockAtoms(0), rowsLeft(0),
+      thermoPhase(ThermoPhase::Idle) {
+    singlePoint.active = true;
+    singlePoint.step.stepNumber = 1;
+    singlePoint.step.converged = true;
 }
 
-bool BdfParser::parseOptimizationSteps(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        if (string_utils::contains(line, "Geometry Optimization step :")) {
-            data::OptStep step;
-            step.energy = 0.0;
-            step.rmsGrad = step.maxGrad = step.rmsStep = step.maxStep = 0.0;
-            step.converged = false;
-            
-            // 提取步骤编号
-            size_t pos = line.find(":");
-            if (pos != std::string::npos) {
-                std::string stepStr = string_utils::trim(line.substr(pos + 1));
-                step.stepNumber = string_utils::toInt(stepStr, 1);
-                debugLog("Processing optimization step " + std::to_string(step.stepNumber));
-            }
-            
-            // 解析几何
-            parseGeometryStep(file, step);
-            
-            // 解析收敛
-            parseConvergence(file, step);
-            
-            if (!step.atoms.empty()) {
-                data.optSteps.push_back(step);
-                debugLog("Added step " + std::to_string(step.stepNumber) + ", containing " + 
-                        std::to_string(step.atoms.size()) + " atoms, energy = " + std::to_string(step.energy));
+void BdfParser::StateMachine::feed(std::string_view line) {
+    const LineMarkers markers(line);
+
+    if (markers.has(MARKER_OPT_SECTION)) {
+        optimization = true;
+    }
+    if (markers.has(MARKER_OPT_STEP)) {
+        closeStep();
+        beginStep(line);
+    } else if (current.active) {
+        feedStep(current, line, markers);
+    }
+
+    // 出现优化标记后单点计算的结果不再使用
+    if (!optimization && singlePoint.active) {
+        feedStep(singlePoint, line, markers);
+    }
+
+    if (frequencyPhase != FrequencyPhase::Done) {
+        feedFrequency(line, markers);
+    }
+
+    if (thermoPhase == ThermoPhase::Idle && markers.has(MARKER_THERMO)) {
+        thermoPhase = ThermoPhase::Active;
+        data.thermoData.hasData = true;
+        parser.debugLog("Found thermodynamic data");
+    } else if (thermoPhase == ThermoPhase::Active) {
+        const std::string_view text = string_utils::trimView(line);
+        feedThermo(text);
+        // 当到达下一个主要部分时停止 - 使用更具体的标记
+        if (markers.has(MARKER_THERMO_END)) {
+            if (parser.isDebugEnabled()) {
+                parser.debugLog("Reached end of thermodynamic section: " + std::string(text));
             }
+            thermoPhase = ThermoPhase::Done;
         }
     }
-    
-    return !data.optSteps.empty();
 }
 
-bool BdfParser::parseSinglePoint(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    data::OptStep step;
-    step.stepNumber = 1;
-    step.converged = true;
-    
-    parseGeometryStep(file, step);
-    
-    if (!step.atoms.empty()) {
-        data.optSteps.push_back(step);
-        return true;
+void BdfParser::StateMachine::finish() {
+    closeStep();
+}
+
+bool BdfParser::StateMachine::takeSinglePoint() {
+    if (singlePoint.phase == StepProgress::Phase::Search) {
+        parser.debugLog("Warning: Step 1 could not find Atom Coord section");
+        return false;
     }
-    
-    return false;
+    if (singlePoint.step.atoms.empty()) {
+        return false;
+    }
+    return parser.emitStep(data, singlePoint.step);
 }
 
-void BdfParser::parseGeometryStep(std::ifstream& file, data::OptStep& step) {
-    std::string line;
-    
-    // 查找 "Atom         Coord" 部分
-    if (!string_utils::LineProcessor::findLine(file, "Atom         Coord")) {
-        debugLog("Warning: Step " + std::to_string(step.stepNumber) + " could not find Atom Coord section");
-        return;
+void BdfParser::StateMachine::beginStep(std::string_view markerLine) {
+    current = StepProgress();
+    current.active = true;
+    current.hasConvergence = true;
+
+    // 提取步骤编号
+    const size_t pos = markerLine.find(':');
+    if (pos != std::string_view::npos) {
+        current.step.stepNumber = string_utils::toInt(string_utils::trimView(markerLine.substr(pos + 1)), 1);
+        parser.debugLog("Processing optimization step " + std::to_string(current.step.stepNumber));
     }
-    
-    // 读取原子直到遇到 State= 或 Energy= 或空行
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
-        if (line.empty() || string_utils::contains(line, "State=")) {
+}
+
+void BdfParser::StateMachine::feedStep(StepProgress& progress, std::string_view line, const LineMarkers& markers) {
+    using Phase = StepProgress::Phase;
+    data::OptStep& step = progress.step;
+
+    switch (progress.phase) {
+        case Phase::Search:
+            // 查找 "Atom         Coord" 部分
+            if (markers.has(MARKER_ATOM_COORD)) {
+                progress.phase = Phase::Atoms;
+            }
             break;
-        }
-        
-        if (string_utils::contains(line, "Energy=")) {
-            // 从此行解析能量
-            size_t pos = line.find("Energy=");
-            std::string energyStr = line.substr(pos + 7);
-            step.energy = string_utils::toDouble(string_utils::trim(energyStr), 0.0);
+        case Phase::Atoms: {
+            // 读取原子直到遇到 State= 或 Energy= 或空行
+            if (string_utils::trimView(line).empty() || markers.has(MARKER_STATE)) {
+                endGeometry(progress);
+            } else if (markers.has(MARKER_ENERGY)) {
+                // 从此行解析能量
+                step.energy = parseEnergyAfterMarker(line);
+                endGeometry(progress);
+            } else {
+                parseAtom(line, step);
+            }
             break;
         }
-        
-        // 解析原子行: Element X Y Z
-        std::istringstream iss(line);
-        std::string element;
-        double x, y, z;
-        
-        if (iss >> element >> x >> y >> z) {
-            data::Atom atom;
-            atom.symbol = element;
-            atom.atomicNumber = elementMap->getAtomicNumber(element);
-            atom.x = x;
-            atom.y = y;
-            atom.z = z;
-            step.atoms.push_back(atom);
-            
-            debugLog("Step " + std::to_string(step.stepNumber) + " - Reading atom: " + element + 
-                    " (" + std::to_string(atom.atomicNumber) + ") at (" + 
-                    std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
-        }
-    }
-    
-    // 如果从坐标部分没有获得能量，继续查找
-    if (step.energy == 0.0) {
-        while (std::getline(file, line)) {
-            if (string_utils::contains(line, "Energy=")) {
-                size_t pos = line.find("Energy=");
-                std::string energyStr = line.substr(pos + 7);
-                step.energy = string_utils::toDouble(string_utils::trim(energyStr), 0.0);
-                break;
+        case Phase::Energy:
+            // 坐标部分没有给出能量时继续查找，遇到下一个部分就停止
+            if (markers.has(MARKER_ENERGY)) {
+                step.energy = parseEnergyAfterMarker(line);
+                progress.phase = progress.hasConvergence ? Phase::Convergence : Phase::Done;
+            } else if (markers.has(MARKER_FORCE_RMS) || markers.has(MARKER_OPT_SECTION)) {
+                progress.phase = progress.hasConvergence ? Phase::Convergence : Phase::Done;
             }
-            // 如果遇到下一个部分就停止
-            if (string_utils::contains(line, "Force-RMS") || 
-                string_utils::contains(line, "Geometry Optimization step")) {
-                break;
+            break;
+        case Phase::Convergence: {
+            // 查找当前几何后的收敛值
+            if (markers.has(MARKER_CURRENT_VALUES)) {
+                // 从同一行（跳过 "Current values  :"）或下一行解析值
+                if (parseConvergenceValues(line, 3, step)) {
+                    progress.foundConvergence = true;
+                    progress.phase = Phase::Done;
+                    parser.debugLog("Step " + std::to_string(step.stepNumber) + " converged: RMS Grad=" + std::to_string(step.rmsGrad) +
+                                    ", Max Grad=" + std::to_string(step.maxGrad) + ", RMS Step=" + std::to_string(step.rmsStep) +
+                                    ", Max Step=" + std::to_string(step.maxStep));
+                } else {
+                    // 值可能在下一行
+                    progress.phase = Phase::ConvergenceNextLine;
+                }
+            } else if (markers.has(MARKER_OPT_SECTION) || markers.has(MARKER_VIBRATIONS) || markers.has(MARKER_HESSIAN)) {
+                // 只在遇到下一个优化步骤或频率分析时停止
+                progress.phase = Phase::Done;
             }
+            break;
         }
-    }
-}
-
-void BdfParser::parseConvergence(std::ifstream& file, data::OptStep& step) {
-    std::string line;
-    bool foundConvergence = false;
-    
-    // 查找当前几何后的收敛值
-    while (std::getline(file, line)) {
-        if (string_utils::contains(line, "Current values")) {
-            // 从同一行或下一行解析值
-            std::istringstream iss(line);
-            std::string dummy;
-            
-            // 跳过 "Current values  :"
-            iss >> dummy >> dummy >> dummy;
-            
-            if (iss >> step.rmsGrad >> step.maxGrad >> step.rmsStep >> step.maxStep) {
-                foundConvergence = true;
-                debugLog("Step " + std::to_string(step.stepNumber) + " converged: RMS Grad=" + std::to_string(step.rmsGrad) + 
-                        ", Max Grad=" + std::to_string(step.maxGrad) + ", RMS Step=" + std::to_string(step.rmsStep) + 
-                        ", Max Step=" + std::to_string(step.maxStep));
-            } else {
-                // 值可能在下一行
-                if (std::getline(file, line)) {
-                    std::istringstream iss2(line);
-                    if (iss2 >> step.rmsGrad >> step.maxGrad >> step.rmsStep >> step.maxStep) {
-                        foundConvergence = true;
-                        debugLog("Step " + std::to_string(step.stepNumber) + " converged (next line): RMS Grad=" + std::to_string(step.rmsGrad) + 
-                                ", Max Grad=" + std::to_string(step.maxGrad) + ", RMS Step=" + std::to_string(step.rmsStep) + 
+        case Phase::ConvergenceNextLine: {
+            if (parseConvergenceValues(line, 0, step)) {
+                progress.foundConvergence = true;
+                parser.debugLog("Step " + std::to_string(step.stepNumber) + " converged (next line): RMS Grad=" + std::to_string(step.rmsGrad) +
+                                ", Max Grad=" + std::to_string(step.maxGrad) + ", RMS Step=" + std::to_string(step.rmsStep) +
                                 ", Max Step=" + std::to_string(step.maxStep));
-                    }
-                }
             }
+            progress.phase = Phase::Done;
             break;
         }
-        
-        // 只在遇到下一个优化步骤或频率分析时停止
-        if (string_utils::contains(line, "Geometry Optimization step") ||
-            string_utils::contains(line, "Results of vibrations") ||
-            string_utils::contains(line, "Start analytical Hessian")) {
+        case Phase::Done:
             break;
-        }
     }
-    
-    if (!foundConvergence) {
-        debugLog("Warning: Step " + std::to_string(step.stepNumber) + " did not find convergence data");
+}
+
+void BdfParser::StateMachine::endGeometry(StepProgress& progress) {
+    using Phase = StepProgress::Phase;
+
+    // 如果从坐标部分没有获得能量，继续查找
+    if (progress.step.energy == 0.0) {
+        progress.phase = Phase::Energy;
+    } else {
+        progress.phase = progress.hasConvergence ? Phase::Convergence : Phase::Done;
     }
-    
-    // 检查此步骤是否收敛
-    step.converged = (step.rmsGrad < 3.0e-4 && step.maxGrad < 4.5e-4 && 
-                     step.rmsStep < 1.2e-3 && step.maxStep < 1.8e-3);
 }
 
-bool BdfParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
-    
-    if (!findFrequencySection(file)) {
-        debugLog("Frequency analysis not found");
-        return false;
+void BdfParser::StateMachine::closeStep() {
+    if (!current.active) {
+        return;
     }
-    
-    debugLog("Found frequency analysis");
-    
-    // 跳过表头行
-    std::string line;
-    std::getline(file, line); // Normal frequencies line
-    std::getline(file, line); // blank line
-    
-    while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
-        if (string_utils::contains(line, "Results of translations")) {
-            break;
-        }
-        
-        // 查找频率块表头（类似 1, 2, 3 这样的数字）
-        if (!line.empty() && std::isdigit(line[0])) {
-            int nFreqs = countFrequenciesInLine(line);
-            if (nFreqs > 0) {
-                parseFrequencyBlock(file, nFreqs, data);
-            }
+    current.active = false;
+    data::OptStep& step = current.step;
+
+    if (!current.foundConvergence) {
+        parser.debugLog("Warning: Step " + std::to_string(step.stepNumber) + " did not find convergence data");
+    }
+
+    // 检查此步骤是否收敛
+    step.converged = (step.rmsGrad < 3.0e-4 && step.maxGrad < 4.5e-4 &&
+                      step.rmsStep < 1.2e-3 && step.maxStep < 1.8e-3);
+
+    if (step.atoms.empty()) {
+        if (current.phase == StepProgress::Phase::Search) {
+            parser.debugLog("Warning: Step " + std::to_string(step.stepNumber) + " could not find Atom Coord section");
         }
+        return;
+    }
+    if (!emit) {
+        data.optSteps.append(step);
+        return;
+    }
+    // sink失败后不再提交后续步骤
+    if (sinkFailed) {
+        return;
+    }
+
+    if (!parser.emitStep(data, step)) {
+        sinkFailed = true;
+        return;
+    }
+    if (parser.isDebugEnabled()) {
+        parser.debugLog("Added step " + std::to_string(step.stepNumber) + ", containing " +
+                        std::to_string(step.atoms.size()) + " atoms, energy = " + std::to_string(step.energy));
     }
-    
-    infoLog("Total frequency parsed: " + std::to_string(data.frequencies.size()));
-    
-    return !data.frequencies.empty();
 }
 
-int BdfParser::countFrequenciesInLine(const std::string& line) {
-    std::istringstream iss(line);
-    std::string token;
-    int count = 0;
-    
-    while (iss >> token) {
-        try {
-            int num = std::stoi(token);
-            if (num >= 1 && num <= 100) count++;
-        } catch (...) {
-            break;
+void BdfParser::StateMachine::parseAtom(std::string_view line, data::OptStep& step) {
+    // 解析原子行: Element X Y Z
+    string_utils::FixedTokenizer<4> fields;
+    double x, y, z;
+
+    if (fields.split(line) > 0 && fields.get(1, x) && fields.get(2, y) && fields.get(3, z)) {
+        data::Atom atom;
+        atom.symbol = fields[0];
+        atom.atomicNumber = data::elements::atomicNumber(fields[0]);
+        atom.x = x;
+        atom.y = y;
+        atom.z = z;
+        step.atoms.push_back(atom);
+
+        if (parser.isDebugEnabled()) {
+            parser.debugLog("Step " + std::to_string(step.stepNumber) + " - Reading atom: " + atom.symbol.str() +
+                            " (" + std::to_string(atom.atomicNumber) + ") at (" +
+                            std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
         }
     }
-    return count;
 }
 
-void BdfParser::parseFrequencyBlock(std::ifstream& file, int nFreqs, data::ParsedData& data) {
-    std::string line;
-    
-    // 读取 Irreps 行并提取对称性信息
-    std::getline(file, line);
-    std::vector<std::string> irreps;
-    if (string_utils::contains(line, "Irreps")) {
-        // 从行中解析 irreps
-        std::istringstream iss(line);
-        std::string word;
-        bool foundIrreps = false;
-        while (iss >> word) {
-            if (foundIrreps && irreps.size() < static_cast<size_t>(nFreqs)) {
-                irreps.push_back(word);
+int BdfParser::StateMachine::currentAtomCount() const {
+    if (!optimization) {
+        return static_cast<int>(singlePoint.step.atoms.size());
+    }
+    // 最后一个步骤块还没有结束时它就是最后一步
+    if (current.active && !current.step.atoms.empty()) {
+        return static_cast<int>(current.step.atoms.size());
+    }
+    return data.optSteps.empty() ? 0 : static_cast<int>(data.optSteps.back().atomCount());
+}
+
+void BdfParser::StateMachine::feedFrequency(std::string_view line, const LineMarkers& markers) {
+    switch (frequencyPhase) {
+        case FrequencyPhase::Idle:
+            if (markers.has(MARKER_VIBRATIONS_HEADER)) {
+                parser.debugLog("Found frequency analysis");
+                // 跳过表头行（Normal frequencies 行和空行）
+                frequencyPhase = FrequencyPhase::Header;
+                skipLines = 2;
             }
-            if (word == "Irreps") {
-                foundIrreps = true;
+            break;
+        case FrequencyPhase::Header:
+            if (--skipLines == 0) {
+                frequencyPhase = FrequencyPhase::Scan;
+            }
+            break;
+        case FrequencyPhase::Scan: {
+            const std::string_view text = string_utils::trimView(line);
+            if (markers.has(MARKER_TRANSLATIONS)) {
+                frequencyPhase = FrequencyPhase::Done;
+                break;
+            }
+
+            // 查找频率块表头（类似 1, 2, 3 这样的数字）
+            if (!text.empty() && std::isdigit(static_cast<unsigned char>(text[0]))) {
+                blockFreqs = parser.countFrequenciesInLine(std::string(text));
+                if (blockFreqs > 0) {
+                    frequencyPhase = FrequencyPhase::Irreps;
+                }
             }
+            break;
+        }
+        case FrequencyPhase::Irreps: {
+            // 读取 Irreps 行并提取对称性信息
+            irreps.clear();
+            if (string_utils::contains(line, "Irreps")) {
+                std::istringstream iss{std::string(line)};
+                std::string word;
+                bool foundIrreps = false;
+                while (iss >> word) {
+                    if (foundIrreps && irreps.size() < static_cast<size_t>(blockFreqs)) {
+                        irreps.push_back(word);
+                    }
+                    if (word == "Irreps") {
+                        foundIrreps = true;
+                    }
+                }
+            }
+            frequencyPhase = FrequencyPhase::Frequencies;
+            break;
         }
+        case FrequencyPhase::Frequencies:
+            freqValues = parser.parseValuesFromLine(std::string(line), blockFreqs);
+            // 跳过简约质量和力常数
+            frequencyPhase = FrequencyPhase::SkipLines;
+            skipLines = 2;
+            break;
+        case FrequencyPhase::SkipLines:
+            if (--skipLines == 0) {
+                frequencyPhase = FrequencyPhase::Intensities;
+            }
+            break;
+        case FrequencyPhase::Intensities:
+            beginFrequencyModes(std::string(line));
+            break;
+        case FrequencyPhase::DisplacementHeader: {
+            // 跳过表头行（通常包含 "Atom  ZA               X         Y         Z"）
+            const std::string text(line);
+            parser.debugLog("Reading potential header line: " + text);
+            if (string_utils::contains(text, "Atom") && string_utils::contains(text, "ZA")) {
+                parser.debugLog("Confirmed header line, skipping");
+                rowsLeft = blockAtoms;
+            } else {
+                parser.debugLog("Not a header line, treating as first atom data");
+                parser.parseAtomDisplacements(text, blockStart, blockFreqs, data);
+                rowsLeft = blockAtoms - 1;
+            }
+            frequencyPhase = rowsLeft > 0 ? FrequencyPhase::Displacements : FrequencyPhase::BlankLine;
+            break;
+        }
+        case FrequencyPhase::Displacements: {
+            const std::string text(line);
+            if (parser.isDebugEnabled()) {
+                parser.debugLog("Reading atom " + std::to_string(blockAtoms - rowsLeft + 1) + " data: " + text);
+            }
+            parser.parseAtomDisplacements(text, blockStart, blockFreqs, data);
+            if (--rowsLeft == 0) {
+                frequencyPhase = FrequencyPhase::BlankLine;
+            }
+            break;
+        }
+        case FrequencyPhase::BlankLine:
+            // 跳过空行
+            parser.debugLog("Skipping empty line: " + std::string(line));
+            frequencyPhase = FrequencyPhase::Scan;
+            break;
+        case FrequencyPhase::Done:
+            break;
     }
-    
-    // 读取频率
-    std::getline(file, line);
-    std::vector<double> freqValues = parseValuesFromLine(line, nFreqs);
-    
-    // 跳过简约质量和力常数
-    std::getline(file, line); // reduced masses
-    std::getline(file, line); // force constants
-    
+}
+
+void BdfParser::StateMachine::beginFrequencyModes(const std::string& irLine) {
     // 读取 IR 强度
-    std::getline(file, line);
-    std::vector<double> irValues = parseValuesFromLine(line, nFreqs);
-    
+    std::vector<double> irValues = parser.parseValuesFromLine(irLine, blockFreqs);
+
     // 创建带有对称性信息的频率模式
-    int startIdx = data.frequencies.size();
-    for (size_t i = 0; i < static_cast<size_t>(nFreqs); i++) {
+    blockStart = data.frequencies.size();
+    for (size_t i = 0; i < static_cast<size_t>(blockFreqs); i++) {
         data::FreqMode mode;
         mode.frequency = (i < freqValues.size()) ? freqValues[i] : 0.0;
         mode.irIntensity = (i < irValues.size()) ? irValues[i] : 0.0;
         mode.irrep = (i < irreps.size()) ? irreps[i] : "A";
         data.frequencies.push_back(mode);
     }
+
+    // 读取原子位移（需要最后一个步骤的原子数）
+    blockAtoms = currentAtomCount();
+    if (blockAtoms == 0) {
+        frequencyPhase = FrequencyPhase::BlankLine;
+        return;
+    }
+    parser.debugLog("Expected " + std::to_string(blockAtoms) + " atomic displacements");
+
+    // 为此块中的所有频率分配位移（新增的模式为0）
+    data.displacements.resize(data.frequencies.size(),
+                              std::max(data.displacements.atomCount(), static_cast<size_t>(blockAtoms)));
+    frequencyPhase = FrequencyPhase::DisplacementHeader;
+}
+
+void BdfParser::StateMachine::feedThermo(std::string_view line) {
+    data::ThermoData& thermo = data.thermoData;
+
+    if (parser.isDebugEnabled()) {
+        parser.debugLog("Processing thermodynamic line: '" + std::string(line) + "'");
+    }
+
+    double value;
+    // 解析电子能量 - 格式: "Electronic total energy   :        -1.170752    Hartree"
+    if (string_utils::contains(line, "Electronic total energy") && string_utils::contains(line, ":")) {
+        if (parseValueAfterColon(line, value)) {
+            thermo.electronicEnergy = value;
+            parser.debugLog("Parsed electronic energy: " + std::to_string(thermo.electronicEnergy));
+        }
+    }
     
-    // 读取原子位移
-    if (!data.optSteps.empty()) {
-        int nAtoms = data.optSteps.back().atoms.size();
-        debugLog("Expected " + std::to_string(nAtoms) + " atomic displacements");
-        
-        // 为此块中的所有频率初始化位移向量
-        for (int i = 0; i < nFreqs; i++) {
-            if ((startIdx + i) < static_cast<int>(data.frequencies.size())) {
-                data.frequencies[startIdx + i].displacements.resize(nAtoms);
-                // 初始化每个原子的位移向量为3个分量
-                for (int j = 0; j < nAtoms; j++) {
-                    data.frequencies[startIdx + i].displacements[j].resize(3, 0.0);
+    // 解析温度和压力 - 格式: "#   1    Temperature =       298.15000 Kelvin         Pressure =         1.00000 Atm"
+    else if (string_utils::contains(line, "Temperature") && string_utils::contains(line, "Kelvin")) {
+        // 使用简单字符串解析提取温度
+        size_t tempPos = line.find("Temperature");
+        if (tempPos != std::string_view::npos) {
+            // 查找 Temperature 后的 "="
+            size_t eqPos = line.find('=', tempPos);
+            if (eqPos != std::string_view::npos) {
+                // 查找 "Kelvin" 获取结束位置
+                size_t kelvinPos = line.find("Kelvin", eqPos);
+                if (kelvinPos != std::string_view::npos) {
+                    // 解析 "=" 和 "Kelvin" 之间的数值
+                    thermo.temperature = string_utils::toDouble(
+                        string_utils::trimView(line.substr(eqPos + 1, kelvinPos - eqPos - 1)), 298.15);
+                    parser.debugLog("Parsed temperature: " + std::to_string(thermo.temperature));
                 }
             }
         }
         
-        // 跳过表头行（通常包含 "Atom  ZA               X         Y         Z"）
-        std::getline(file, line);
-        debugLog("Reading potential header line: " + line);
-        
-        if (string_utils::contains(line, "Atom") && string_utils::contains(line, "ZA")) {
-            debugLog("Confirmed header line, skipping");
-            // 这是表头行，读取所有原子
-            for (int iatom = 0; iatom < nAtoms; iatom++) {
-                if (std::getline(file, line)) {
-                    debugLog("Reading atom " + std::to_string(iatom + 1) + " data: " + line);
-                    parseAtomDisplacements(line, startIdx, nFreqs, data);
-                } else {
-                    debugLog("Warning: Could not read displacement data for atom " + std::to_string(iatom + 1));
-                    break;
-                }
-            }
-        } else {
-            debugLog("Not a header line, treating as first atom data");
-            // 这不是表头行，作为原子数据处理
-            parseAtomDisplacements(line, startIdx, nFreqs, data);
-            
-            // 读取剩余的原子位移数据
-            for (int iatom = 1; iatom < nAtoms; iatom++) {
-                if (std::getline(file, line)) {
-                    debugLog("Reading atom " + std::to_string(iatom + 1) + " data: " + line);
-                    parseAtomDisplacements(line, startIdx, nFreqs, data);
-                } else {
-                    debugLog("Warning: Could not read displacement data for atom " + std::to_string(iatom + 1));
-                    break;
+        // 提取压力
+        size_t pressPos = line.find("Pressure");
+        if (pressPos != std::string_view::npos) {
+            size_t eqPos = line.find('=', pressPos);
+            if (eqPos != std::string_view::npos) {
+                size_t atmPos = line.find("Atm", eqPos);
+                if (atmPos != std::string_view::npos) {
+                    thermo.pressure = string_utils::toDouble(
+                        string_utils::trimView(line.substr(eqPos + 1, atmPos - eqPos - 1)), 1.0);
+                    parser.debugLog("Parsed pressure: " + std::to_string(thermo.pressure));
                 }
             }
         }
     }
     
-    // 跳过空行
-    std::getline(file, line);
-    debugLog("Skipping empty line: " + line);
-}
-
-std::vector<double> BdfParser::parseValuesFromLine(const std::string& line, int nVals) {
-    std::vector<double> values;
-    std::istringstream iss(line);
-    std::string token;
-    
-    // 跳过初始文本
-    while (iss >> token && values.size() < static_cast<size_t>(nVals)) {
-        try {
-            double val = std::stod(token);
-            values.push_back(val);
-        } catch (...) {
-            // 如果转换失败就继续
+    // 解析零点能量 - 格式: "Zero-point Energy                          :            0.010179            6.387623"
+    else if (string_utils::contains(line, "Zero-point Energy") && string_utils::contains(line, ":")) {
+        if (parseValueAfterColon(line, value)) {
+            thermo.zpe = value;
+            parser.debugLog("Parsed zero-point energy: " + std::to_string(thermo.zpe));
         }
     }
     
-    return values;
-}
-
-void BdfParser::parseAtomDisplacements(const std::string& line, int startIdx, int nFreqs, data::ParsedData& data) {
-    std::istringstream iss(line);
-    std::string token;
-    int atomNum, za;
-    
-    // 读取原子编号和 ZA
-    if (!(iss >> atomNum >> za)) {
-        debugLog("Warning: Could not parse atom number and ZA from line: " + line);
-        return;
-    }
-    
-    debugLog("Parsing atom " + std::to_string(atomNum) + " (ZA=" + std::to_string(za) + ") displacements");
-    
-    // 读取每个频率的位移向量
-    for (int ifreq = 0; ifreq < nFreqs && (startIdx + ifreq) < static_cast<int>(data.frequencies.size()); ifreq++) {
-        double x, y, z;
-        if (iss >> x >> y >> z) {
-            // 存储位移到正确的原子位置（atomNum 是基于1的）
-            int atomIdx = atomNum - 1;
-            if (atomIdx >= 0 && atomIdx < static_cast<int>(data.frequencies[startIdx + ifreq].displacements.size())) {
-                data.frequencies[startIdx + ifreq].displacements[atomIdx][0] = x;
-                data.frequencies[startIdx + ifreq].displacements[atomIdx][1] = y;
-                data.frequencies[startIdx + ifreq].displacements[atomIdx][2] = z;
-                
-                debugLog("   Frequency " + std::to_string(startIdx + ifreq + 1) + ", Atom " + std::to_string(atomNum) + 
-                        ": (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
-            } else {
-                debugLog("Warning: Invalid atom index " + std::to_string(atomIdx) + " for displacement storage");
-            }
-        } else {
-            debugLog("Warning: Could not parse atom " + std::to_string(atomNum) + " frequency " + std::to_string(ifreq + 1) + " displacement values");
-            break;
+    // 解析热力学修正到能量 - 格式: "Thermal correction to Energy               :            0.012540            7.868837"
+    else if (string_utils::contains(line, "Thermal correction to Energy") && string_utils::contains(line, ":")) {
+        if (parseValueAfterColon(line, value)) {
+            thermo.thermalEnergyCorr = value;
+            parser.debugLog("Parsed thermal correction to energy: " + std::to_string(thermo.thermalEnergyCorr));
         }
     }
-}
-
-bool BdfParser::parseThermoData(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
     
-    // 查找热力学部分
-    bool foundThermoSection = false;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (string_utils::contains(line, "Thermal Contributions to Energies")) {
-            foundThermoSection = true;
-            break;
+    // 解析热力学修正到焓 - 格式: "Thermal correction to Enthalpy             :            0.013484            8.461322"
+    else if (string_utils::contains(line, "Thermal correction to Enthalpy") && string_utils::contains(line, ":")) {
+        if (parseValueAfterColon(line, value)) {
+            thermo.thermalEnthalpyCorr = value;
+            parser.debugLog("Parsed thermal correction to enthalpy: " + std::to_string(thermo.thermalEnthalpyCorr));
         }
     }
     
-    if (!foundThermoSection) {
-        debugLog("Thermodynamic data not found");
-        return false;
+    // 解析热力学修正到Gibbs自由能 - 格式: "Thermal correction to Gibbs Free Energy    :           -0.001315           -0.825417"
+    else if (string_utils::contains(line, "Thermal correction to Gibbs Free Energy") && string_utils::contains(line, ":")) {
+        if (parseValueAfterColon(line, value)) {
+            thermo.thermalGibbsCorr = value;
+            parser.debugLog("Parsed thermal correction to Gibbs free energy: " + std::to_string(thermo.thermalGibbsCorr));
+        }
     }
     
-    data.thermoData.hasData = true;
-    debugLog("Found thermodynamic data");
-    
-    // 从当前位置继续读取
-    while (std::getline(file, line)) {
-        // 去除前导/尾随空白
-        line = string_utils::trim(line);
-        
-        debugLog("Processing thermodynamic line: '" + line + "'");
-        
-        // 解析电子能量 - 格式: "Electronic total energy   :        -1.170752    Hartree"
-        if (string_utils::contains(line, "Electronic total energy") && string_utils::contains(line, ":")) {
-            size_t colonPos = line.find(":");
-            std::string valueStr = line.substr(colonPos + 1);
-            
-            // 提取冒号后的第一个数值
-            std::istringstream iss(valueStr);
-            double value;
-            if (iss >> value) {
-                data.thermoData.electronicEnergy = value;
-                debugLog("Parsed electronic energy: " + std::to_string(data.thermoData.electronicEnergy));
-            }
-        }
-        
-        // 解析温度和压力 - 格式: "#   1    Temperature =       298.15000 Kelvin         Pressure =         1.00000 Atm"
-        else if (string_utils::contains(line, "Temperature") && string_utils::contains(line, "Kelvin")) {
-            // 使用简单字符串解析提取温度
-            size_t tempPos = line.find("Temperature");
-            if (tempPos != std::string::npos) {
-                // 查找 Temperature 后的 "="
-                size_t eqPos = line.find("=", tempPos);
-                if (eqPos != std::string::npos) {
-                    // 查找 "Kelvin" 获取结束位置
-                    size_t kelvinPos = line.find("Kelvin", eqPos);
-                    if (kelvinPos != std::string::npos) {
-                        // 提取 "=" 和 "Kelvin" 之间的子字符串
-                        std::string tempStr = line.substr(eqPos + 1, kelvinPos - eqPos - 1);
-                        // 解析数值
-                        data.thermoData.temperature = string_utils::toDouble(string_utils::trim(tempStr), 298.15);
-                        debugLog("Parsed temperature: " + std::to_string(data.thermoData.temperature));
-                    }
-                }
-            }
-            
-            // 提取压力
-            size_t pressPos = line.find("Pressure");
-            if (pressPos != std::string::npos) {
-                size_t eqPos = line.find("=", pressPos);
-                if (eqPos != std::string::npos) {
-                    size_t atmPos = line.find("Atm", eqPos);
-                    if (atmPos != std::string::npos) {
-                        std::string pressStr = line.substr(eqPos + 1, atmPos - eqPos - 1);
-                        data.thermoData.pressure = string_utils::toDouble(string_utils::trim(pressStr), 1.0);
-                        debugLog("Parsed pressure: " + std::to_string(data.thermoData.pressure));
-                    }
-                }
-            }
-        }
-        
-        // 解析零点能量 - 格式: "Zero-point Energy                          :            0.010179            6.387623"
-        else if (string_utils::contains(line, "Zero-point Energy") && string_utils::contains(line, ":")) {
-            size_t colonPos = line.find(":");
-            std::string valueStr = line.substr(colonPos + 1);
-            
-            std::istringstream iss(valueStr);
-            double value;
-            if (iss >> value) {
-                data.thermoData.zpe = value;
-                debugLog("Parsed zero-point energy: " + std::to_string(data.thermoData.zpe));
-            }
-        }
-        
-        // 解析热力学修正到能量 - 格式: "Thermal correction to Energy               :            0.012540            7.868837"
-        else if (string_utils::contains(line, "Thermal correction to Energy") && string_utils::contains(line, ":")) {
-            size_t colonPos = line.find(":");
-            std::string valueStr = line.substr(colonPos + 1);
-            
-            std::istringstream iss(valueStr);
-            double value;
-            if (iss >> value) {
-                data.thermoData.thermalEnergyCorr = value;
-                debugLog("Parsed thermal correction to energy: " + std::to_string(data.thermoData.thermalEnergyCorr));
-            }
+    // 解析收敛信息 - 格式: "  Maximum Delta-X              0.000060      0.004000            Yes"
+    if (string_utils::contains(line, "Maximum Delta-X")) {
+        if (parseCriterionValue(line, value)) {
+            thermo.maxDeltaX = value;
+            thermo.hasConvergenceData = true;
+            parser.debugLog("Parsed maximum Delta-X: " + std::to_string(thermo.maxDeltaX));
         }
-        
-        // 解析热力学修正到焓 - 格式: "Thermal correction to Enthalpy             :            0.013484            8.461322"
-        else if (string_utils::contains(line, "Thermal correction to Enthalpy") && string_utils::contains(line, ":")) {
-            size_t colonPos = line.find(":");
-            std::string valueStr = line.substr(colonPos + 1);
-            
-            std::istringstream iss(valueStr);
-            double value;
-            if (iss >> value) {
-                data.thermoData.thermalEnthalpyCorr = value;
-                debugLog("Parsed thermal correction to enthalpy: " + std::to_string(data.thermoData.thermalEnthalpyCorr));
-            }
+    }
+    else if (string_utils::contains(line, "RMS Delta-X")) {
+        if (parseCriterionValue(line, value)) {
+            thermo.rmsDeltaX = value;
+            parser.debugLog("Parsed RMS Delta-X: " + std::to_string(thermo.rmsDeltaX));
         }
-        
-        // 解析热力学修正到Gibbs自由能 - 格式: "Thermal correction to Gibbs Free Energy    :           -0.001315           -0.825417"
-        else if (string_utils::contains(line, "Thermal correction to Gibbs Free Energy") && string_utils::contains(line, ":")) {
-            size_t colonPos = line.find(":");
-            std::string valueStr = line.substr(colonPos + 1);
-            
-            std::istringstream iss(valueStr);
-            double value;
-            if (iss >> value) {
-                data.thermoData.thermalGibbsCorr = value;
-                debugLog("Parsed thermal correction to Gibbs free energy: " + std::to_string(data.thermoData.thermalGibbsCorr));
-            }
+    }
+    else if (string_utils::contains(line, "Maximum Force") && !string_utils::contains(line, "Delta-X")) {
+        if (parseCriterionValue(line, value)) {
+            thermo.maxForce = value;
+            parser.debugLog("Parsed maximum force: " + std::to_string(thermo.maxForce));
         }
-        
-        // 解析收敛信息 - 格式: "  Maximum Delta-X              0.000060      0.004000            Yes"
-        if (string_utils::contains(line, "Maximum Delta-X")) {
-            std::istringstream iss(line);
-            std::string word1, word2;
-            double value, tolerance;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> value >> tolerance >> converged) {
-                data.thermoData.maxDeltaX = value;
-                data.thermoData.hasConvergenceData = true;
-                debugLog("Parsed maximum Delta-X: " + std::to_string(data.thermoData.maxDeltaX));
-            }
+    }
+    else if (string_utils::contains(line, "RMS Force")) {
+        if (parseCriterionValue(line, value)) {
+            thermo.rmsForce = value;
+            parser.debugLog("Parsed RMS force: " + std::to_string(thermo.rmsForce));
         }
-        else if (string_utils::contains(line, "RMS Delta-X")) {
-            std::istringstream iss(line);
-            std::string word1, word2;
-            double value, tolerance;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> value >> tolerance >> converged) {
-                data.thermoData.rmsDeltaX = value;
-                debugLog("Parsed RMS Delta-X: " + std::to_string(data.thermoData.rmsDeltaX));
+    }
+    else if (string_utils::contains(line, "Expected Delta-E")) {
+        // 解析科学记数法如 "0.27D-08"（parseNumber 直接支持 D 记号）
+        const string_utils::FixedTokenizer<5> fields(line);
+        if (fields.size() == 5) {
+            if (fields.get(2, thermo.expectedDeltaE)) {
+                parser.debugLog("Parsed expected Delta-E: " + std::to_string(thermo.expectedDeltaE));
+            } else {
+                parser.debugLog("Failed to parse expected Delta-E: " + std::string(fields[2]));
             }
         }
-        else if (string_utils::contains(line, "Maximum Force") && !string_utils::contains(line, "Delta-X")) {
-            std::istringstream iss(line);
-            std::string word1, word2;
-            double value, tolerance;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> value >> tolerance >> converged) {
-                data.thermoData.maxForce = value;
-                debugLog("Parsed maximum force: " + std::to_string(data.thermoData.maxForce));
-            }
+    }
+    
+}
+
+bool BdfParser::parse(io::FileReader& reader, data::ParsedData& data) {
+    infoLog("Starting BDF file parsing");
+
+    // 顺序读一遍输入，各段落在读到时直接写入 data（流式模式下步骤逐个交给sink）
+    StateMachine machine(*this, data, true);
+    if (reader.isMapped()) {
+        io::LineIterator lines = reader.lines();
+        std::string_view line;
+        while (lines.next(line)) {
+            machine.feed(line);
         }
-        else if (string_utils::contains(line, "RMS Force")) {
-            std::istringstream iss(line);
-            std::string word1, word2;
-            double value, tolerance;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> value >> tolerance >> converged) {
-                data.thermoData.rmsForce = value;
-                debugLog("Parsed RMS force: " + std::to_string(data.thermoData.rmsForce));
-            }
+    } else {
+        std::istream& file = reader.getStream();
+        std::string line;
+        while (std::getline(file, line)) {
+            machine.feed(line);
         }
-        else if (string_utils::contains(line, "Expected Delta-E")) {
-            // 解析科学记数法如 "0.27D-08"
-            std::istringstream iss(line);
-            std::string word1, word2;
-            std::string valueStr, toleranceStr;
-            std::string converged;
-            
-            if (iss >> word1 >> word2 >> valueStr >> toleranceStr >> converged) {
-                // 将 D 记号转换为 E 记号
-                std::replace(valueStr.begin(), valueStr.end(), 'D', 'E');
-                try {
-                    data.thermoData.expectedDeltaE = std::stod(valueStr);
-                    debugLog("Parsed expected Delta-E: " + std::to_string(data.thermoData.expectedDeltaE));
-                } catch (...) {
-                    debugLog("Failed to parse expected Delta-E: " + valueStr);
-                }
-            }
+    }
+
+    // 检查是否是优化计算
+    if (machine.foundOptimization()) {
+        data.hasOpt = true;
+        infoLog("Found geometry optimization");
+        machine.finish();
+        if (data.optSteps.empty()) {
+            errorLog("Optimization steps parsing failed");
+            return false;
         }
-        
-        // 当到达下一个主要部分时停止 - 使用更具体的标记
-        if (string_utils::contains(line, "UniMoVib job terminated")) {
-            debugLog("Reached end of thermodynamic section: " + line);
-            break;
+        infoLog("Total optimization steps: " + std::to_string(data.stepCount()));
+    } else {
+        // 单点计算
+        infoLog("Single point calculation detected");
+        if (!machine.takeSinglePoint()) {
+            errorLog("Single point calculation parsing failed");
+            return false;
         }
     }
+
+    // 频率
+    if (machine.foundFrequencies()) {
+        infoLog("Total frequency parsed: " + std::to_string(data.frequencies.size()));
+    } else {
+        debugLog("Frequency analysis not found");
+    }
+    if (!data.frequencies.empty()) {
+        data.hasFreq = true;
+        infoLog("Frequency parsing completed");
+    }
+
+    // 热力学数据
+    if (!data.thermoData.hasData) {
+        debugLog("Thermodynamic data not found");
+    }
     
     // 打印解析数据的摘要用于调试
     if (data.thermoData.hasData) {
@@ -678,8 +733,139 @@ bool BdfParser::parseThermoData(std::ifstream& file, data::ParsedData& data) {
         debugLog("=================================");
     }
     
-    return data.thermoData.hasData;
+    if (data.thermoData.hasData) {
+        infoLog("Thermodynamic data parsing completed");
+    }
+
+    return !data.optSteps.empty();
+}
+
+bool BdfParser::validateInput(const std::string& filename) {
+    // 只检查文件是否存在，不检查扩展名
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        errorLog("Cannot open file: " + filename);
+        return false;
+    }
+    
+    // 用户指定的文件就是想要转换的文件，不需要额外验证
+    return true;
+}
+
+std::string BdfParser::getParserName() const {
+    return "BdfParser";
+}
+
+std::string BdfParser::getParserVersion() const {
+    return "1.1.0";
+}
+
+std::vector<std::string> BdfParser::getSupportedKeywords() const {
+    return {"Geometry Optimization step", "Results of vibrations", "Thermal Contributions to Energies", "Atom         Coord"};
+}
+
+int BdfParser::scoreContent(std::string_view head) const {
+    int score = 0;
+    if (string_utils::contains(head, "BDF")) {
+        score += 40;
+    }
+    for (std::string_view marker : {"Geometry Optimization step", "Atom         Coord", "Results of vibrations:"}) {
+        if (string_utils::contains(head, marker)) {
+            score += 20;
+        }
+    }
+    return std::min(score, 100);
+}
+
+bool BdfParser::isJobFinished(std::string_view content) const {
+    return string_utils::contains(content, "BDF normal termination") ||
+           string_utils::contains(content, "UniMoVib job terminated normally");
+}
+
+bool BdfParser::parseFollowedStep(std::istream& block, const std::string& markerLine,
+                                  data::OptStep& step, data::TDDFTData& tddft) {
+    (void)tddft; // BDF输出没有逐步的TD-DFT数据
+
+    // 用同一个状态机解析这一个步骤块
+    data::ParsedData blockData;
+    StateMachine machine(*this, blockData, false);
+    machine.feed(markerLine);
+    std::string line;
+    while (std::getline(block, line)) {
+        machine.feed(line);
+    }
+    machine.finish();
+
+    if (blockData.optSteps.empty()) {
+        return false;
+    }
+    step = blockData.optSteps.step(0);
+    return true;
+}
+
+int BdfParser::countFrequenciesInLine(const std::string& line) {
+    size_t pos = 0;
+    int count = 0;
+    
+    for (std::string_view token = string_utils::nextToken(line, pos); !token.empty();
+         token = string_utils::nextToken(line, pos)) {
+        int num;
+        if (!string_utils::parseNumber(token, num)) {
+            break;
+        }
+        if (num >= 1 && num <= 100) count++;
+    }
+    return count;
+}
+
+std::vector<double> BdfParser::parseValuesFromLine(const std::string& line, int nVals) {
+    // 跳过初始文本（无法转换的token）
+    return string_utils::parseValuesFromLine<double>(line, nVals);
 }
 
+void BdfParser::parseAtomDisplacements(const std::string& line, int startIdx, int nFreqs, data::ParsedData& data) {
+    // 行格式: Atom ZA x1 y1 z1 x2 y2 z2 ...（BDF每块最多输出几个模式，32列足够）
+    const string_utils::FixedTokenizer<32> fields(line);
+    int atomNum, za;
+    
+    // 读取原子编号和 ZA
+    if (!fields.get(0, atomNum) || !fields.get(1, za)) {
+        debugLog("Warning: Could not parse atom number and ZA from line: " + line);
+        return;
+    }
+    
+    const bool debugEnabled = isDebugEnabled();
+    if (debugEnabled) {
+        debugLog("Parsing atom " + std::to_string(atomNum) + " (ZA=" + std::to_string(za) + ") displacements");
+    }
+    
+    // 读取每个频率的位移向量
+    for (int ifreq = 0; ifreq < nFreqs && (startIdx + ifreq) < static_cast<int>(data.displacements.modeCount()); ifreq++) {
+        const size_t column = 2 + 3 * static_cast<size_t>(ifreq);
+        double x, y, z;
+        if (fields.get(column, x) && fields.get(column + 1, y) && fields.get(column + 2, z)) {
+            // 存储位移到正确的原子位置（atomNum 是基于1的）
+            int atomIdx = atomNum - 1;
+            if (atomIdx >= 0 && atomIdx < static_cast<int>(data.displacements.atomCount())) {
+                const auto displacement = data.displacements.atom(startIdx + ifreq, atomIdx);
+                displacement[0] = x;
+                displacement[1] = y;
+                displacement[2] = z;
+                
+                if (debugEnabled) {
+                    debugLog("   Frequency " + std::to_string(startIdx + ifreq + 1) + ", Atom " + std::to_string(atomNum) + 
+                            ": (" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
+                }
+            } else {
+                debugLog("Warning: Invalid atom index " + std::to_string(atomIdx) + " for displacement storage");
+            }
+        } else {
+            debugLog("Warning: Could not parse atom " + std::to_string(atomNum) + " frequency " + std::to_string(ifreq + 1) + " displacement values");
+            break;
+        }
+    }
+}
+
+
 } // namespace parsers
-} // namespace fakeg 
\ No newline at end of file
+} // namespace fakeg
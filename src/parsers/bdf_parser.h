@@ -8,8 +8,6 @@ namespace parsers {
 
 class BdfParser : public ParserInterface {
 public:
-    BdfParser();
-    
     // 实现接口方法
     bool parse(io::FileReader& reader, data::ParsedData& data) override;
     bool validateInput(const std::string& filename) override;
@@ -17,28 +15,24 @@ public:
     std::string getParserName() const override;
     std::string getParserVersion() const override;
     std::vector<std::string> getSupportedKeywords() const override;
+    int scoreContent(std::string_view head) const override;
+    bool supportsStreaming() const override { return true; }
+    bool isJobFinished(std::string_view content) const override;
+
+protected:
+    std::string_view followStepMarker() const override { return "Geometry Optimization step :"; }
+    bool parseFollowedStep(std::istream& block, const std::string& markerLine,
+                           data::OptStep& step, data::TDDFTData& tddft) override;
 
 private:
-    // 解析主要方法
-    bool parseOptimizationSteps(std::ifstream& file, data::ParsedData& data);
-    bool parseSinglePoint(std::ifstream& file, data::ParsedData& data);
-    bool parseFrequencies(std::ifstream& file, data::ParsedData& data);
-    bool parseThermoData(std::ifstream& file, data::ParsedData& data);
-    
-    // 解析辅助方法
-    void parseGeometryStep(std::ifstream& file, data::OptStep& step);
-    void parseConvergence(std::ifstream& file, data::OptStep& step);
-    void parseFrequencyBlock(std::ifstream& file, int nFreqs, data::ParsedData& data);
-    void parseAtomDisplacements(const std::string& line, int startIdx, int nFreqs, data::ParsedData& data);
+    // 逐行消费输入的状态机（定义在 bdf_parser.cpp）：每一行只看一次，
+    // 优化步骤、收敛值、频率块和热力学数据在读到时直接写入 ParsedData
+    class StateMachine;
     
-    // 工具方法
+    // 行解析辅助方法
     int countFrequenciesInLine(const std::string& line);
     std::vector<double> parseValuesFromLine(const std::string& line, int nVals);
-    
-    // 查找辅助方法
-    bool findOptimizationSection(std::ifstream& file);
-    bool findFrequencySection(std::ifstream& file);
-    bool findThermoSection(std::ifstream& file);
+    void parseAtomDisplacements(const std::string& line, int startIdx, int nFreqs, data::ParsedData& data);
 };
 
 } // namespace parsers
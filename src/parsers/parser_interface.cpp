@@ -1,17 +1,101 @@
 #include "parser_interface.h"
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace fakeg {
 namespace parsers {
 
-ParserInterface::ParserInterface() : logger(nullptr) {
-    elementMap = std::make_shared<data::ElementMap>();
-}
+ParserInterface::ParserInterface() : logger(nullptr), stepSink(nullptr) {}
 
 void ParserInterface::setLogger(logger::Logger* logger) {
     this->logger = logger;
 }
 
+void ParserInterface::setStepSink(data::StepSink* sink) {
+    stepSink = sink;
+}
+
+bool ParserInterface::isStreaming() const {
+    return stepSink != nullptr && supportsStreaming();
+}
+
+bool ParserInterface::emitStep(data::ParsedData& data, const data::OptStep& step, const data::TDDFTData* tddft) {
+    if (!isStreaming()) {
+        data.optSteps.append(step);
+        return true;
+    }
+    
+    // 只保留最后一步：频率部分需要最终几何
+    data.optSteps.replaceAll(step);
+    if (!stepSink->consumeStep(data, data.optSteps.back(), tddft)) {
+        return false;
+    }
+    data.streamedSteps++;
+    return true;
+}
+
+bool ParserInterface::parseAppendedSteps(std::string_view content, size_t keepBlocks, data::ParsedData& data,
+                                         data::StepSink& sink, size_t& consumed) {
+    const std::string_view marker = followStepMarker();
+    consumed = 0;
+    if (marker.empty()) {
+        return true;
+    }
+    
+    // 标记所在行的行首
+    auto markerLineStart = [&](size_t from) {
+        const size_t hit = content.find(marker, from);
+        if (hit == std::string_view::npos) {
+            return hit;
+        }
+        const size_t newline = content.rfind('\n', hit);
+        return newline == std::string_view::npos ? 0 : newline + 1;
+    };
+    
+    std::vector<size_t> starts;
+    for (size_t start = markerLineStart(0); start != std::string_view::npos;
+         start = markerLineStart(content.find('\n', start))) {
+        starts.push_back(start);
+    }
+    if (starts.empty()) {
+        // 第一个步骤之前的内容
+        consumed = content.size();
+        return true;
+    }
+    
+    // 最后一个标记之后的步骤可能还没写完，和要求保留的完整步骤块一起留到下次
+    const size_t complete = starts.size() - 1;
+    const size_t blocks = complete > keepBlocks ? complete - keepBlocks : 0;
+    
+    io::MemoryInputStream block;
+    std::string markerLine;
+    data::Trajectory frame;  // 交给sink的当前步骤
+    for (size_t i = 0; i < blocks; i++) {
+        block.reset(content.substr(starts[i], starts[i + 1] - starts[i]));
+        std::getline(block, markerLine);
+        
+        data::OptStep step;
+        data::TDDFTData tddft;
+        if (parseFollowedStep(block, markerLine, step, tddft)) {
+            frame.replaceAll(step);
+            if (!sink.consumeStep(data, frame.back(), tddft.hasData ? &tddft : nullptr)) {
+                consumed = starts[i];
+                return false;
+            }
+            data.streamedSteps++;
+            data.hasTDDFT = data.hasTDDFT || tddft.hasData;
+        }
+    }
+    
+    consumed = starts[blocks];
+    return true;
+}
+
+bool ParserInterface::isDebugEnabled() const {
+    return logger && logger->isDebugMode();
+}
+
 void ParserInterface::debugLog(const std::string& message) const {
     if (logger) {
         logger->debug(message);
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 
+#include "data/element_table.h"
 #include "data/structures.h"
 #include "io/file_reader.h"
 #include "logger/logger.h"
@@ -13,8 +15,8 @@ namespace parsers {
 // 解析器接口基类
 class ParserInterface {
 protected:
-    std::shared_ptr<data::ElementMap> elementMap;
     logger::Logger* logger;
+    data::StepSink* stepSink;
 
 public:
     ParserInterface();
@@ -31,14 +33,72 @@ public:
         (void)filename; // 抑制未使用参数警告
         return true; 
     }
+    // 标准输入只能读一次，不能按文件名验证：打开后、解析前用已读入的开头验证
+    virtual bool validateContent(io::FileReader& reader) {
+        (void)reader; // 抑制未使用参数警告
+        return true;
+    }
     
     // 解析器信息
     virtual std::string getParserName() const = 0;
     virtual std::string getParserVersion() const = 0;
+    // 实际完成解析的解析器名称和版本（自动识别时为识别出的解析器），
+    // 增量模式和断点续转据此判断已有的输出是否还能沿用
+    virtual std::string getParserId() const { return getParserName() + " " + getParserVersion(); }
     virtual std::vector<std::string> getSupportedKeywords() const { return {}; }
     
+    // 格式识别：根据文件开头的内容（最多几KB）给出匹配程度。
+    // 0 表示不是该格式，100 表示确定是该格式（例如程序横幅）
+    virtual int scoreContent(std::string_view head) const {
+        (void)head; // 抑制未使用参数警告
+        return 0;
+    }
+    
+    // 流式模式：设置sink后，优化步骤在解析过程中逐个交给sink，ParsedData 中只保留最后一步。
+    // 只有 supportsStreaming() 为true的解析器才会逐步提交；传入nullptr恢复普通模式
+    virtual bool supportsStreaming() const { return false; }
+    void setStepSink(data::StepSink* sink);
+    bool isStreaming() const;
+    
+    // 解析单个文件时最多使用的线程数：0 为自动（硬件线程数），1 为单线程。
+    // 批量模式下多个文件已经并行转换，按 硬件线程数/并行文件数 设置，避免线程数成倍增加。
+    // 不使用多线程的解析器忽略该设置
+    virtual void setThreadCount(size_t threads) {
+        (void)threads; // 抑制未使用参数警告
+    }
+    
+    // 跟踪模式（--follow）：解析仍在写入的输出文件中新追加的内容。
+    // content 为尚未处理的内容（只含完整的行）。其中已完整写出的优化步骤（后面已出现下一个步骤标记）
+    // 依次解析并交给sink，data.streamedSteps 随之增加（有TD-DFT结果时置 data.hasTDDFT）；consumed 返回已处理的字节数，
+    // 其余内容下次连同新追加的内容一起再传入。最后 keepBlocks 个完整步骤块也留着不处理。sink失败时返回false
+    virtual bool supportsFollow() const { return !followStepMarker().empty(); }
+    virtual bool parseAppendedSteps(std::string_view content, size_t keepBlocks, data::ParsedData& data,
+                                    data::StepSink& sink, size_t& consumed);
+    // content 中是否出现了作业结束的标记
+    virtual bool isJobFinished(std::string_view content) const {
+        (void)content; // 抑制未使用参数警告
+        return false;
+    }
+    
 protected:
+    // 跟踪模式的步骤块：每个步骤从含 followStepMarker() 的行开始，到下一个标记行之前结束。
+    // parseFollowedStep 从标记行之后开始读取 block，得到有原子的步骤时返回true
+    virtual std::string_view followStepMarker() const { return {}; }
+    virtual bool parseFollowedStep(std::istream& block, const std::string& markerLine,
+                                   data::OptStep& step, data::TDDFTData& tddft) {
+        (void)block; (void)markerLine; (void)step; (void)tddft; // 抑制未使用参数警告
+        return false;
+    }
+    
+
+    // 提交一个解析完成的优化步骤（按步骤顺序调用）。
+    // 普通模式下追加到 data.optSteps；流式模式下交给sink，返回false表示sink失败，应停止解析
+    bool emitStep(data::ParsedData& data, const data::OptStep& step, const data::TDDFTData* tddft = nullptr);
+    
+
     // 日志辅助方法
+    // 热循环中拼接调试信息前先检查 isDebugEnabled()，避免非调试模式下的字符串分配
+    bool isDebugEnabled() const;
     void debugLog(const std::string& message) const;
     void infoLog(const std::string& message) const;
     void errorLog(const std::string& message) const;
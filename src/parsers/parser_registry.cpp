@@ -0,0 +1,84 @@
+#include "parser_registry.h"
+
+#include "amesp_parser.h"
+#include "bdf_parser.h"
+#include "xtb_parser.h"
+#include "xyz_parser.h"
+#include "io/decompressor.h"
+
+namespace fakeg {
+namespace parsers {
+
+void ParserRegistry::add(const std::string& name, Factory factory) {
+    Entry entry;
+    entry.name = name;
+    entry.probe = factory();
+    entry.factory = std::move(factory);
+    entries.push_back(std::move(entry));
+}
+
+size_t ParserRegistry::size() const {
+    return entries.size();
+}
+
+std::vector<std::string> ParserRegistry::names() const {
+    std::vector<std::string> result;
+    for (const auto& entry : entries) {
+        result.push_back(entry.name);
+    }
+    return result;
+}
+
+std::unique_ptr<ParserInterface> ParserRegistry::create(const std::string& name) const {
+    for (const auto& entry : entries) {
+        if (entry.name == name) {
+            return entry.factory();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<ParserRegistry::Candidate> ParserRegistry::score(std::string_view head) const {
+    std::vector<Candidate> result;
+    for (const auto& entry : entries) {
+        result.push_back({entry.name, entry.probe ? entry.probe->scoreContent(head) : 0});
+    }
+    return result;
+}
+
+std::unique_ptr<ParserInterface> ParserRegistry::detect(std::string_view head, Candidate* best) const {
+    const Entry* chosen = nullptr;
+    int bestScore = 0;
+    for (const auto& entry : entries) {
+        const int value = entry.probe ? entry.probe->scoreContent(head) : 0;
+        if (value > bestScore) {
+            bestScore = value;
+            chosen = &entry;
+        }
+    }
+
+    if (!chosen) {
+        return nullptr;
+    }
+    if (best) {
+        *best = {chosen->name, bestScore};
+    }
+    return chosen->factory();
+}
+
+bool ParserRegistry::readHead(const std::string& filename, std::string& head, size_t bytes) {
+    // 压缩文件取解压后的开头
+    return io::readFileHead(filename, head, bytes);
+}
+
+ParserRegistry ParserRegistry::builtin() {
+    ParserRegistry registry;
+    registry.add("amesp", [] { return std::make_unique<AmespParser>(); });
+    registry.add("bdf", [] { return std::make_unique<BdfParser>(); });
+    registry.add("xyz", [] { return std::make_unique<XyzParser>(); });
+    registry.add("xtb", [] { return std::make_unique<XtbParser>(); });
+    return registry;
+}
+
+} // namespace parsers
+} // namespace fakeg
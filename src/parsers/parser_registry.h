@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser_interface.h"
+
+namespace fakeg {
+namespace parsers {
+
+// 解析器注册表
+//
+// 每种格式登记一个名称和工厂函数。识别时由各解析器的 scoreContent 对文件开头的内容打分，
+// 取得分最高者（同分时取先注册的），不需要读取整个文件。
+class ParserRegistry {
+public:
+    using Factory = std::function<std::unique_ptr<ParserInterface>()>;
+
+    // 识别时读取的文件开头字节数
+    static constexpr size_t kProbeBytes = 8192;
+
+    struct Candidate {
+        std::string name;
+        int score;
+    };
+
+    void add(const std::string& name, Factory factory);
+    size_t size() const;
+    std::vector<std::string> names() const;
+
+    // 按名称创建解析器，未注册时返回nullptr
+    std::unique_ptr<ParserInterface> create(const std::string& name) const;
+
+    // 各解析器对 head 的得分（按注册顺序）
+    std::vector<Candidate> score(std::string_view head) const;
+
+    // 选出得分最高的解析器；所有得分均为0时返回nullptr
+    std::unique_ptr<ParserInterface> detect(std::string_view head, Candidate* best = nullptr) const;
+
+    // 读取文件开头最多 bytes 字节，无法打开时返回false
+    static bool readHead(const std::string& filename, std::string& head, size_t bytes = kProbeBytes);
+
+    // 内置的全部解析器：amesp、bdf、xyz、xtb
+    static ParserRegistry builtin();
+
+private:
+    struct Entry {
+        std::string name;
+        Factory factory;
+        std::unique_ptr<ParserInterface> probe;  // 只用于打分
+    };
+
+    std::vector<Entry> entries;
+};
+
+} // namespace parsers
+} // namespace fakeg
@@ -0,0 +1,143 @@
+#include "section_index.h"
+
+#include "string/byte_search.h"
+#include "string/string_utils.h"
+
+namespace fakeg {
+namespace parsers {
+
+SectionIndex::SectionIndex() : built_(false) {}
+
+SectionIndex::SectionIndex(std::vector<std::string> markers)
+    : markers_(std::move(markers)), hits_(markers_.size()), built_(false) {}
+
+size_t SectionIndex::addMarker(const std::string& marker) {
+    markers_.push_back(marker);
+    hits_.emplace_back();
+    built_ = false;
+    return markers_.size() - 1;
+}
+
+size_t SectionIndex::markerCount() const {
+    return markers_.size();
+}
+
+void SectionIndex::record(size_t id, std::streamoff lineOffset) {
+    // 同一行内多次命中只记录一次
+    auto& hits = hits_[id];
+    if (hits.empty() || hits.back() != lineOffset) {
+        hits.push_back(lineOffset);
+    }
+}
+
+void SectionIndex::scanMapped(std::string_view content) {
+    // 缓存最近一次命中所在行的范围，同一行的后续命中无需再次定位行首
+    size_t lineBegin = 0;
+    size_t lineEnd = 0;
+
+    scanner_.scan(content, [&](size_t id, size_t start) {
+        if (start < lineBegin || start >= lineEnd) {
+            const size_t previous = string_utils::byte_search::findLastByte(content, '\n', start);
+            lineBegin = previous == string_utils::byte_search::npos ? 0 : previous + 1;
+            lineEnd = string_utils::byte_search::findByte(content, '\n', start);
+            if (lineEnd == string_utils::byte_search::npos) {
+                lineEnd = content.size();
+            }
+        }
+        record(id, static_cast<std::streamoff>(lineBegin));
+        return true;
+    });
+}
+
+void SectionIndex::build(io::FileReader& reader) {
+    clear();
+
+    if (!scanner_.isCompiled() || scanner_.patternCount() != markers_.size()) {
+        scanner_ = string_utils::MultiPatternScanner(markers_);
+    }
+
+    if (reader.isMapped()) {
+        // 直接在整个映射上做一次多模式扫描，不经过流
+        scanMapped(reader.view());
+    } else {
+        std::istream& file = reader.getStream();
+        string_utils::LineProcessor::resetToBeginning(file);
+
+        std::string line;
+        std::streamoff offset = file.tellg();
+        while (std::getline(file, line)) {
+            scanner_.scan(line, [&](size_t id, size_t) {
+                record(id, offset);
+                return true;
+            });
+            offset = file.tellg();
+        }
+    }
+
+    string_utils::LineProcessor::resetToBeginning(reader.getStream());
+    built_ = true;
+}
+
+bool SectionIndex::isBuilt() const {
+    return built_;
+}
+
+void SectionIndex::clear() {
+    for (auto& hits : hits_) {
+        hits.clear();
+    }
+    built_ = false;
+}
+
+bool SectionIndex::has(size_t id) const {
+    return id < hits_.size() && !hits_[id].empty();
+}
+
+size_t SectionIndex::count(size_t id) const {
+    return id < hits_.size() ? hits_[id].size() : 0;
+}
+
+const std::vector<std::streamoff>& SectionIndex::offsets(size_t id) const {
+    static const std::vector<std::streamoff> empty;
+    return id < hits_.size() ? hits_[id] : empty;
+}
+
+std::streamoff SectionIndex::first(size_t id) const {
+    return has(id) ? hits_[id].front() : -1;
+}
+
+std::streamoff SectionIndex::firstAfter(size_t id, std::streamoff pos) const {
+    if (id >= hits_.size()) {
+        return -1;
+    }
+    for (std::streamoff offset : hits_[id]) {
+        if (offset >= pos) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+bool SectionIndex::seekTo(std::istream& file, size_t id, size_t nth) const {
+    if (nth >= count(id)) {
+        return false;
+    }
+    string_utils::LineProcessor::setPosition(file, hits_[id][nth]);
+    return true;
+}
+
+bool SectionIndex::seekPast(std::istream& file, size_t id, size_t nth) const {
+    if (!seekTo(file, id, nth)) {
+        file.clear();
+        file.seekg(0, std::ios::end);
+        file.setstate(std::ios::eofbit | std::ios::failbit);
+        return false;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    return true;
+}
+
+} // namespace parsers
+} // namespace fakeg
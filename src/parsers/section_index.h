@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ios>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io/file_reader.h"
+#include "string/multi_pattern_scanner.h"
+
+namespace fakeg {
+namespace parsers {
+
+// 输入文件的段落索引
+//
+// 对文件只扫描一遍，记录每个标记（marker）出现的所有行的起始字节偏移。
+// 解析器据此直接跳转到各自的数据块，而不必每次都从头查找。
+//
+// Notes:
+// - 匹配语义与 LineProcessor::findLine 一致：行内包含标记即命中
+// - 所有标记由一个 MultiPatternScanner 同时匹配，扫描开销与标记数量无关
+// - 偏移可直接用于 seekg（映射模式下为映射内的偏移，流模式下为 tellg 的结果）
+class SectionIndex {
+private:
+    std::vector<std::string> markers_;
+    std::vector<std::vector<std::streamoff>> hits_;
+    string_utils::MultiPatternScanner scanner_;
+    bool built_;
+
+    void record(size_t id, std::streamoff lineOffset);
+    void scanMapped(std::string_view content);
+
+public:
+    SectionIndex();
+    explicit SectionIndex(std::vector<std::string> markers);
+
+    // 注册标记，返回标记id（需在build之前调用）
+    size_t addMarker(const std::string& marker);
+    size_t markerCount() const;
+
+    // 扫描整个文件建立索引；完成后流位置回到文件开头
+    void build(io::FileReader& reader);
+    bool isBuilt() const;
+    void clear();
+
+    // 查询
+    bool has(size_t id) const;
+    size_t count(size_t id) const;
+    const std::vector<std::streamoff>& offsets(size_t id) const;
+    std::streamoff first(size_t id) const;                           // 没有时返回 -1
+    std::streamoff firstAfter(size_t id, std::streamoff pos) const;  // 第一个 >= pos 的命中，没有时返回 -1
+
+    // 定位到第nth个命中行的行首，下一次 getline 读到的就是该行
+    bool seekTo(std::istream& file, size_t id, size_t nth = 0) const;
+
+    // 定位到第nth个命中行之后（等价于 findLine 返回true后的位置）。
+    // 找不到时与 findLine 一样将流置于文件末尾的失败状态。
+    bool seekPast(std::istream& file, size_t id, size_t nth = 0) const;
+};
+
+} // namespace parsers
+} // namespace fakeg
@@ -1,20 +1,32 @@
 #include "xtb_parser.h"
 #include "../logger/logger.h"
+#include "../string/fixed_tokenizer.h"
 #include <algorithm>
 #include <iomanip>
 
 namespace fakeg {
 namespace parsers {
 
-XtbParser::XtbParser() : xtbFormatDetected(false) {}
+XtbParser::XtbParser()
+    : xtbFormatDetected(false),
+      sectionIndex({
+          "frequency output generated by the xtb code",
+          "Standard orientation:",
+          "Harmonic frequencies",
+      }) {}
 
 bool XtbParser::parse(io::FileReader& reader, data::ParsedData& data) {
-    std::ifstream& file = reader.getStream();
+    // 段落索引记录偏移后来回跳转，只能顺序读取的输入（压缩文件）先整个读入内存
+    if (!reader.bufferContent()) {
+        errorLog("Cannot read " + reader.getFilename() + ": " + reader.getError());
+        return false;
+    }
+    std::istream& file = reader.getStream();
     
     infoLog("Starting XTB Gaussian format file parsing");
     
-    // 重置文件位置
-    string_utils::LineProcessor::resetToBeginning(file);
+    // 扫描一遍文件，记录所有段落标记的位置
+    sectionIndex.build(reader);
     xtbFormatDetected = false;
     
     // 解析标准定向坐标
@@ -59,6 +71,21 @@ bool XtbParser::validateInput(const std::string& filename) {
     return true;
 }
 
+int XtbParser::scoreContent(std::string_view head) const {
+    if (string_utils::contains(head, "frequency output generated by the xtb code")) {
+        return 100;
+    }
+    
+    // 没有标识行的Gaussian风格输出也能解析，但可信度较低
+    int score = 0;
+    for (std::string_view marker : {"Entering Gaussian System", "Standard orientation:", "Harmonic frequencies"}) {
+        if (string_utils::contains(head, marker)) {
+            score += 15;
+        }
+    }
+    return score;
+}
+
 std::string XtbParser::getParserName() const {
     return "XtbParser";
 }
@@ -71,22 +98,22 @@ std::vector<std::string> XtbParser::getSupportedKeywords() const {
     return {"XTB", "GAUSSIAN", "FREQUENCY", "G98"};
 }
 
-bool XtbParser::parseStandardOrientation(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
+bool XtbParser::parseStandardOrientation(std::istream& file, data::ParsedData& data) {
     std::string line;
     
-    // 查找标准定向表
-    while (std::getline(file, line)) {
-        if (line.find("Standard orientation:") != std::string::npos) {
-            debugLog("Found standard orientation section");
+    // 检测XTB格式标识（只认标准定向表之前出现的标识）
+    const std::streamoff orientationOffset = sectionIndex.first(MARKER_ORIENTATION);
+    for (std::streamoff offset : sectionIndex.offsets(MARKER_XTB_IDENTIFIER)) {
+        if (orientationOffset >= 0 && offset >= orientationOffset) {
             break;
         }
-        
-        // 检测XTB格式标识
-        if (line.find("frequency output generated by the xtb code") != std::string::npos) {
-            xtbFormatDetected = true;
-            debugLog("Detected XTB format identifier");
-        }
+        xtbFormatDetected = true;
+        debugLog("Detected XTB format identifier");
+    }
+    
+    // 查找标准定向表
+    if (sectionIndex.seekPast(file, MARKER_ORIENTATION)) {
+        debugLog("Found standard orientation section");
     }
     
     // 跳过表头（分割线、列标题1、列标题2、分割线）
@@ -105,9 +132,8 @@ bool XtbParser::parseStandardOrientation(std::ifstream& file, data::ParsedData&
     step.converged = true; // XTB频率计算默认收敛
     
     // 读取原子坐标
+    string_utils::FixedTokenizer<6> fields;
     while (std::getline(file, line)) {
-        line = string_utils::trim(line);
-        
         // 遇到分割线结束
         if (line.find("----") != std::string::npos) {
             debugLog("Found end of coordinates section");
@@ -115,51 +141,38 @@ bool XtbParser::parseStandardOrientation(std::ifstream& file, data::ParsedData&
         }
         
         // 跳过空行
-        if (line.empty()) {
+        if (fields.split(line) == 0) {
             continue;
         }
         
-        // 解析原子行
-        std::istringstream iss(line);
+        // 解析原子行: Center AtomicNumber AtomicType X Y Z
         int centerNum, atomicNum, atomType;
         double x, y, z;
         
-        if (iss >> centerNum >> atomicNum >> atomType >> x >> y >> z) {
+        if (fields.get(0, centerNum) && fields.get(1, atomicNum) && fields.get(2, atomType) &&
+            fields.get(3, x) && fields.get(4, y) && fields.get(5, z)) {
             data::Atom atom;
             atom.atomicNumber = atomicNum;
             atom.x = x;
             atom.y = y;
             atom.z = z;
             
-            // 通过ElementMap获取元素符号
-            if (elementMap) {
-                // 这里需要反向查找，从原子序数获取符号
-                // 简化处理，直接根据原子序数设置符号
-                switch (atomicNum) {
-                    case 1: atom.symbol = "H"; break;
-                    case 6: atom.symbol = "C"; break;
-                    case 7: atom.symbol = "N"; break;
-                    case 8: atom.symbol = "O"; break;
-                    case 9: atom.symbol = "F"; break;
-                    case 15: atom.symbol = "P"; break;
-                    case 16: atom.symbol = "S"; break;
-                    case 17: atom.symbol = "Cl"; break;
-                    default: atom.symbol = "X"; break;
-                }
-            } else {
-                atom.symbol = "C"; // 默认为碳
-            }
+            // 从原子序数反查元素符号（超出周期表时为 "X"）
+            const std::string_view symbol = data::elements::symbol(atomicNum);
+            atom.symbol = symbol.empty() ? "X" : symbol;
             
             step.atoms.push_back(atom);
-            debugLog("Parsed atom: " + atom.symbol + " (" + std::to_string(atomicNum) + ") " +
-                     std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z));
+            if (isDebugEnabled()) {
+                debugLog("Parsed atom: " + atom.symbol.str() + " (" + std::to_string(atomicNum) + ") " +
+                         std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z));
+            }
         } else {
-            debugLog("Could not parse line: " + line);
+            debugLog("Could not parse line: " + std::string(string_utils::trimView(line)));
         }
     }
     
     if (!step.atoms.empty()) {
-        data.optSteps.push_back(step);
+        data.optSteps.append(step);
         infoLog("Found " + std::to_string(step.atoms.size()) + " atoms in standard orientation");
         return true;
     } else {
@@ -168,16 +181,12 @@ bool XtbParser::parseStandardOrientation(std::ifstream& file, data::ParsedData&
     }
 }
 
-bool XtbParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
+bool XtbParser::parseFrequencies(std::istream& file, data::ParsedData& data) {
     std::string line;
     
     // 查找频率部分
-    while (std::getline(file, line)) {
-        if (line.find("Harmonic frequencies") != std::string::npos) {
-            debugLog("Found frequency section");
-            break;
-        }
+    if (sectionIndex.seekPast(file, MARKER_FREQUENCIES)) {
+        debugLog("Found frequency section");
     }
     
     // 跳过描述行
@@ -188,6 +197,11 @@ bool XtbParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
         }
     }
     
+    // 按标准定向的原子数预先确定位移矩阵的列数，之后只按模式增长
+    if (!data.optSteps.empty()) {
+        data.displacements.resize(0, data.optSteps.back().atomCount());
+    }
+    
     // 逐行解析所有内容
     std::vector<int> currentFreqIndices;
     bool inFreqBlock = false;
@@ -206,13 +220,12 @@ bool XtbParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
         bool isFreqLine = true;
         
         while (iss >> word) {
-            try {
-                int num = std::stoi(word);
-                numbers.push_back(num);
-            } catch (...) {
+            int num;
+            if (!string_utils::parseNumber(word, num)) {
                 isFreqLine = false;
                 break;
             }
+            numbers.push_back(num);
         }
         
         if (isFreqLine && numbers.size() >= 1 && numbers.size() <= 3) {
@@ -287,14 +300,22 @@ bool XtbParser::parseFrequencies(std::ifstream& file, data::ParsedData& data) {
                     int freqIdx = currentFreqIndices[i] - 1;
                     int atomIdx = atomNum - 1;
                     
-                    // 确保位移向量足够大
-                    while (data.frequencies[freqIdx].displacements.size() <= static_cast<size_t>(atomIdx)) {
-                        data.frequencies[freqIdx].displacements.emplace_back(3, 0.0);
+                    if (atomIdx < 0) {
+                        continue;
+                    }
+                    
+                    // 确保位移矩阵足够大（通常在频率段开头已按原子数分配好）
+                    data::DisplacementMatrix& matrix = data.displacements;
+                    if (static_cast<size_t>(freqIdx) >= matrix.modeCount() ||
+                        static_cast<size_t>(atomIdx) >= matrix.atomCount()) {
+                        matrix.resize(std::max(matrix.modeCount(), data.frequencies.size()),
+                                      std::max(matrix.atomCount(), static_cast<size_t>(atomIdx) + 1));
                     }
                     
-                    data.frequencies[freqIdx].displacements[atomIdx][0] = x;
-                    data.frequencies[freqIdx].displacements[atomIdx][1] = y;
-                    data.frequencies[freqIdx].displacements[atomIdx][2] = z;
+                    const auto displacement = matrix.atom(freqIdx, atomIdx);
+                    displacement[0] = x;
+                    displacement[1] = y;
+                    displacement[2] = z;
                 }
             }
         }
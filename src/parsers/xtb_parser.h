@@ -1,6 +1,7 @@
 #pragma once
 
 #include "parser_interface.h"
+#include "section_index.h"
 #include "../string/string_utils.h"
 #include <sstream>
 
@@ -18,14 +19,25 @@ public:
     std::string getParserName() const override;
     std::string getParserVersion() const override;
     std::vector<std::string> getSupportedKeywords() const override;
+    int scoreContent(std::string_view head) const override;
 
 private:
     // 解析方法
-    bool parseStandardOrientation(std::ifstream& file, data::ParsedData& data);
-    bool parseFrequencies(std::ifstream& file, data::ParsedData& data);
+    bool parseStandardOrientation(std::istream& file, data::ParsedData& data);
+    bool parseFrequencies(std::istream& file, data::ParsedData& data);
     
     // 检测标志
     bool xtbFormatDetected;
+    
+    // 段落标记（顺序与构造函数中的注册顺序一致）
+    enum Marker : size_t {
+        MARKER_XTB_IDENTIFIER,
+        MARKER_ORIENTATION,
+        MARKER_FREQUENCIES,
+    };
+    
+    // 每个输入文件扫描一次建立的段落索引
+    SectionIndex sectionIndex;
 };
 
 } // namespace parsers
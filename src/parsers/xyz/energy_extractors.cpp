@@ -1,6 +1,6 @@
 #include "energy_extractors.h"
 
-#include <stdexcept>
+#include "string/string_utils.h"
 
 namespace fakeg {
 namespace parsers {
@@ -22,9 +22,9 @@ std::string toString(EnergyFormat format) {
 RegexEnergyExtractor::RegexEnergyExtractor(EnergyFormat fmt, std::regex pattern)
     : fmt_(fmt), pattern_(std::move(pattern)) {}
 
-std::optional<double> RegexEnergyExtractor::tryExtract(const std::string& comment) const {
-    std::smatch match;
-    if (!std::regex_search(comment, match, pattern_)) {
+std::optional<double> RegexEnergyExtractor::tryExtract(std::string_view comment) const {
+    std::match_results<std::string_view::const_iterator> match;
+    if (!std::regex_search(comment.begin(), comment.end(), match, pattern_)) {
         return std::nullopt;
     }
 
@@ -32,18 +32,197 @@ std::optional<double> RegexEnergyExtractor::tryExtract(const std::string& commen
         return std::nullopt;
     }
 
-    try {
-        const double energy = std::stod(match[1].str());
-        return energy;
-    } catch (const std::exception&) {
+    double energy;
+    const std::string_view number = comment.substr(static_cast<size_t>(match.position(1)), static_cast<size_t>(match.length(1)));
+    if (!string_utils::parseNumber(number, energy)) {
         return std::nullopt;
     }
+    return energy;
 }
 
 EnergyFormat RegexEnergyExtractor::format() const {
     return fmt_;
 }
 
+namespace {
+
+// 与 std::regex（ECMAScript，"C" locale）中 \s 的字符集一致
+bool isRegexSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// '.' 不匹配的行终止符
+bool isLineTerminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+size_t skipSpaces(std::string_view text, size_t pos) {
+    while (pos < text.size() && isRegexSpace(text[pos])) pos++;
+    return pos;
+}
+
+size_t skipDigits(std::string_view text, size_t pos) {
+    while (pos < text.size() && isDigit(text[pos])) pos++;
+    return pos;
+}
+
+bool startsWithAt(std::string_view text, size_t pos, std::string_view literal) {
+    return text.substr(pos, literal.size()) == literal;
+}
+
+// 数值的正则为 [-+]?\d*\.?\d+(?:[eE][-+]?\d+)?
+//
+// 尾数只可能在以下位置结束（其余位置后面紧跟数字，正则都会继续匹配或回溯到这里）：
+// - 整段整数之后（"12" 或 "1." 中的 "1"）
+// - 小数部分整段数字之后（"1.25"、".5"）
+struct MantissaEnds {
+    size_t integerEnd = std::string_view::npos;
+    size_t fractionEnd = std::string_view::npos;
+};
+
+MantissaEnds mantissaEnds(std::string_view text, size_t pos) {
+    MantissaEnds ends;
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) pos++;
+
+    const size_t digitsEnd = skipDigits(text, pos);
+    if (digitsEnd > pos) {
+        ends.integerEnd = digitsEnd;
+    }
+    if (digitsEnd < text.size() && text[digitsEnd] == '.') {
+        const size_t fractionEnd = skipDigits(text, digitsEnd + 1);
+        if (fractionEnd > digitsEnd + 1) {
+            ends.fractionEnd = fractionEnd;
+        }
+    }
+    return ends;
+}
+
+// 可选的指数部分 [eE][-+]?\d+，不存在时返回 pos
+size_t exponentEnd(std::string_view text, size_t pos) {
+    if (pos >= text.size() || (text[pos] != 'e' && text[pos] != 'E')) return pos;
+    size_t digits = pos + 1;
+    if (digits < text.size() && (text[digits] == '-' || text[digits] == '+')) digits++;
+    const size_t end = skipDigits(text, digits);
+    return end > digits ? end : pos;
+}
+
+// 数值后面没有其它约束时，正则回溯得到的第一个匹配：尾数优先取带小数的形式，指数能取就取
+size_t matchNumber(std::string_view text, size_t pos) {
+    const MantissaEnds ends = mantissaEnds(text, pos);
+    const size_t mantissa = ends.fractionEnd != std::string_view::npos ? ends.fractionEnd : ends.integerEnd;
+    return mantissa == std::string_view::npos ? mantissa : exponentEnd(text, mantissa);
+}
+
+std::optional<double> toEnergy(std::string_view text, size_t begin, size_t end) {
+    double energy;
+    if (!string_utils::parseNumber(text.substr(begin, end - begin), energy)) {
+        return std::nullopt;
+    }
+    return energy;
+}
+
+// ORCA 尾部 \s+E\s+<number>：q 为 .+ 之后的位置，成功时返回数值的起止位置
+bool matchOrcaTail(std::string_view text, size_t q, size_t& numberBegin, size_t& numberEnd) {
+    if (q >= text.size() || !isRegexSpace(text[q])) return false;
+    const size_t e = skipSpaces(text, q);
+    if (e >= text.size() || text[e] != 'E') return false;
+    const size_t number = skipSpaces(text, e + 1);
+    if (number == e + 1) return false;
+
+    const size_t end = matchNumber(text, number);
+    if (end == std::string_view::npos) return false;
+    numberBegin = number;
+    numberEnd = end;
+    return true;
+}
+
+} // namespace
+
+std::optional<double> OrcaEnergyExtractor::tryExtract(std::string_view comment) const {
+    const std::string_view text = comment;
+
+    // 正则从左到右尝试每个 "Coordinates" 作为起点
+    for (size_t start = text.find("Coordinates"); start != std::string_view::npos;
+         start = text.find("Coordinates", start + 1)) {
+        size_t pos = start + 11;
+        size_t next = skipSpaces(text, pos);
+        if (next == pos || !startsWithAt(text, next, "from")) continue;
+        pos = next + 4;
+        next = skipSpaces(text, pos);
+        if (next == pos || !startsWithAt(text, next, "ORCA-job")) continue;
+
+        // ORCA-job 之后的 \s+ 至少一个空白；.+ 从空白段内任意位置开始（贪婪的 \s+ 先取最长），
+        // 对每个起点 .+ 从最长（不越过行终止符）开始回溯，第一个满足尾部的位置即为匹配
+        const size_t jobEnd = next + 8;
+        const size_t spacesEnd = skipSpaces(text, jobEnd);
+        for (size_t dotStart = spacesEnd; dotStart > jobEnd; dotStart--) {
+            size_t limit = dotStart;
+            while (limit < text.size() && !isLineTerminator(text[limit])) limit++;
+
+            for (size_t q = limit; q > dotStart; q--) {
+                size_t numberBegin, numberEnd;
+                if (matchOrcaTail(text, q, numberBegin, numberEnd)) {
+                    return toEnergy(text, numberBegin, numberEnd);
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+EnergyFormat OrcaEnergyExtractor::format() const {
+    return EnergyFormat::Orca;
+}
+
+std::optional<double> MolclusEnergyExtractor::tryExtract(std::string_view comment) const {
+    const std::string_view text = comment;
+
+    for (size_t start = text.find("Energy"); start != std::string_view::npos;
+         start = text.find("Energy", start + 1)) {
+        size_t pos = skipSpaces(text, start + 6);
+        if (pos >= text.size() || text[pos] != '=') continue;
+        const size_t number = skipSpaces(text, pos + 1);
+
+        // 数值后必须紧跟 \s*a\.u\.，候选结束位置中至多一个满足（其余位置后面是数字或小数点）
+        const MantissaEnds ends = mantissaEnds(text, number);
+        for (size_t mantissa : {ends.integerEnd, ends.fractionEnd}) {
+            if (mantissa == std::string_view::npos) continue;
+            for (size_t end : {exponentEnd(text, mantissa), mantissa}) {
+                if (startsWithAt(text, skipSpaces(text, end), "a.u.")) {
+                    return toEnergy(text, number, end);
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+EnergyFormat MolclusEnergyExtractor::format() const {
+    return EnergyFormat::Molclus;
+}
+
+std::optional<double> XtbEnergyExtractor::tryExtract(std::string_view comment) const {
+    const std::string_view text = comment;
+
+    for (size_t start = text.find("energy:"); start != std::string_view::npos;
+         start = text.find("energy:", start + 1)) {
+        const size_t number = skipSpaces(text, start + 7);
+        const size_t end = matchNumber(text, number);
+        if (end != std::string_view::npos) {
+            return toEnergy(text, number, end);
+        }
+    }
+    return std::nullopt;
+}
+
+EnergyFormat XtbEnergyExtractor::format() const {
+    return EnergyFormat::Xtb;
+}
+
 EnergyExtractorPipeline::EnergyExtractorPipeline(LogFn infoLog, LogFn debugLog)
     : infoLog_(std::move(infoLog)), debugLog_(std::move(debugLog)) {}
 
@@ -53,6 +232,26 @@ void EnergyExtractorPipeline::add(std::unique_ptr<IEnergyExtractor> extractor) {
 
 void EnergyExtractorPipeline::reset() {
     announcedFormats_.clear();
+    pinned_ = nullptr;
+}
+
+void EnergyExtractorPipeline::pin(EnergyFormat format) {
+    for (const auto& extractor : extractors_) {
+        if (extractor && extractor->format() == format) {
+            pinned_ = extractor.get();
+            if (debugLog_) {
+                debugLog_("Energy format pinned to " + toString(format));
+            }
+            return;
+        }
+    }
+}
+
+std::optional<EnergyFormat> EnergyExtractorPipeline::pinnedFormat() const {
+    if (!pinned_) {
+        return std::nullopt;
+    }
+    return pinned_->format();
 }
 
 void EnergyExtractorPipeline::announceOnce(EnergyFormat format) {
@@ -67,7 +266,24 @@ void EnergyExtractorPipeline::announceOnce(EnergyFormat format) {
     }
 }
 
-std::optional<double> EnergyExtractorPipeline::extract(const std::string& comment) {
+std::optional<double> EnergyExtractorPipeline::extract(std::string_view comment) {
+    EnergyFormat fmt;
+    auto energy = tryExtract(comment, &fmt);
+    if (energy.has_value()) {
+        report(fmt, *energy);
+    }
+    return energy;
+}
+
+std::optional<double> EnergyExtractorPipeline::tryExtract(std::string_view comment, EnergyFormat* format) const {
+    if (pinned_) {
+        auto energy = pinned_->tryExtract(comment);
+        if (energy.has_value() && format) {
+            *format = pinned_->format();
+        }
+        return energy;
+    }
+
     for (const auto& extractor : extractors_) {
         if (!extractor) continue;
 
@@ -76,41 +292,38 @@ std::optional<double> EnergyExtractorPipeline::extract(const std::string& commen
             continue;
         }
 
-        const auto fmt = extractor->format();
-        announceOnce(fmt);
-
-        if (debugLog_) {
-            debugLog_("Extracted " + toString(fmt) + " energy: " + std::to_string(*energy));
+        if (format) {
+            *format = extractor->format();
         }
-
         return energy;
     }
 
     return std::nullopt;
 }
 
+void EnergyExtractorPipeline::report(EnergyFormat format, double energy) {
+    announceOnce(format);
+
+    if (debugLog_) {
+        debugLog_("Extracted " + toString(format) + " energy: " + std::to_string(energy));
+    }
+}
+
 EnergyExtractorPipeline makeDefaultEnergyPipeline(EnergyExtractorPipeline::LogFn infoLog,
                                                  EnergyExtractorPipeline::LogFn debugLog) {
     EnergyExtractorPipeline pipeline(std::move(infoLog), std::move(debugLog));
 
     // ORCA format:
     // Coordinates from ORCA-job ... E -687.545427056709
-    pipeline.add(std::make_unique<RegexEnergyExtractor>(
-        EnergyFormat::Orca,
-        std::regex(
-            R"(Coordinates\s+from\s+ORCA-job\s+.+\s+E\s+([-+]?\d*\.?\d+(?:[eE][-+]?\d+)?))")));
+    pipeline.add(std::make_unique<OrcaEnergyExtractor>());
 
     // molclus format:
     // Energy =   -147.48410656 a.u.  #Cluster:    1
-    pipeline.add(std::make_unique<RegexEnergyExtractor>(
-        EnergyFormat::Molclus,
-        std::regex(R"(Energy\s*=\s*([-+]?\d*\.?\d+(?:[eE][-+]?\d+)?)\s*a\.u\.)")));
+    pipeline.add(std::make_unique<MolclusEnergyExtractor>());
 
     // xtb format:
     // energy: -149.706157544781 gnorm: 0.499...
-    pipeline.add(std::make_unique<RegexEnergyExtractor>(
-        EnergyFormat::Xtb,
-        std::regex(R"(energy:\s*([-+]?\d*\.?\d+(?:[eE][-+]?\d+)?))")));
+    pipeline.add(std::make_unique<XtbEnergyExtractor>());
 
     return pipeline;
 }
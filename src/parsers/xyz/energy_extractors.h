@@ -5,6 +5,7 @@
 #include <optional>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <vector>
 
@@ -25,7 +26,7 @@ public:
     virtual ~IEnergyExtractor() = default;
 
     // Returns energy if this extractor recognizes the format.
-    virtual std::optional<double> tryExtract(const std::string& comment) const = 0;
+    virtual std::optional<double> tryExtract(std::string_view comment) const = 0;
 
     virtual EnergyFormat format() const = 0;
 };
@@ -35,7 +36,7 @@ class RegexEnergyExtractor final : public IEnergyExtractor {
 public:
     RegexEnergyExtractor(EnergyFormat fmt, std::regex pattern);
 
-    std::optional<double> tryExtract(const std::string& comment) const override;
+    std::optional<double> tryExtract(std::string_view comment) const override;
     EnergyFormat format() const override;
 
 private:
@@ -43,8 +44,40 @@ private:
     std::regex pattern_;
 };
 
+// Hand-written matchers for the built-in formats.
+//
+// Each one returns exactly what the corresponding std::regex used to capture
+// (same leftmost/greedy backtracking choice), without running the regex engine.
+
+// ORCA: Coordinates\s+from\s+ORCA-job\s+.+\s+E\s+<number>
+// e.g. "Coordinates from ORCA-job input E -687.545427056709"
+class OrcaEnergyExtractor final : public IEnergyExtractor {
+public:
+    std::optional<double> tryExtract(std::string_view comment) const override;
+    EnergyFormat format() const override;
+};
+
+// molclus: Energy\s*=\s*<number>\s*a\.u\.
+// e.g. "Energy =   -147.48410656 a.u.  #Cluster:    1"
+class MolclusEnergyExtractor final : public IEnergyExtractor {
+public:
+    std::optional<double> tryExtract(std::string_view comment) const override;
+    EnergyFormat format() const override;
+};
+
+// xtb: energy:\s*<number>
+// e.g. "energy: -149.706157544781 gnorm: 0.499..."
+class XtbEnergyExtractor final : public IEnergyExtractor {
+public:
+    std::optional<double> tryExtract(std::string_view comment) const override;
+    EnergyFormat format() const override;
+};
+
 // Stateful pipeline that tries multiple extractors in order and
 // logs a one-time "Detected ..." message per format.
+//
+// Once a format is pinned (XyzCommentParser pins the format found on frame 1),
+// only that format's extractor is tried.
 class EnergyExtractorPipeline {
 public:
     using LogFn = std::function<void(const std::string&)>;
@@ -53,17 +86,30 @@ public:
 
     void add(std::unique_ptr<IEnergyExtractor> extractor);
 
-    // Reset one-time detection state.
+    // Reset one-time detection state and the pinned format.
     void reset();
 
+    // Restrict extraction to a single format (ignored if no extractor has it).
+    void pin(EnergyFormat format);
+    std::optional<EnergyFormat> pinnedFormat() const;
+
     // Try to extract energy from a comment line.
-    std::optional<double> extract(const std::string& comment);
+    std::optional<double> extract(std::string_view comment);
+
+    // Stateless variant of extract(): no logging and no detection bookkeeping,
+    // so it may be called concurrently from worker threads.
+    std::optional<double> tryExtract(std::string_view comment, EnergyFormat* format) const;
+
+    // Performs the logging/bookkeeping side of extract() for a result obtained
+    // through tryExtract(); call it from the owning thread in frame order.
+    void report(EnergyFormat format, double energy);
 
 private:
     LogFn infoLog_;
     LogFn debugLog_;
     std::vector<std::unique_ptr<IEnergyExtractor>> extractors_;
     std::unordered_set<int> announcedFormats_;
+    const IEnergyExtractor* pinned_ = nullptr;
 
     void announceOnce(EnergyFormat format);
 };
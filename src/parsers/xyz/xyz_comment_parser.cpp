@@ -1,9 +1,6 @@
 #include "xyz_comment_parser.h"
 
-#include <sstream>
-#include <vector>
-
-#include "string/string_utils.h"
+#include "string/fixed_tokenizer.h"
 
 namespace fakeg {
 namespace parsers {
@@ -18,30 +15,20 @@ void XyzCommentParser::reset() {
     energyPipeline_.reset();
 }
 
-void XyzCommentParser::tryExtractChargeSpin(const std::string& comment, data::ParsedData& data, int frameNumber) {
+void XyzCommentParser::tryExtractChargeSpin(std::string_view comment, data::ParsedData& data, int frameNumber) {
     // Only attempt in frame 1, and only if not already present.
     if (frameNumber != 1 || data.hasChargeSpinInfo) {
         return;
     }
 
-    const std::string trimmed = string_utils::trim(comment);
-
-    // Tokenize by whitespace.
-    std::istringstream iss(trimmed);
-    std::vector<std::string> tokens;
-    std::string token;
-
-    while (iss >> token) {
-        tokens.push_back(token);
-    }
-
     // Expect exactly 2 integer tokens.
-    if (tokens.size() != 2) {
+    const string_utils::FixedTokenizer<2> tokens(comment);
+    if (tokens.size() != 2 || tokens.truncated()) {
         return;
     }
 
-    const bool isFirstInt = string_utils::isValidNumber(tokens[0]) && tokens[0].find('.') == std::string::npos;
-    const bool isSecondInt = string_utils::isValidNumber(tokens[1]) && tokens[1].find('.') == std::string::npos;
+    const bool isFirstInt = string_utils::isValidNumber(tokens[0]) && tokens[0].find('.') == std::string_view::npos;
+    const bool isSecondInt = string_utils::isValidNumber(tokens[1]) && tokens[1].find('.') == std::string_view::npos;
 
     if (!isFirstInt || !isSecondInt) {
         return;
@@ -63,9 +50,32 @@ void XyzCommentParser::tryExtractChargeSpin(const std::string& comment, data::Pa
     }
 }
 
-std::optional<double> XyzCommentParser::parse(const std::string& comment, data::ParsedData& data, int frameNumber) {
-    tryExtractChargeSpin(comment, data, frameNumber);
-    return energyPipeline_.extract(comment);
+std::optional<double> XyzCommentParser::parse(std::string_view comment, data::ParsedData& data, int frameNumber) {
+    if (frameNumber == 1) {
+        tryExtractChargeSpin(comment, data, frameNumber);
+    }
+
+    EnergyFormat format;
+    auto energy = energyPipeline_.tryExtract(comment, &format);
+    if (energy.has_value()) {
+        energyPipeline_.report(format, *energy);
+        if (frameNumber == 1) {
+            energyPipeline_.pin(format);
+        }
+    }
+    return energy;
+}
+
+std::optional<double> XyzCommentParser::extractEnergy(std::string_view comment, EnergyFormat* format) const {
+    return energyPipeline_.tryExtract(comment, format);
+}
+
+void XyzCommentParser::reportEnergy(EnergyFormat format, double energy) {
+    energyPipeline_.report(format, energy);
+}
+
+void XyzCommentParser::pinFormat(EnergyFormat format) {
+    energyPipeline_.pin(format);
 }
 
 } // namespace xyz
@@ -3,6 +3,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "data/structures.h"
 #include "parsers/xyz/energy_extractors.h"
@@ -13,7 +14,8 @@ namespace xyz {
 
 // Parses XYZ comment lines for:
 // - charge/spin (frame 1 only; if available)
-// - energy (via a configurable extractor pipeline)
+// - energy (via a configurable extractor pipeline); the format found on
+//   frame 1 is pinned so later frames only run that extractor
 class XyzCommentParser {
 public:
     using LogFn = std::function<void(const std::string&)>;
@@ -24,14 +26,21 @@ public:
 
     // Attempts to update charge/spin (when frameNumber==1 and data has no charge/spin).
     // Returns extracted energy (if any).
-    std::optional<double> parse(const std::string& comment, data::ParsedData& data, int frameNumber);
+    std::optional<double> parse(std::string_view comment, data::ParsedData& data, int frameNumber);
+
+    // Split form of parse() for parallel frame parsing:
+    // - extractEnergy() is const and thread-safe (no logging)
+    // - tryExtractChargeSpin() and reportEnergy() must then be called from the
+    //   owning thread in frame order to reproduce parse()'s side effects
+    std::optional<double> extractEnergy(std::string_view comment, EnergyFormat* format) const;
+    void tryExtractChargeSpin(std::string_view comment, data::ParsedData& data, int frameNumber);
+    void reportEnergy(EnergyFormat format, double energy);
+    void pinFormat(EnergyFormat format);
 
 private:
     LogFn infoLog_;
     LogFn debugLog_;
     EnergyExtractorPipeline energyPipeline_;
-
-    void tryExtractChargeSpin(const std::string& comment, data::ParsedData& data, int frameNumber);
 };
 
 } // namespace xyz
@@ -2,28 +2,53 @@
 
 #include <algorithm>
 #include <cctype>
+#include <memory>
 #include <sstream>
 
+#include "concurrency/thread_pool.h"
+#include "io/decompressor.h"
+#include "string/fixed_tokenizer.h"
+
 namespace fakeg {
 namespace parsers {
 
+namespace {
+
+// 帧数少于该值时不启动线程池
+constexpr size_t kMinParallelFrames = 64;
+// 每个任务至少解析的帧数
+constexpr size_t kMinChunkFrames = 16;
+// 每个解析窗口的最少帧数
+constexpr size_t kWindowFrames = 256;
+
+} // namespace
+
 XyzParser::XyzParser()
     : totalFrames(0),
       framesWithEnergy(0),
+      threadCount(0),
+      hasPendingLine(false),
       commentParser(
           [this](const std::string& msg) { this->infoLog(msg); },
           [this](const std::string& msg) { this->debugLog(msg); }) {}
 
 bool XyzParser::parse(io::FileReader& reader, data::ParsedData& data) {
-    std::ifstream& file = reader.getStream();
+    std::istream& file = reader.getStream();
     
     infoLog("Starting XYZ trajectory file parsing");
     
-    // 重置文件位置
-    string_utils::LineProcessor::resetToBeginning(file);
+    // 重置文件位置（只能顺序读取的输入无法回退，本来就在开头）
+    if (!reader.isSequential()) {
+        string_utils::LineProcessor::resetToBeginning(file);
+    }
     
     // 解析XYZ轨迹
-    if (parseXyzTrajectory(file, data)) {
+    // 映射模式下使用两阶段并行解析（帧边界扫描需要完整内容）；调试模式保持逐帧顺序解析，
+    // 保证逐行调试日志的顺序。标准输入和压缩文件不读入内存，逐帧顺序解析
+    const bool parallel = reader.isMapped() && threadCount != 1 && !isDebugEnabled();
+    const bool parsed = parallel ? parseXyzTrajectoryParallel(reader.view(), data)
+                                 : parseXyzTrajectory(file, data);
+    if (parsed) {
         data.hasOpt = true;
         infoLog("XYZ trajectory parsing completed");
         
@@ -42,16 +67,16 @@ bool XyzParser::parse(io::FileReader& reader, data::ParsedData& data) {
 }
 
 bool XyzParser::validateInput(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // Read through io::readFileHead so compressed inputs are checked after decompression
+    std::string head;
+    if (!io::readFileHead(filename, head, 4096)) {
         errorLog("Cannot open file: " + filename);
         return false;
     }
     
     // Basic XYZ format validation - check first few lines
-    std::string line;
-    if (std::getline(file, line)) {
-        line = string_utils::trim(line);
+    if (!head.empty()) {
+        std::string line = string_utils::trim(head.substr(0, head.find('\n')));
         if (!string_utils::isValidNumber(line) || string_utils::toInt(line, 0) <= 0) {
             errorLog("Invalid XYZ format: first line should contain positive atom count");
             return false;
@@ -73,18 +98,40 @@ std::vector<std::string> XyzParser::getSupportedKeywords() const {
     return {"XYZ", "TRJ", "TRAJECTORY"};
 }
 
-bool XyzParser::parseXyzTrajectory(std::ifstream& file, data::ParsedData& data) {
-    string_utils::LineProcessor::resetToBeginning(file);
+int XyzParser::scoreContent(std::string_view head) const {
+    // 与 validateInput 相同：第一个非空行必须是正的原子数
+    io::LineIterator lines(head);
+    std::string_view line;
+    while (lines.next(line) && string_utils::trimView(line).empty()) {}
+    
+    line = string_utils::trimView(line);
+    if (line.empty() || !string_utils::isValidNumber(line) || string_utils::toInt(line, 0) <= 0) {
+        return 0;
+    }
     
+    // 注释行之后的第一行应是原子行（元素符号 + 三个坐标）
+    data::Atom atom;
+    if (!lines.next(line) || !lines.next(line) || !fillAtom(string_utils::trimView(line), atom)) {
+        return 20;
+    }
+    return data::elements::isKnown(atom.symbol) ? 80 : 60;
+}
+
+void XyzParser::setThreadCount(size_t threads) {
+    threadCount = threads;
+}
+
+bool XyzParser::parseXyzTrajectory(std::istream& file, data::ParsedData& data) {
     totalFrames = 0;
     framesWithEnergy = 0;
+    hasPendingLine = false;
 
     // Reset per-run comment parsing state (one-time format detection logging).
     commentParser.reset();
     
     std::string line;
     
-    while (std::getline(file, line)) {
+    while (nextLine(file, line)) {
         line = string_utils::trim(line);
         
         // 跳过空行
@@ -99,10 +146,13 @@ bool XyzParser::parseXyzTrajectory(std::ifstream& file, data::ParsedData& data)
                 
                 if (parseXyzFrame(file, step, totalFrames + 1, data)) {
                     if (!step.atoms.empty()) {
-                        data.optSteps.push_back(step);
+                        const size_t atomCount = step.atoms.size();
+                        if (!emitStep(data, step)) {
+                            break;
+                        }
                         totalFrames++;
                         debugLog("Added frame " + std::to_string(totalFrames) + 
-                                " with " + std::to_string(step.atoms.size()) + " atoms");
+                                " with " + std::to_string(atomCount) + " atoms");
                     }
                 } else {
                     errorLog("Failed to parse frame " + std::to_string(totalFrames + 1));
@@ -115,11 +165,11 @@ bool XyzParser::parseXyzTrajectory(std::ifstream& file, data::ParsedData& data)
     return totalFrames > 0;
 }
 
-bool XyzParser::parseXyzFrame(std::ifstream& file, data::OptStep& step, int frameNumber, data::ParsedData& data) {
+bool XyzParser::parseXyzFrame(std::istream& file, data::OptStep& step, int frameNumber, data::ParsedData& data) {
     std::string commentLine;
     
     // 读取注释行
-    if (!std::getline(file, commentLine)) {
+    if (!nextLine(file, commentLine)) {
         errorLog("Failed to read comment line for frame " + std::to_string(frameNumber));
         return false;
     }
@@ -140,9 +190,9 @@ bool XyzParser::parseXyzFrame(std::ifstream& file, data::OptStep& step, int fram
     step.converged = false;
     
     // 读取原子坐标
-    std::string atomLine;
-    while (std::getline(file, atomLine)) {
-        atomLine = string_utils::trim(atomLine);
+    std::string rawLine;
+    while (std::getline(file, rawLine)) {
+        const std::string_view atomLine = string_utils::trimView(rawLine);
         
         // 如果遇到空行或数字行（下一帧开始），停止读取当前帧
         if (atomLine.empty()) {
@@ -150,8 +200,9 @@ bool XyzParser::parseXyzFrame(std::ifstream& file, data::OptStep& step, int fram
         }
         
         if (string_utils::isValidNumber(atomLine)) {
-            // 回退一行，这是下一帧的原子数
-            file.seekg(-static_cast<int>(atomLine.length() + 1), std::ios::cur);
+            // 这是下一帧的原子数，退回给 nextLine
+            pendingLine.assign(atomLine);
+            hasPendingLine = true;
             break;
         }
         
@@ -165,31 +216,228 @@ bool XyzParser::parseXyzFrame(std::ifstream& file, data::OptStep& step, int fram
     return !step.atoms.empty();
 }
 
-bool XyzParser::parseAtomLine(const std::string& line, data::Atom& atom) {
-    std::istringstream iss(line);
-    std::string symbol;
+bool XyzParser::nextLine(std::istream& file, std::string& line) {
+    if (hasPendingLine) {
+        line.swap(pendingLine);
+        hasPendingLine = false;
+        return true;
+    }
+    return static_cast<bool>(std::getline(file, line));
+}
+
+bool XyzParser::parseAtomLine(std::string_view line, data::Atom& atom) {
+    if (fillAtom(line, atom)) {
+        if (isDebugEnabled()) {
+            debugLog("Parsed atom: " + atom.symbol.str() + " (" + std::to_string(atom.atomicNumber) + ") " +
+                     std::to_string(atom.x) + " " + std::to_string(atom.y) + " " + std::to_string(atom.z));
+        }
+        return true;
+    } else {
+        errorLog("Failed to parse atom line: " + std::string(line));
+        atom.symbol = "";
+        return false;
+    }
+}
+
+bool XyzParser::fillAtom(std::string_view line, data::Atom& atom) const {
+    // 行格式: Symbol X Y Z [...]
+    const string_utils::FixedTokenizer<4> fields(line);
     double x, y, z;
     
-    if (iss >> symbol >> x >> y >> z) {
-        atom.symbol = symbol;
-        atom.x = x;
-        atom.y = y;
-        atom.z = z;
+    if (fields.empty() || !fields.get(1, x) || !fields.get(2, y) || !fields.get(3, z)) {
+        return false;
+    }
+    
+    atom.symbol = fields[0];
+    atom.atomicNumber = data::elements::atomicNumber(fields[0]);
+    atom.x = x;
+    atom.y = y;
+    atom.z = z;
+    return true;
+}
+
+bool XyzParser::parseXyzTrajectoryParallel(std::string_view content, data::ParsedData& data) {
+    totalFrames = 0;
+    framesWithEnergy = 0;
+    
+    // Reset per-run comment parsing state (one-time format detection logging).
+    commentParser.reset();
+    
+    // 第一阶段：单遍扫描帧边界
+    const std::vector<FrameSpan> spans = scanFrameBoundaries(content);
+    
+    // 第一帧的能量格式决定之后各帧只尝试哪个提取器，需在工作线程开始前确定
+    if (!spans.empty() && !spans.front().commentMissing) {
+        xyz::EnergyFormat format;
+        if (commentParser.extractEnergy(spans.front().comment, &format).has_value()) {
+            commentParser.pinFormat(format);
+        }
+    }
+    
+    // 第二阶段：按窗口把各帧分配给线程池解析，再按帧顺序提交。
+    // 内存中最多保留一个窗口的逐原子帧；非流式模式下提交的帧转存到 data.optSteps 的结构数组中
+    const size_t threads = threadCount == 0 ? concurrency::ThreadPool::defaultThreadCount() : threadCount;
+    const size_t window = std::max(kWindowFrames, threads * kMinChunkFrames * 2);
+    
+    std::unique_ptr<concurrency::ThreadPool> pool;
+    if (threads > 1 && spans.size() >= kMinParallelFrames) {
+        pool = std::make_unique<concurrency::ThreadPool>(threads);
+    }
+    if (!isStreaming() && !spans.empty() && !spans.front().commentMissing) {
+        // 按第一帧的原子数预留坐标（原子数行的值可能不可信，按原子行所占字节数限制）
+        const FrameSpan& first = spans.front();
+        const size_t atoms = std::min(static_cast<size_t>(first.declaredAtoms), (first.atomsEnd - first.atomsBegin) / 7 + 1);
+        data.optSteps.reserve(data.optSteps.size() + spans.size(), atoms);
+    }
+    
+    std::vector<data::OptStep> frames;
+    std::vector<FrameResult> results;
+    bool stopped = false;
+    
+    for (size_t windowBegin = 0; windowBegin < spans.size() && !stopped; windowBegin += window) {
+        const size_t count = std::min(window, spans.size() - windowBegin);
+        frames.assign(count, data::OptStep());
+        results.assign(count, FrameResult());
         
-        // 通过ElementMap获取原子序数
-        if (elementMap) {
-            atom.atomicNumber = elementMap->getAtomicNumber(symbol);
+        auto parseRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const size_t frame = windowBegin + i;
+                parseFrameSpan(content, spans[frame], static_cast<int>(frame + 1), frames[i], results[i]);
+            }
+        };
+        
+        if (pool && count >= kMinParallelFrames) {
+            const size_t chunkSize = std::max(kMinChunkFrames, count / (threads * 8));
+            pool->parallelFor(count, chunkSize, parseRange);
         } else {
-            atom.atomicNumber = 0; // 默认为碳
+            parseRange(0, count);
         }
         
-        debugLog("Parsed atom: " + symbol + " (" + std::to_string(atom.atomicNumber) + ") " +
-                 std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z));
-        return true;
-    } else {
-        errorLog("Failed to parse atom line: " + line);
-        atom.symbol = "";
-        return false;
+        // 按帧顺序补上日志和电荷/自旋，失败帧的处理与顺序解析一致（在该帧处停止）
+        for (size_t i = 0; i < count; i++) {
+            const int frameNumber = static_cast<int>(windowBegin + i + 1);
+            const FrameSpan& span = spans[windowBegin + i];
+            const FrameResult& result = results[i];
+            data::OptStep& step = frames[i];
+            
+            if (span.commentMissing) {
+                errorLog("Failed to read comment line for frame " + std::to_string(frameNumber));
+                errorLog("Failed to parse frame " + std::to_string(frameNumber));
+                stopped = true;
+                break;
+            }
+            
+            // 电荷/自旋只从第一帧读取（须在提交第一帧之前，流式写出的头部需要它）
+            if (frameNumber == 1) {
+                commentParser.tryExtractChargeSpin(span.comment, data, frameNumber);
+            }
+            
+            if (result.hasEnergy) {
+                commentParser.reportEnergy(result.energyFormat, step.energy);
+                framesWithEnergy++;
+            }
+            
+            for (const auto& line : result.badAtomLines) {
+                errorLog("Failed to parse atom line: " + line);
+            }
+            
+            if (step.atoms.empty()) {
+                errorLog("Failed to parse frame " + std::to_string(frameNumber));
+                stopped = true;
+                break;
+            }
+            
+            if (!emitStep(data, step)) {
+                stopped = true;
+                break;
+            }
+            totalFrames++;
+        }
+    }
+    
+    return totalFrames > 0;
+}
+
+std::vector<XyzParser::FrameSpan> XyzParser::scanFrameBoundaries(std::string_view content) const {
+    // 逐行复现 parseXyzTrajectory/parseXyzFrame 的控制流，只记录位置不解析内容
+    std::vector<FrameSpan> spans;
+    io::LineIterator lines(content);
+    std::string_view raw;
+    std::string_view pending;  // 与 parseXyzFrame 相同，终止帧的原子数行作为下一帧的原子数行
+    
+    while (!pending.empty() || lines.next(raw)) {
+        const std::string_view line = pending.empty() ? string_utils::trimView(raw) : pending;
+        pending = std::string_view();
+        
+        // 跳过空行和非原子数行
+        if (line.empty() || !string_utils::isValidNumber(line)) continue;
+        const int numAtoms = string_utils::toInt(line, 0);
+        if (numAtoms <= 0) continue;
+        
+        FrameSpan span{};
+        span.declaredAtoms = numAtoms;
+        
+        if (!lines.next(raw)) {
+            span.commentMissing = true;
+            spans.push_back(span);
+            break;
+        }
+        
+        span.comment = string_utils::trimView(raw);
+        span.atomsBegin = lines.position();
+        span.atomsEnd = content.size();
+        
+        while (lines.next(raw)) {
+            const std::string_view atomLine = string_utils::trimView(raw);
+            if (atomLine.empty()) {
+                span.atomsEnd = lines.offset();
+                break;
+            }
+            if (string_utils::isValidNumber(atomLine)) {
+                span.atomsEnd = lines.offset();
+                pending = atomLine;
+                break;
+            }
+        }
+        
+        spans.push_back(span);
+    }
+    
+    return spans;
+}
+
+void XyzParser::parseFrameSpan(std::string_view content, const FrameSpan& span, int frameNumber,
+                               data::OptStep& step, FrameResult& result) const {
+    step.stepNumber = frameNumber;
+    step.converged = false; // XYZ轨迹中没有收敛信息
+    step.energy = -100.0;   // 默认能量值
+    
+    if (span.commentMissing) {
+        return;
+    }
+    
+    xyz::EnergyFormat format;
+    const auto energy = commentParser.extractEnergy(span.comment, &format);
+    if (energy.has_value()) {
+        step.energy = *energy;
+        result.hasEnergy = true;
+        result.energyFormat = format;
+    }
+    
+    // 原子数行的值可能不可信，按原子行所占字节数限制预留大小
+    const size_t maxAtoms = (span.atomsEnd - span.atomsBegin) / 7 + 1;
+    step.atoms.reserve(std::min(static_cast<size_t>(span.declaredAtoms), maxAtoms));
+    
+    io::LineIterator lines(content.substr(0, span.atomsEnd), span.atomsBegin);
+    std::string_view raw;
+    while (lines.next(raw)) {
+        const std::string_view atomLine = string_utils::trimView(raw);
+        data::Atom atom;
+        if (fillAtom(atomLine, atom)) {
+            step.atoms.push_back(atom);
+        } else {
+            result.badAtomLines.emplace_back(atomLine);
+        }
     }
 }
 
@@ -4,8 +4,6 @@
 #include "parsers/xyz/xyz_comment_parser.h"
 #include "string/string_utils.h"
 
-#include <regex>
-
 namespace fakeg {
 namespace parsers {
 
@@ -20,18 +18,54 @@ public:
     std::string getParserName() const override;
     std::string getParserVersion() const override;
     std::vector<std::string> getSupportedKeywords() const override;
+    int scoreContent(std::string_view head) const override;
+    bool supportsStreaming() const override { return true; }
+    
+    // 并行解析使用的线程数：0 为自动（硬件线程数），1 为逐帧顺序解析
+    void setThreadCount(size_t threads) override;
 
 private:
+    // 帧边界扫描的结果：一帧在映射内容中的位置
+    struct FrameSpan {
+        std::string_view comment;   // 已trim的注释行
+        size_t atomsBegin;          // 第一条原子行的起始偏移
+        size_t atomsEnd;            // 原子行结束位置（终止行的起始偏移或文件末尾）
+        int declaredAtoms;          // 原子数行给出的原子数
+        bool commentMissing;        // 原子数行之后已到文件末尾
+    };
+    
+    // 并行解析时每帧带回调用线程的附加信息（日志在调用线程按帧顺序输出）
+    struct FrameResult {
+        bool hasEnergy = false;
+        xyz::EnergyFormat energyFormat = xyz::EnergyFormat::Orca;
+        std::vector<std::string> badAtomLines;
+    };
+    
     // XYZ解析方法
-    bool parseXyzTrajectory(std::ifstream& file, data::ParsedData& data);
-    bool parseXyzFrame(std::ifstream& file, data::OptStep& step, int frameNumber, data::ParsedData& data);
+    bool parseXyzTrajectory(std::istream& file, data::ParsedData& data);
+    bool parseXyzFrame(std::istream& file, data::OptStep& step, int frameNumber, data::ParsedData& data);
+    // 读取下一行：有退回的行时先返回它，输入只需顺序读取（标准输入、压缩文件）
+    bool nextLine(std::istream& file, std::string& line);
+    
+    // 两阶段解析：先单遍扫描帧边界，再把各帧分配给线程池解析，按帧顺序提交
+    bool parseXyzTrajectoryParallel(std::string_view content, data::ParsedData& data);
+    std::vector<FrameSpan> scanFrameBoundaries(std::string_view content) const;
+    void parseFrameSpan(std::string_view content, const FrameSpan& span, int frameNumber,
+                        data::OptStep& step, FrameResult& result) const;
     
     // 辅助方法
-    bool parseAtomLine(const std::string& line, data::Atom& atom);  // 改为返回bool
+    bool parseAtomLine(std::string_view line, data::Atom& atom);  // 改为返回bool
+    bool fillAtom(std::string_view line, data::Atom& atom) const; // 不写日志，可在工作线程中调用
     
     // 统计信息
     int totalFrames;
     int framesWithEnergy;
+    
+    size_t threadCount;
+    
+    // 逐帧解析时读多了的一行（下一帧的原子数行），由 nextLine 先返回
+    std::string pendingLine;
+    bool hasPendingLine;
 
     // Comment parsing pipeline (energy + charge/spin)
     xyz::XyzCommentParser commentParser;
@@ -0,0 +1,288 @@
+#include "byte_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if !defined(FAKEG_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define FAKEG_BYTE_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace fakeg {
+namespace string_utils {
+namespace byte_search {
+
+namespace {
+
+// 各实现的函数表
+// findPair: 返回第一个满足 data[i] == a 且 data[i + gap] == b 的 i（i < count），
+// 调用方保证 data[count - 1 + gap] 可读
+struct Kernels {
+    size_t (*findByte)(const char* data, size_t size, char c);
+    size_t (*findLastByte)(const char* data, size_t size, char c);
+    size_t (*countByte)(const char* data, size_t size, char c);
+    size_t (*findPair)(const char* data, size_t count, char a, char b, size_t gap);
+    const char* name;
+};
+
+// 标量实现
+size_t scalarFindByte(const char* data, size_t size, char c) {
+    const void* hit = std::memchr(data, c, size);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - data) : npos;
+}
+
+size_t scalarFindLastByte(const char* data, size_t size, char c) {
+    while (size > 0) {
+        size--;
+        if (data[size] == c) {
+            return size;
+        }
+    }
+    return npos;
+}
+
+size_t scalarCountByte(const char* data, size_t size, char c) {
+    return static_cast<size_t>(std::count(data, data + size, c));
+}
+
+size_t scalarFindPair(const char* data, size_t count, char a, char b, size_t gap) {
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] == a && data[i + gap] == b) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+#ifdef FAKEG_BYTE_SEARCH_X86
+
+// SSE2实现（x86-64基线指令集，无需运行时检测）
+size_t sse2FindByte(const char* data, size_t size, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+    const size_t tail = scalarFindByte(data + i, size - i, c);
+    return tail == npos ? npos : i + tail;
+}
+
+size_t sse2FindLastByte(const char* data, size_t size, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = size;
+    for (; i >= 16; i -= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0) {
+            return i - 16 + static_cast<size_t>(31 - __builtin_clz(static_cast<unsigned>(mask)));
+        }
+    }
+    return scalarFindLastByte(data, i, c);
+}
+
+size_t sse2CountByte(const char* data, size_t size, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        total += static_cast<size_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)))));
+    }
+    return total + scalarCountByte(data + i, size - i, c);
+}
+
+size_t sse2FindPair(const char* data, size_t count, char a, char b, size_t gap) {
+    const __m128i first = _mm_set1_epi8(a);
+    const __m128i second = _mm_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + gap));
+        const int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockA, first), _mm_cmpeq_epi8(blockB, second)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+    const size_t tail = scalarFindPair(data + i, count - i, a, b, gap);
+    return tail == npos ? npos : i + tail;
+}
+
+// AVX2实现（运行时检测到CPU支持时启用）
+__attribute__((target("avx2")))
+size_t avx2FindByte(const char* data, size_t size, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    const size_t tail = sse2FindByte(data + i, size - i, c);
+    return tail == npos ? npos : i + tail;
+}
+
+__attribute__((target("avx2")))
+size_t avx2FindLastByte(const char* data, size_t size, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = size;
+    for (; i >= 32; i -= 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return i - 32 + static_cast<size_t>(31 - __builtin_clz(mask));
+        }
+    }
+    return sse2FindLastByte(data, i, c);
+}
+
+__attribute__((target("avx2")))
+size_t avx2CountByte(const char* data, size_t size, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        total += static_cast<size_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)))));
+    }
+    return total + sse2CountByte(data + i, size - i, c);
+}
+
+__attribute__((target("avx2")))
+size_t avx2FindPair(const char* data, size_t count, char a, char b, size_t gap) {
+    const __m256i first = _mm256_set1_epi8(a);
+    const __m256i second = _mm256_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i blockA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i blockB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + gap));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockA, first), _mm256_cmpeq_epi8(blockB, second))));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    const size_t tail = sse2FindPair(data + i, count - i, a, b, gap);
+    return tail == npos ? npos : i + tail;
+}
+
+#endif // FAKEG_BYTE_SEARCH_X86
+
+constexpr Kernels kScalar{scalarFindByte, scalarFindLastByte, scalarCountByte, scalarFindPair, "scalar"};
+#ifdef FAKEG_BYTE_SEARCH_X86
+constexpr Kernels kSse2{sse2FindByte, sse2FindLastByte, sse2CountByte, sse2FindPair, "sse2"};
+constexpr Kernels kAvx2{avx2FindByte, avx2FindLastByte, avx2CountByte, avx2FindPair, "avx2"};
+#endif
+
+// name 对应的实现，当前CPU不支持时返回nullptr
+const Kernels* supportedKernels(std::string_view name) {
+#ifdef FAKEG_BYTE_SEARCH_X86
+    __builtin_cpu_init();
+    if (name == kAvx2.name) {
+        return __builtin_cpu_supports("avx2") ? &kAvx2 : nullptr;
+    }
+    if (name == kSse2.name) {
+        return &kSse2;
+    }
+#endif
+    return name == kScalar.name ? &kScalar : nullptr;
+}
+
+std::atomic<const Kernels*>& selected() {
+    static std::atomic<const Kernels*> kernels = [] {
+        for (const char* name : {"avx2", "sse2"}) {
+            if (const Kernels* supported = supportedKernels(name)) {
+                return supported;
+            }
+        }
+        return &kScalar;
+    }();
+    return kernels;
+}
+
+const Kernels& kernels() {
+    return *selected().load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+size_t findByte(std::string_view text, char c, size_t from) {
+    if (from >= text.size()) {
+        return npos;
+    }
+    const size_t hit = kernels().findByte(text.data() + from, text.size() - from, c);
+    return hit == npos ? npos : from + hit;
+}
+
+size_t findLastByte(std::string_view text, char c, size_t before) {
+    const size_t size = std::min(before, text.size());
+    return kernels().findLastByte(text.data(), size, c);
+}
+
+size_t countByte(std::string_view text, char c) {
+    return kernels().countByte(text.data(), text.size(), c);
+}
+
+size_t findSubstring(std::string_view text, std::string_view needle, size_t from) {
+    if (from > text.size()) {
+        return npos;
+    }
+    if (needle.empty()) {
+        return from;
+    }
+    if (needle.size() == 1) {
+        return findByte(text, needle.front(), from);
+    }
+    if (needle.size() > text.size() - from) {
+        return npos;
+    }
+
+    // 第二个筛选字节：第一个与首字节不同的字节（全部相同时取最后一个字节）
+    size_t gap = 1;
+    while (gap + 1 < needle.size() && needle[gap] == needle.front()) {
+        gap++;
+    }
+
+    const Kernels& k = kernels();
+    const char* data = text.data();
+    const size_t last = text.size() - needle.size();  // 最后一个可能的起点
+
+    for (size_t pos = from; pos <= last;) {
+        const size_t hit = k.findPair(data + pos, last - pos + 1, needle.front(), needle[gap], gap);
+        if (hit == npos) {
+            return npos;
+        }
+        pos += hit;
+        if (std::memcmp(data + pos, needle.data(), needle.size()) == 0) {
+            return pos;
+        }
+        pos++;
+    }
+    return npos;
+}
+
+const char* activeKernel() {
+    return kernels().name;
+}
+
+bool selectKernel(std::string_view name) {
+    const Kernels* supported = supportedKernels(name);
+    if (!supported) {
+        return false;
+    }
+    selected().store(supported, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace byte_search
+} // namespace string_utils
+} // namespace fakeg
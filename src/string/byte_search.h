@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace fakeg {
+namespace string_utils {
+
+// 缓冲区字节查找内核
+//
+// 换行符和长标记（如TD-DFT段落的"========="横幅）的查找是整个解析过程中最热的循环。
+// 这里提供按块比较的SIMD实现，运行时根据CPU选择AVX2或SSE2版本，其余平台使用标量实现。
+//
+// Notes:
+// - 所有函数的返回值语义与 std::string_view::find 一致，找不到时返回 npos
+// - 编译时定义 FAKEG_NO_SIMD 可强制使用标量实现
+namespace byte_search {
+
+constexpr size_t npos = std::string_view::npos;
+
+// 从 from 开始查找字节 c 第一次出现的位置
+size_t findByte(std::string_view text, char c, size_t from = 0);
+
+// 在 [0, before) 范围内查找字节 c 最后一次出现的位置
+size_t findLastByte(std::string_view text, char c, size_t before = npos);
+
+// 统计字节 c 的出现次数（例如统计行数）
+size_t countByte(std::string_view text, char c);
+
+// 从 from 开始查找子串 needle 第一次出现的位置（needle 为空时返回 from）
+//
+// 同时比较needle的首字节和第一个与首字节不同的字节来筛选候选位置，只对候选位置做完整比较，
+// 因此"========= Excitation ..."这类以重复字符开头的标记在分隔线上也不会产生大量候选。
+size_t findSubstring(std::string_view text, std::string_view needle, size_t from = 0);
+
+// 当前使用的实现："avx2"、"sse2" 或 "scalar"
+const char* activeKernel();
+
+// 改用指定的实现（"avx2"、"sse2"、"scalar"），CPU或编译选项不支持时返回false且不切换。
+// 供测试比较各实现的结果，不应在其它线程查找时调用
+bool selectKernel(std::string_view name);
+
+} // namespace byte_search
+
+} // namespace string_utils
+} // namespace fakeg
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "string/string_utils.h"
+
+namespace fakeg {
+namespace string_utils {
+
+// 固定容量的空白分隔tokenizer
+//
+// 字段以string_view保存在栈上的数组里，切分一行不做任何堆分配。
+// 切分规则与 istream >> std::string 一致（空格、制表符、换行等均视为分隔符）。
+//
+// Notes:
+// - 超过 N 的字段不会保存，truncated() 为true；size() 不超过 N
+// - 字段引用原始行，行的生命周期必须覆盖tokenizer的使用
+template<size_t N>
+class FixedTokenizer {
+private:
+    std::array<std::string_view, N> fields_;
+    size_t count_;
+    bool truncated_;
+
+public:
+    FixedTokenizer() : count_(0), truncated_(false) {}
+    explicit FixedTokenizer(std::string_view line) { split(line); }
+
+    // 切分一行，返回保存的字段数
+    size_t split(std::string_view line) {
+        count_ = 0;
+        truncated_ = false;
+
+        size_t pos = 0;
+        for (std::string_view token = nextToken(line, pos); !token.empty(); token = nextToken(line, pos)) {
+            if (count_ == N) {
+                truncated_ = true;
+                break;
+            }
+            fields_[count_++] = token;
+        }
+        return count_;
+    }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    bool truncated() const { return truncated_; }
+    static constexpr size_t capacity() { return N; }
+
+    // 越界时返回空字段
+    std::string_view operator[](size_t index) const {
+        return index < count_ ? fields_[index] : std::string_view();
+    }
+
+    // 将第index个字段解析为数值（语义同 parseNumber），字段不存在或无法转换时返回false
+    template<typename T>
+    bool get(size_t index, T& value) const {
+        return index < count_ && parseNumber(fields_[index], value);
+    }
+
+    const std::string_view* begin() const { return fields_.data(); }
+    const std::string_view* end() const { return fields_.data() + count_; }
+};
+
+} // namespace string_utils
+} // namespace fakeg
@@ -0,0 +1,134 @@
+#include "multi_pattern_scanner.h"
+
+#include <queue>
+
+namespace fakeg {
+namespace string_utils {
+
+MultiPatternScanner::MultiPatternScanner() : classCount_(1), compiled_(false) {
+    byteClass_.fill(0);
+    startByte_.fill(false);
+}
+
+MultiPatternScanner::MultiPatternScanner(const std::vector<std::string>& patterns) : MultiPatternScanner() {
+    for (const auto& pattern : patterns) {
+        addPattern(pattern);
+    }
+    compile();
+}
+
+size_t MultiPatternScanner::addPattern(const std::string& pattern) {
+    if (pattern.empty()) {
+        return npos;
+    }
+    patterns_.push_back(pattern);
+    compiled_ = false;
+    return patterns_.size() - 1;
+}
+
+size_t MultiPatternScanner::patternCount() const {
+    return patterns_.size();
+}
+
+const std::string& MultiPatternScanner::pattern(size_t id) const {
+    return patterns_[id];
+}
+
+void MultiPatternScanner::compile() {
+    // 字母表压缩
+    byteClass_.fill(0);
+    startByte_.fill(false);
+    classCount_ = 1;
+    for (const auto& pattern : patterns_) {
+        startByte_[static_cast<unsigned char>(pattern.front())] = true;
+        for (char c : pattern) {
+            unsigned char b = static_cast<unsigned char>(c);
+            if (byteClass_[b] == 0) {
+                byteClass_[b] = static_cast<uint8_t>(classCount_++);
+            }
+        }
+    }
+
+    // 构建trie（-1表示尚无转移）
+    std::vector<int64_t> trie(classCount_, -1);
+    std::vector<std::vector<uint32_t>> stateOutputs(1);
+    size_t stateCount = 1;
+
+    for (size_t id = 0; id < patterns_.size(); id++) {
+        size_t state = 0;
+        for (char c : patterns_[id]) {
+            const size_t cls = byteClass_[static_cast<unsigned char>(c)];
+            int64_t& next = trie[state * classCount_ + cls];
+            if (next < 0) {
+                next = static_cast<int64_t>(stateCount++);
+                trie.resize(stateCount * classCount_, -1);
+                stateOutputs.emplace_back();
+            }
+            state = static_cast<size_t>(trie[state * classCount_ + cls]);
+        }
+        stateOutputs[state].push_back(static_cast<uint32_t>(id));
+    }
+
+    // BFS计算失败链接，同时把trie补全为DFA
+    transitions_.assign(stateCount * classCount_, 0);
+    std::vector<uint32_t> fail(stateCount, 0);
+    std::queue<uint32_t> queue;
+
+    for (size_t cls = 0; cls < classCount_; cls++) {
+        const int64_t next = trie[cls];
+        if (next >= 0) {
+            transitions_[cls] = static_cast<uint32_t>(next);
+            fail[next] = 0;
+            queue.push(static_cast<uint32_t>(next));
+        }
+    }
+
+    while (!queue.empty()) {
+        const uint32_t state = queue.front();
+        queue.pop();
+
+        // 继承失败链接上的输出
+        const auto& inherited = stateOutputs[fail[state]];
+        stateOutputs[state].insert(stateOutputs[state].end(), inherited.begin(), inherited.end());
+
+        for (size_t cls = 0; cls < classCount_; cls++) {
+            const int64_t next = trie[state * classCount_ + cls];
+            if (next >= 0) {
+                fail[next] = transitions_[fail[state] * classCount_ + cls];
+                transitions_[state * classCount_ + cls] = static_cast<uint32_t>(next);
+                queue.push(static_cast<uint32_t>(next));
+            } else {
+                transitions_[state * classCount_ + cls] = transitions_[fail[state] * classCount_ + cls];
+            }
+        }
+    }
+
+    // 扁平化输出表
+    outputBegin_.assign(stateCount + 1, 0);
+    outputs_.clear();
+    for (size_t state = 0; state < stateCount; state++) {
+        outputBegin_[state] = static_cast<uint32_t>(outputs_.size());
+        outputs_.insert(outputs_.end(), stateOutputs[state].begin(), stateOutputs[state].end());
+    }
+    outputBegin_[stateCount] = static_cast<uint32_t>(outputs_.size());
+
+    compiled_ = true;
+}
+
+bool MultiPatternScanner::isCompiled() const {
+    return compiled_;
+}
+
+bool MultiPatternScanner::findFirst(std::string_view text, size_t* patternId, size_t* offset) const {
+    bool found = false;
+    scan(text, [&](size_t id, size_t start) {
+        found = true;
+        if (patternId) *patternId = id;
+        if (offset) *offset = start;
+        return false;
+    });
+    return found;
+}
+
+} // namespace string_utils
+} // namespace fakeg
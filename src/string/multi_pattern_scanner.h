@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fakeg {
+namespace string_utils {
+
+// 多模式串扫描器（Aho-Corasick自动机）
+//
+// 一次遍历缓冲区即可找出所有已注册模式串的出现位置，
+// 扫描开销与模式串数量无关。
+//
+// Notes:
+// - 先 addPattern 注册，再 compile，之后的扫描均为只读操作（可多线程共享）
+// - 字母表按模式串中出现的字节压缩，转移表为完全DFA
+class MultiPatternScanner {
+private:
+    std::vector<std::string> patterns_;
+
+    // 字节 -> 字符类（0 表示未在任何模式串中出现的字节）
+    std::array<uint8_t, 256> byteClass_;
+    // 可作为某个模式串首字节的字节
+    std::array<bool, 256> startByte_;
+    size_t classCount_;
+
+    // transitions_[state * classCount_ + cls] -> 下一个状态
+    std::vector<uint32_t> transitions_;
+    // 每个状态命中的模式串（含后缀链接上的输出），扁平存储
+    std::vector<uint32_t> outputBegin_;
+    std::vector<uint32_t> outputs_;
+    bool compiled_;
+
+public:
+    MultiPatternScanner();
+    explicit MultiPatternScanner(const std::vector<std::string>& patterns);
+
+    // 注册模式串，返回模式串id（空串被忽略并返回 npos）
+    size_t addPattern(const std::string& pattern);
+    size_t patternCount() const;
+    const std::string& pattern(size_t id) const;
+
+    // 构建自动机
+    void compile();
+    bool isCompiled() const;
+
+    // 扫描文本，对每个命中调用 callback(patternId, startOffset)
+    // callback 返回 false 时提前结束扫描
+    template<typename Callback>
+    void scan(std::string_view text, Callback&& callback) const;
+
+    // 文本中是否包含任一模式串；命中时返回最先结束的模式串id
+    bool findFirst(std::string_view text, size_t* patternId = nullptr, size_t* offset = nullptr) const;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+};
+
+template<typename Callback>
+void MultiPatternScanner::scan(std::string_view text, Callback&& callback) const {
+    if (!compiled_ || patterns_.empty()) {
+        return;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    uint32_t state = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        // 处于根状态时快速跳过不可能开始匹配的字节
+        if (state == 0) {
+            while (i < size && !startByte_[data[i]]) {
+                i++;
+            }
+            if (i == size) {
+                break;
+            }
+        }
+
+        state = transitions_[state * classCount_ + byteClass_[data[i]]];
+
+        for (uint32_t k = outputBegin_[state]; k < outputBegin_[state + 1]; k++) {
+            const uint32_t id = outputs_[k];
+            if (!callback(static_cast<size_t>(id), i + 1 - patterns_[id].size())) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace string_utils
+} // namespace fakeg
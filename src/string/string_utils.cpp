@@ -1,5 +1,8 @@
 #include "string_utils.h"
 #include <cctype>
+#include <charconv>
+#include "string/byte_search.h"
+#include "io/memory_stream.h"
 
 namespace fakeg {
 namespace string_utils {
@@ -24,6 +27,13 @@ std::string rtrim(const std::string& str) {
     return str.substr(0, last + 1);
 }
 
+std::string_view trimView(std::string_view str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return std::string_view();
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, (last - first + 1));
+}
+
 // 字符串分割函数
 std::vector<std::string> split(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
@@ -86,8 +96,8 @@ bool endsWith(const std::string& str, const std::string& suffix) {
            str.substr(str.size() - suffix.size()) == suffix;
 }
 
-bool contains(const std::string& str, const std::string& substring) {
-    return str.find(substring) != std::string::npos;
+bool contains(std::string_view str, std::string_view substring) {
+    return str.find(substring) != std::string_view::npos;
 }
 
 std::string replace(const std::string& str, const std::string& from, const std::string& to) {
@@ -153,37 +163,130 @@ bool isInteger(const std::string& str) {
     return start < str.size();
 }
 
-double toDouble(const std::string& str, double defaultValue) {
-    try {
-        std::string processedStr = replaceAll(str, "D", "E"); // 处理BDF的D记数法
-        return std::stod(processedStr);
-    } catch (...) {
-        return defaultValue;
-    }
+double toDouble(std::string_view str, double defaultValue) {
+    double value;
+    return parseNumber(str, value) ? value : defaultValue;
+}
+
+int toInt(std::string_view str, int defaultValue) {
+    int value;
+    return parseNumber(str, value) ? value : defaultValue;
+}
+
+bool isValidNumber(std::string_view str) {
+    double value;
+    return parseNumber(str, value);
 }
 
-int toInt(const std::string& str, int defaultValue) {
-    try {
-        return std::stoi(str);
-    } catch (...) {
-        return defaultValue;
+// 与 std::isspace 在 "C" locale 下的判断一致
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// 跳过前导空白和正号（from_chars 不接受 '+'），返回数值部分的起始位置；
+// 正号后紧跟符号时（如 "+-1"）不是合法数值，返回 npos
+static size_t numberStart(std::string_view text) {
+    size_t start = 0;
+    while (start < text.size() && isBlank(text[start])) {
+        start++;
+    }
+    if (start < text.size() && text[start] == '+') {
+        start++;
+        if (start < text.size() && (text[start] == '+' || text[start] == '-')) {
+            return std::string_view::npos;
+        }
     }
+    return start;
 }
 
-bool isValidNumber(const std::string& str) {
-    if (str.empty()) return false;
+template<typename T>
+static bool parseFloating(std::string_view text, T& value, size_t* consumed) {
+    const size_t start = numberStart(text);
+    if (start == std::string_view::npos || start >= text.size()) {
+        return false;
+    }
     
-    std::string cleanStr = str;
-    // 处理科学记数法中的D
-    std::replace(cleanStr.begin(), cleanStr.end(), 'D', 'E');
-    std::replace(cleanStr.begin(), cleanStr.end(), 'd', 'e');
+    // 将数值部分复制到栈上的缓冲区，同时把 D/d 指数改写为 e
+    char buffer[128];
+    size_t length = 0;
+    while (start + length < text.size() && length < sizeof(buffer)) {
+        const char c = text[start + length];
+        if (c == 'D' || c == 'd') {
+            buffer[length++] = 'e';
+        } else if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E') {
+            buffer[length++] = c;
+        } else {
+            break;
+        }
+    }
     
-    try {
-        std::stod(cleanStr);
-        return true;
-    } catch (...) {
+    std::from_chars_result result;
+    if (length > 0 && length < sizeof(buffer)) {
+        result = std::from_chars(buffer, buffer + length, value);
+        if (result.ec == std::errc()) {
+            if (consumed) *consumed = start + static_cast<size_t>(result.ptr - buffer);
+            return true;
+        }
+        if (result.ec == std::errc::result_out_of_range) {
+            return false;
+        }
+    }
+    
+    // 超长数字或 inf/nan 等形式直接在原文上解析
+    const char* begin = text.data() + start;
+    result = std::from_chars(begin, text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
         return false;
     }
+    if (consumed) *consumed = start + static_cast<size_t>(result.ptr - begin);
+    return true;
+}
+
+template<typename T>
+static bool parseIntegral(std::string_view text, T& value, size_t* consumed) {
+    const size_t start = numberStart(text);
+    if (start == std::string_view::npos || start >= text.size()) {
+        return false;
+    }
+    
+    const char* begin = text.data() + start;
+    const std::from_chars_result result = std::from_chars(begin, text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    if (consumed) *consumed = start + static_cast<size_t>(result.ptr - begin);
+    return true;
+}
+
+bool parseNumber(std::string_view text, double& value, size_t* consumed) {
+    return parseFloating(text, value, consumed);
+}
+
+bool parseNumber(std::string_view text, float& value, size_t* consumed) {
+    return parseFloating(text, value, consumed);
+}
+
+bool parseNumber(std::string_view text, int& value, size_t* consumed) {
+    return parseIntegral(text, value, consumed);
+}
+
+bool parseNumber(std::string_view text, long& value, size_t* consumed) {
+    return parseIntegral(text, value, consumed);
+}
+
+std::string_view nextToken(std::string_view text, size_t& pos) {
+    if (pos >= text.size()) {
+        pos = text.size();
+        return std::string_view();
+    }
+    while (pos < text.size() && isBlank(text[pos])) {
+        pos++;
+    }
+    const size_t begin = pos;
+    while (pos < text.size() && !isBlank(text[pos])) {
+        pos++;
+    }
+    return text.substr(begin, pos - begin);
 }
 
 std::string removeQuotes(const std::string& str) {
@@ -211,8 +314,42 @@ std::string removeQuotes(const std::string& str) {
     return result;
 }
 
+// 流建立在内存缓冲区上时，直接在剩余内容中查找，不再逐行拷贝。
+// hit 为命中位置（相对剩余内容）；将读取位置移到命中行之后，流状态与 getline 读到该行后一致。
+static void finishBufferedLine(std::istream& file, io::MemoryStreamBuf& buffer, size_t hit) {
+    const std::string_view rest = buffer.unread();
+    const size_t newline = byte_search::findByte(rest, '\n', hit);
+    if (newline == byte_search::npos) {
+        // 最后一行没有换行符：getline 成功但置 eofbit
+        buffer.skip(rest.size());
+        file.setstate(std::ios::eofbit);
+    } else {
+        buffer.skip(newline + 1);
+    }
+}
+
+static void exhaustBuffer(std::istream& file, io::MemoryStreamBuf& buffer) {
+    buffer.skip(buffer.unread().size());
+    file.setstate(std::ios::eofbit | std::ios::failbit);
+}
+
+static io::MemoryStreamBuf* memoryBuffer(std::istream& file) {
+    return file.good() ? dynamic_cast<io::MemoryStreamBuf*>(file.rdbuf()) : nullptr;
+}
+
 // LineProcessor类实现
-bool LineProcessor::findLine(std::ifstream& file, const std::string& pattern) {
+bool LineProcessor::findLine(std::istream& file, const std::string& pattern) {
+    io::MemoryStreamBuf* buffer = memoryBuffer(file);
+    if (buffer && !pattern.empty() && pattern.find('\n') == std::string::npos) {
+        const size_t hit = byte_search::findSubstring(buffer->unread(), pattern);
+        if (hit == byte_search::npos) {
+            exhaustBuffer(file, *buffer);
+            return false;
+        }
+        finishBufferedLine(file, *buffer, hit);
+        return true;
+    }
+
     std::string line;
     while (std::getline(file, line)) {
         if (line.find(pattern) != std::string::npos) {
@@ -222,21 +359,43 @@ bool LineProcessor::findLine(std::ifstream& file, const std::string& pattern) {
     return false;
 }
 
-bool LineProcessor::findLineFromBeginning(std::ifstream& file, const std::string& pattern) {
+bool LineProcessor::findAnyLine(std::istream& file, const MultiPatternScanner& scanner, size_t* patternId) {
+    io::MemoryStreamBuf* buffer = memoryBuffer(file);
+    if (buffer) {
+        // 第一个命中（结束位置最早）必然落在第一个包含任一模式串的行内
+        size_t offset = 0;
+        if (!scanner.findFirst(buffer->unread(), patternId, &offset)) {
+            exhaustBuffer(file, *buffer);
+            return false;
+        }
+        finishBufferedLine(file, *buffer, offset);
+        return true;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (scanner.findFirst(line, patternId)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LineProcessor::findLineFromBeginning(std::istream& file, const std::string& pattern) {
     resetToBeginning(file);
     return findLine(file, pattern);
 }
 
-std::streampos LineProcessor::getPosition(std::ifstream& file) {
+std::streampos LineProcessor::getPosition(std::istream& file) {
     return file.tellg();
 }
 
-void LineProcessor::setPosition(std::ifstream& file, std::streampos pos) {
+void LineProcessor::setPosition(std::istream& file, std::streampos pos) {
     file.clear();
     file.seekg(pos);
 }
 
-void LineProcessor::resetToBeginning(std::ifstream& file) {
+void LineProcessor::resetToBeginning(std::istream& file) {
     file.clear();
     file.seekg(0, std::ios::beg);
 }
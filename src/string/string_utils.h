@@ -1,11 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 #include <fstream>
+#include <istream>
 #include <algorithm>
 
+#include "string/multi_pattern_scanner.h"
+
 namespace fakeg {
 namespace string_utils {
 
@@ -13,6 +17,7 @@ namespace string_utils {
 std::string trim(const std::string& str);
 std::string ltrim(const std::string& str);
 std::string rtrim(const std::string& str);
+std::string_view trimView(std::string_view str);  // 与 trim 相同，但返回原字符串的视图
 
 // 字符串分割函数
 std::vector<std::string> split(const std::string& str, char delimiter = ' ');
@@ -25,16 +30,30 @@ std::string toUpperCase(const std::string& str);
 // 字符串查找和替换
 bool startsWith(const std::string& str, const std::string& prefix);
 bool endsWith(const std::string& str, const std::string& suffix);
-bool contains(const std::string& str, const std::string& substring);
+bool contains(std::string_view str, std::string_view substring);
 std::string replace(const std::string& str, const std::string& from, const std::string& to);
 std::string replaceAll(const std::string& str, const std::string& from, const std::string& to);
 
 // 数值转换和验证
 bool isNumber(const std::string& str);
 bool isInteger(const std::string& str);
-double toDouble(const std::string& str, double defaultValue = 0.0);
-int toInt(const std::string& str, int defaultValue = 0);
-bool isValidNumber(const std::string& str);
+double toDouble(std::string_view str, double defaultValue = 0.0);
+int toInt(std::string_view str, int defaultValue = 0);
+bool isValidNumber(std::string_view str);
+
+// 数值解析（基于 std::from_chars：与locale无关、不抛异常、不分配内存）
+//
+// 语义与 std::stod/std::stoi 一致：跳过前导空白，解析最长的合法前缀，
+// 溢出时失败。浮点数额外接受Fortran风格的 D/d 指数（如 1.23D-04）。
+// consumed 返回数值结束位置相对 text 的偏移。
+bool parseNumber(std::string_view text, double& value, size_t* consumed = nullptr);
+bool parseNumber(std::string_view text, float& value, size_t* consumed = nullptr);
+bool parseNumber(std::string_view text, int& value, size_t* consumed = nullptr);
+bool parseNumber(std::string_view text, long& value, size_t* consumed = nullptr);
+
+// 从 pos 开始取下一个以空白分隔的token（与 istream >> std::string 的切分一致），
+// pos 前移到token之后；没有更多token时返回空
+std::string_view nextToken(std::string_view text, size_t& pos);
 
 // 引号处理
 std::string removeQuotes(const std::string& str);
@@ -42,36 +61,42 @@ std::string removeQuotes(const std::string& str);
 // 文件行处理函数
 class LineProcessor {
 public:
-    static bool findLine(std::ifstream& file, const std::string& pattern);
-    static bool findLineFromBeginning(std::ifstream& file, const std::string& pattern);
-    static std::streampos getPosition(std::ifstream& file);
-    static void setPosition(std::ifstream& file, std::streampos pos);
-    static void resetToBeginning(std::ifstream& file);
+    static bool findLine(std::istream& file, const std::string& pattern);
+    static bool findLineFromBeginning(std::istream& file, const std::string& pattern);
+    // 一次查找多个标记：读到包含任一模式串的行为止，patternId 返回该行最先命中的模式串（模式串不应含换行符）
+    static bool findAnyLine(std::istream& file, const MultiPatternScanner& scanner, size_t* patternId = nullptr);
+    static std::streampos getPosition(std::istream& file);
+    static void setPosition(std::istream& file, std::streampos pos);
+    static void resetToBeginning(std::istream& file);
 };
 
 // 数值解析辅助函数
+// 逐个解析行内以空白分隔的token，跳过无法转换的token。
+// 结果写入 values（先清空，复用已有容量），返回解析出的数值个数。
 template<typename T>
-std::vector<T> parseValuesFromLine(const std::string& line, int maxValues = -1) {
-    std::vector<T> values;
-    std::istringstream iss(line);
-    std::string token;
+size_t parseValuesFromLine(std::string_view line, std::vector<T>& values, int maxValues = -1) {
+    values.clear();
+    size_t pos = 0;
     
-    while (iss >> token && (maxValues < 0 || values.size() < static_cast<size_t>(maxValues))) {
-        try {
-            if constexpr (std::is_same_v<T, double>) {
-                values.push_back(std::stod(token));
-            } else if constexpr (std::is_same_v<T, float>) {
-                values.push_back(std::stof(token));
-            } else if constexpr (std::is_same_v<T, int>) {
-                values.push_back(std::stoi(token));
-            } else if constexpr (std::is_same_v<T, long>) {
-                values.push_back(std::stol(token));
-            }
-        } catch (...) {
-            // 跳过无法转换的token
+    while (maxValues < 0 || values.size() < static_cast<size_t>(maxValues)) {
+        const std::string_view token = nextToken(line, pos);
+        if (token.empty()) {
+            break;
+        }
+        
+        T value;
+        if (parseNumber(token, value)) {
+            values.push_back(value);
         }
     }
     
+    return values.size();
+}
+
+template<typename T>
+std::vector<T> parseValuesFromLine(std::string_view line, int maxValues = -1) {
+    std::vector<T> values;
+    parseValuesFromLine(line, values, maxValues);
     return values;
 }
 
@@ -0,0 +1,106 @@
+// byte_search 的SIMD实现与标量实现逐个比较：随机内容、各种长度和起点（覆盖块边界和尾部），
+// 以及以重复字符开头的标记（findSubstring 的筛选字节不是第二个字节）
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string/byte_search.h"
+#include "test_check.h"
+
+namespace bs = fakeg::string_utils::byte_search;
+
+namespace {
+
+// 字母表很小，匹配、相邻匹配和不匹配都足够常见
+std::string randomText(std::mt19937& rng, size_t size) {
+    static constexpr std::string_view kAlphabet = "==\n\n ab=";
+    std::uniform_int_distribution<size_t> pick(0, kAlphabet.size() - 1);
+    std::string text(size, ' ');
+    for (char& c : text) {
+        c = kAlphabet[pick(rng)];
+    }
+    return text;
+}
+
+// 用当前选中的实现跑一遍所有查询
+std::vector<size_t> runQueries(const std::vector<std::string>& texts, const std::vector<std::string>& needles) {
+    std::vector<size_t> results;
+    for (const std::string& text : texts) {
+        for (char c : {'\n', '=', 'a', 'z'}) {
+            results.push_back(bs::countByte(text, c));
+            for (size_t pos = 0; pos <= text.size() + 1; pos += 1 + pos / 16) {
+                results.push_back(bs::findByte(text, c, pos));
+                results.push_back(bs::findLastByte(text, c, pos));
+            }
+            results.push_back(bs::findLastByte(text, c));
+        }
+        for (const std::string& needle : needles) {
+            for (size_t pos = 0; pos <= text.size() + 1; pos += 1 + pos / 16) {
+                results.push_back(bs::findSubstring(text, needle, pos));
+            }
+        }
+    }
+    return results;
+}
+
+// 结果应与 std::string_view 一致（只检查标量实现，SIMD实现再与标量比较）
+void checkAgainstStringView(const std::vector<std::string>& texts, const std::vector<std::string>& needles) {
+    for (const std::string& text : texts) {
+        const std::string_view view(text);
+        for (size_t pos = 0; pos <= text.size() + 1; pos++) {
+            FAKEG_CHECK(bs::findByte(view, '\n', pos) == view.find('\n', pos), "findByte size " << text.size());
+            FAKEG_CHECK(bs::findLastByte(view, '=', pos) == (pos == 0 ? bs::npos : view.rfind('=', pos - 1)),
+                        "findLastByte size " << text.size());
+            for (const std::string& needle : needles) {
+                FAKEG_CHECK(bs::findSubstring(view, needle, pos) == view.find(needle, pos),
+                            "findSubstring \"" << needle << "\" size " << text.size() << " from " << pos);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20240611);
+    std::vector<std::string> texts;
+    for (size_t size = 0; size <= 200; size++) {
+        texts.push_back(randomText(rng, size));
+    }
+    for (size_t size : {255, 256, 257, 1023, 1024, 1025, 4099}) {
+        texts.push_back(randomText(rng, size));
+    }
+    // 标记只出现在末尾、跨越块边界或完全没有出现
+    texts.push_back(std::string(100, '=') + " Excitation");
+    texts.push_back(std::string(31, 'a') + "=========\n" + std::string(33, 'b'));
+    texts.push_back(std::string(500, '='));
+
+    const std::vector<std::string> needles = {
+        "\n", "==", "=\n", "a=", "\n\n ", "=========", "========= Excitation", "ab==\n", "zz",
+    };
+
+    FAKEG_CHECK(bs::selectKernel("scalar"), "scalar kernel must always be available");
+    checkAgainstStringView(texts, needles);
+    const std::vector<size_t> expected = runQueries(texts, needles);
+
+    for (const char* kernel : {"sse2", "avx2"}) {
+        if (!bs::selectKernel(kernel)) {
+            std::cout << "skip " << kernel << " (not supported here)" << std::endl;
+            continue;
+        }
+        const std::vector<size_t> actual = runQueries(texts, needles);
+        FAKEG_CHECK(actual.size() == expected.size(), kernel);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < actual.size() && i < expected.size(); i++) {
+            mismatches += actual[i] != expected[i] ? 1 : 0;
+        }
+        FAKEG_CHECK(mismatches == 0, kernel << ": " << mismatches << " of " << expected.size()
+                                            << " results differ from scalar");
+        std::cout << kernel << ": " << actual.size() << " queries checked" << std::endl;
+    }
+
+    return fakeg::tests::failureCount();
+}
@@ -0,0 +1,139 @@
+// 断点续转（--resume）回归测试
+//
+// 日志在某个位置截断时先转换一次（写出检查点），再把其余内容追加到文件末尾后续转，
+// 输出必须与对完整日志的一次普通转换逐字节相同。截断位置取每个步骤标记行的行首及其前后一个字节，
+// 以及均匀分布的若干位置（包括行中间）。
+//
+// 用法：resume_test <数据目录>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "app/fake_g_app.h"
+#include "parsers/amesp_parser.h"
+#include "parsers/bdf_parser.h"
+#include "test_check.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using ParserFactory = std::function<std::unique_ptr<fakeg::parsers::ParserInterface>()>;
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const fs::path& path, std::string_view content, bool append = false) {
+    std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+// 转换一次，返回是否成功；log 收集日志
+bool convert(const ParserFactory& makeParser, const fs::path& input, const fs::path& output, bool resume,
+             std::string& log) {
+    std::ostringstream stream;
+    fakeg::app::FakeGApp app(makeParser());
+    app.setProgramInfo("ResumeTest", "1.0.0", "");
+    app.setLogStream(&stream);
+    app.setResumeMode(resume);
+    app.setInputFile(input.string());
+    app.setOutputFile(output.string());
+    const bool converted = app.processFile();
+    log = stream.str();
+    return converted;
+}
+
+// 截断位置：步骤标记行首及前后一个字节，加上均匀分布的位置
+std::set<size_t> cutPoints(std::string_view content, std::string_view marker) {
+    std::set<size_t> cuts;
+    for (size_t hit = content.find(marker); hit != std::string_view::npos; hit = content.find(marker, hit + 1)) {
+        const size_t newline = content.rfind('\n', hit);
+        const size_t lineStart = newline == std::string_view::npos ? 0 : newline + 1;
+        for (size_t cut : {lineStart - 1, lineStart, lineStart + 1}) {
+            if (cut > 0 && cut < content.size()) {
+                cuts.insert(cut);
+            }
+        }
+    }
+    for (size_t i = 1; i < 16; i++) {
+        cuts.insert(content.size() * i / 16);
+    }
+    return cuts;
+}
+
+void checkFixture(const fs::path& dataDir, const fs::path& workDir, const std::string& name,
+                  std::string_view marker, const ParserFactory& makeParser) {
+    const std::string content = readFile(dataDir / name);
+    FAKEG_CHECK(!content.empty(), "missing fixture " << name);
+    if (content.empty()) {
+        return;
+    }
+
+    const fs::path input = workDir / name;
+    const fs::path expectedOutput = workDir / "expected.log";
+    const fs::path output = workDir / "resumed.log";
+
+    std::string log;
+    writeFile(input, content);
+    FAKEG_CHECK(convert(makeParser, input, expectedOutput, false, log), name << ": full conversion failed\n" << log);
+    const std::string expected = readFile(expectedOutput);
+
+    size_t resumed = 0;
+    for (size_t cut : cutPoints(content, marker)) {
+        fs::remove(output);
+        fs::remove(fakeg::app::ConversionCheckpoint::checkpointPath(output.string()));
+
+        // 截断的日志可能还解析不出任何步骤，这时没有检查点，续转退化为完整转换
+        writeFile(input, std::string_view(content).substr(0, cut));
+        convert(makeParser, input, output, true, log);
+
+        writeFile(input, std::string_view(content).substr(cut), true);
+        const bool converted = convert(makeParser, input, output, true, log);
+        FAKEG_CHECK(converted, name << " cut at " << cut << ": resumed conversion failed\n" << log);
+        FAKEG_CHECK(readFile(output) == expected, name << " cut at " << cut << ": output differs from a full run");
+        if (log.find("Resuming after step") != std::string::npos) {
+            resumed++;
+        }
+
+        // 输入没有变化时再续转一次，结果不变
+        FAKEG_CHECK(convert(makeParser, input, output, true, log) && readFile(output) == expected,
+                    name << " cut at " << cut << ": repeated resume changed the output");
+    }
+
+    // 至少一部分截断位置真正走了检查点路径，否则上面的比较没有意义
+    FAKEG_CHECK(resumed > 0, name << ": no cut point resumed from a checkpoint");
+    std::cout << name << ": " << resumed << " cut points resumed from a checkpoint" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: resume_test <data_dir>" << std::endl;
+        return 2;
+    }
+
+    const fs::path dataDir = argv[1];
+    const fs::path workDir = fs::temp_directory_path() / ("fakeg_resume_test_" + std::to_string(std::random_device{}()));
+    fs::create_directories(workDir);
+
+    checkFixture(dataDir, workDir, "a_opt.aop", "Geom Opt Step:",
+                 [] { return std::make_unique<fakeg::parsers::AmespParser>(); });
+    checkFixture(dataDir, workDir, "b_opt.out", "Geometry Optimization step :",
+                 [] { return std::make_unique<fakeg::parsers::BdfParser>(); });
+
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+    return fakeg::tests::failureCount();
+}
@@ -0,0 +1,87 @@
+// 流式输出回归测试
+//
+// 同一个输入分别用流式模式（逐步写出）和 --no-stream（解析完再整体写出）转换，
+// 两种输出必须逐字节相同
+//
+// 用法：streaming_test <数据目录>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "app/fake_g_app.h"
+#include "parsers/amesp_parser.h"
+#include "parsers/bdf_parser.h"
+#include "test_check.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using ParserFactory = std::function<std::unique_ptr<fakeg::parsers::ParserInterface>()>;
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// 转换一次，返回是否成功；log 收集日志
+bool convert(const ParserFactory& makeParser, const fs::path& input, const fs::path& output, bool streaming,
+             std::string& log) {
+    std::ostringstream stream;
+    fakeg::app::FakeGApp app(makeParser());
+    app.setProgramInfo("StreamingTest", "1.0.0", "");
+    app.setLogStream(&stream);
+    app.setStreamingMode(streaming);
+    app.setInputFile(input.string());
+    app.setOutputFile(output.string());
+    const bool converted = app.processFile();
+    log = stream.str();
+    return converted;
+}
+
+void checkFixture(const fs::path& dataDir, const fs::path& workDir, const std::string& name,
+                  const ParserFactory& makeParser) {
+    const fs::path input = dataDir / name;
+    FAKEG_CHECK(fs::exists(input), "missing fixture " << name);
+    FAKEG_CHECK(makeParser()->supportsStreaming(), name << ": parser does not stream");
+
+    const fs::path streamed = workDir / "streamed.log";
+    const fs::path buffered = workDir / "buffered.log";
+    std::string log;
+    FAKEG_CHECK(convert(makeParser, input, streamed, true, log), name << ": streamed conversion failed\n" << log);
+    FAKEG_CHECK(convert(makeParser, input, buffered, false, log), name << ": --no-stream conversion failed\n" << log);
+
+    const std::string expected = readFile(buffered);
+    FAKEG_CHECK(!expected.empty(), name << ": empty output");
+    FAKEG_CHECK(readFile(streamed) == expected, name << ": streamed output differs from --no-stream");
+    std::cout << name << ": " << expected.size() << " bytes compared" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: streaming_test <data_dir>" << std::endl;
+        return 2;
+    }
+
+    const fs::path dataDir = argv[1];
+    const fs::path workDir = fs::temp_directory_path() / ("fakeg_streaming_test_" + std::to_string(std::random_device{}()));
+    fs::create_directories(workDir);
+
+    const ParserFactory amesp = [] { return std::make_unique<fakeg::parsers::AmespParser>(); };
+    checkFixture(dataDir, workDir, "a_opt.aop", amesp);
+    checkFixture(dataDir, workDir, "a_td.aop", amesp);
+    checkFixture(dataDir, workDir, "b_opt.out", [] { return std::make_unique<fakeg::parsers::BdfParser>(); });
+
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+    return fakeg::tests::failureCount();
+}
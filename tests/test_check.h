@@ -0,0 +1,24 @@
+#pragma once
+
+#include <iostream>
+
+// 回归测试的最小断言：失败时打印位置和说明并计数，main 以失败数作为退出码（ctest 据此判断）
+namespace fakeg {
+namespace tests {
+
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+} // namespace tests
+} // namespace fakeg
+
+#define FAKEG_CHECK(condition, message)                                                          \
+    do {                                                                                         \
+        if (!(condition)) {                                                                      \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << " (" \
+                      << message << ")" << std::endl;                                            \
+            ::fakeg::tests::failureCount()++;                                                    \
+        }                                                                                        \
+    } while (false)